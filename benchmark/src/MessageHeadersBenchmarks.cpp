@@ -0,0 +1,692 @@
+/**
+ * @file MessageHeadersBenchmarks.cpp
+ *
+ * This module contains benchmarks of the MessageHeaders::MessageHeaders
+ * and MessageHeaders::MessageHeadersView classes
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stdlib.h>
+#include <benchmark/benchmark.h>
+#include <MessageHeaders/ExtractionPlan.hpp>
+#include <MessageHeaders/HeaderEventParser.hpp>
+#include <MessageHeaders/MessageFileScanner.hpp>
+#include <MessageHeaders/MessageHeaders.hpp>
+#include <MessageHeaders/MessageHeadersPool.hpp>
+#include <MessageHeaders/MessageHeadersView.hpp>
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    /**
+     * This counts the allocations made through the global operator new,
+     * so that benchmarks can report how many each iteration makes.
+     */
+    std::atomic<size_t> allocations(0);
+
+    /**
+     * These are the kinds of message used as benchmark input.
+     */
+    enum Corpus
+    {
+        /**
+         * This is a request sent by a web browser.
+         */
+        HttpRequest,
+
+        /**
+         * This is a SIP INVITE which has been through many proxies,
+         * so it has many Via and Record-Route headers.
+         */
+        SipInvite,
+
+        /**
+         * This is an e-mail message which has been relayed many times,
+         * so it has a long chain of folded Received headers.
+         */
+        EmailMessage,
+    };
+
+    /**
+     * This function builds the raw header block of the given kind
+     * of message.
+     *
+     * @param[in] corpus
+     *      This selects the kind of message to build.
+     *
+     * @return
+     *      The raw header block of the message is returned.
+     */
+    std::string MakeRawMessage(Corpus corpus)
+    {
+        std::string rawMessage;
+        switch (corpus)
+        {
+        case HttpRequest:
+        {
+            rawMessage =
+                "Host: www.example.com\r\n"
+                "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:125.0) Gecko/20100101 "
+                "Firefox/125.0\r\n"
+                "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,"
+                "image/webp,*/*;q=0.8\r\n"
+                "Accept-Language: en-US,en;q=0.5\r\n"
+                "Accept-Encoding: gzip, deflate, br\r\n"
+                "Referer: https://www.example.com/search?q=message+headers\r\n"
+                "Connection: keep-alive\r\n"
+                "Cookie: session=4f2a9c1b77d3e0a2; theme=dark; _ga=GA1.2.1234567890.1715671951; "
+                "_gid=GA1.2.987654321.1715671951; consent=yes\r\n"
+                "Upgrade-Insecure-Requests: 1\r\n"
+                "Sec-Fetch-Dest: document\r\n"
+                "Sec-Fetch-Mode: navigate\r\n"
+                "Sec-Fetch-Site: same-origin\r\n"
+                "Sec-Fetch-User: ?1\r\n"
+                "If-None-Match: \"5f1c2e3a9b7d4c1e\"\r\n"
+                "If-Modified-Since: Tue, 14 May 2024 08:12:28 GMT\r\n"
+                "Cache-Control: max-age=0\r\n";
+        }
+        break;
+
+        case SipInvite:
+        {
+            for (int hop = 0; hop < 12; ++hop)
+            {
+                const auto host = "proxy" + std::to_string(hop) + ".atlanta.example.com";
+                rawMessage += "Via: SIP/2.0/TCP " + host + ";branch=z9hG4bK" +
+                              std::to_string(776 + hop * 37) + "asdhds" +
+                              std::to_string(hop) + ";received=192.0.2." +
+                              std::to_string(hop + 1) + "\r\n";
+            }
+            for (int hop = 0; hop < 12; ++hop)
+            {
+                rawMessage += "Record-Route: <sip:proxy" + std::to_string(hop) +
+                              ".atlanta.example.com;lr>\r\n";
+            }
+            rawMessage +=
+                "Max-Forwards: 58\r\n"
+                "To: Bob <sip:bob@biloxi.example.com>\r\n"
+                "From: Alice <sip:alice@atlanta.example.com>;tag=1928301774\r\n"
+                "Call-ID: a84b4c76e66710@pc33.atlanta.example.com\r\n"
+                "CSeq: 314159 INVITE\r\n"
+                "Contact: <sip:alice@pc33.atlanta.example.com;transport=tcp>\r\n"
+                "Allow: INVITE, ACK, CANCEL, OPTIONS, BYE, REFER, NOTIFY, MESSAGE, UPDATE\r\n"
+                "Supported: replaces, timer, 100rel\r\n"
+                "User-Agent: ExamplePhone/4.2\r\n"
+                "Content-Type: application/sdp\r\n"
+                "Content-Length: 142\r\n";
+        }
+        break;
+
+        case EmailMessage:
+        default:
+        {
+            for (int hop = 0; hop < 10; ++hop)
+            {
+                rawMessage += "Received: from relay" + std::to_string(hop + 1) +
+                              ".example.net (relay" + std::to_string(hop + 1) +
+                              ".example.net [198.51.100." + std::to_string(hop + 10) +
+                              "])\r\n"
+                              "\tby relay" +
+                              std::to_string(hop) +
+                              ".example.net with ESMTPS id 4f2a9c1b" + std::to_string(hop) +
+                              "\r\n"
+                              "\tfor <bob@biloxi.example.com>; Tue, 14 May 2024 10:12:" +
+                              std::to_string(10 + hop) + " +0200\r\n";
+            }
+            rawMessage +=
+                "DKIM-Signature: v=1; a=rsa-sha256; c=relaxed/relaxed; d=atlanta.example.com;\r\n"
+                " s=selector1; h=from:to:subject:date:message-id;\r\n"
+                " bh=2jUSOH9NhtVGCQWNr9BrIAPreKQjO6Sn7XIkfJVOzv8=;\r\n"
+                " b=AuUoFEfDxTDkHlLXSZEpZj79LICEps6eda7W3deTVFOk4yAUoqOB4nujc7YopdG5\r\n"
+                "From: Alice <alice@atlanta.example.com>\r\n"
+                "To: Bob <bob@biloxi.example.com>, Carol <carol@chicago.example.com>\r\n"
+                "Subject: Quarterly report, with the figures we discussed\r\n"
+                " last week\r\n"
+                "Date: Tue, 14 May 2024 10:12:08 +0200\r\n"
+                "Message-ID: <5f1c2e3a-9b7d-4c1e-8a2f-0d6b3e9c7a41@atlanta.example.com>\r\n"
+                "MIME-Version: 1.0\r\n"
+                "Content-Type: multipart/mixed; boundary=\"b1_5f1c2e3a9b7d4c1e\"\r\n";
+        }
+        break;
+        }
+        return rawMessage + "\r\n";
+    }
+
+    /**
+     * This function returns the name of a header which is present near
+     * the end of the given kind of message, and so is the slowest to
+     * find by checking each header in turn.
+     *
+     * @param[in] corpus
+     *      This selects the kind of message.
+     *
+     * @return
+     *      The name of a header near the end of the message is returned.
+     */
+    const char* LateHeaderName(Corpus corpus)
+    {
+        switch (corpus)
+        {
+        case HttpRequest: return "cache-control";
+        case SipInvite: return "content-length";
+        case EmailMessage:
+        default: return "content-type";
+        }
+    }
+
+    /**
+     * This function returns the name of a header of the given kind of
+     * message whose value is a comma-separated list.
+     *
+     * @param[in] corpus
+     *      This selects the kind of message.
+     *
+     * @return
+     *      The name of a list header of the message is returned.
+     */
+    const char* ListHeaderName(Corpus corpus)
+    {
+        switch (corpus)
+        {
+        case HttpRequest: return "accept";
+        case SipInvite: return "via";
+        case EmailMessage:
+        default: return "to";
+        }
+    }
+
+    /**
+     * This function parses the given kind of message.
+     *
+     * @param[in] corpus
+     *      This selects the kind of message to parse.
+     *
+     * @return
+     *      The headers of the message are returned.
+     */
+    MessageHeaders::MessageHeaders ParseCorpus(Corpus corpus)
+    {
+        MessageHeaders::MessageHeaders headers;
+        (void)headers.ParseRawMessage(MakeRawMessage(corpus));
+        return headers;
+    }
+
+    /**
+     * This function sets the counters of the given benchmark which
+     * report how many allocations each iteration made, and how many
+     * characters each handled.
+     *
+     * @param[in,out] state
+     *      This is the state of the benchmark.
+     *
+     * @param[in] allocationsBefore
+     *      This is the number of allocations made before the benchmark
+     *      began iterating.
+     *
+     * @param[in] bytesPerIteration
+     *      This is the number of characters each iteration handled,
+     *      or zero if the benchmark doesn't handle raw messages.
+     */
+    void ReportCounters(benchmark::State& state, size_t allocationsBefore,
+                        size_t bytesPerIteration)
+    {
+        state.counters["allocations"] = benchmark::Counter(
+            (double)(allocations.load() - allocationsBefore), benchmark::Counter::kAvgIterations);
+        if (bytesPerIteration > 0)
+        {
+            state.SetBytesProcessed((int64_t)(state.iterations() * bytesPerIteration));
+        }
+    }
+}  // namespace
+
+// The replacements are kept from being inlined, so that the compiler
+// doesn't pair the free in operator delete with the new expressions,
+// and warn that the memory wasn't allocated by malloc.
+[[gnu::noinline]] void* operator new(size_t size)
+{
+    ++allocations;
+    const auto block = malloc(size == 0 ? 1 : size);
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+[[gnu::noinline]] void* operator new[](size_t size) { return operator new(size); }
+
+[[gnu::noinline]] void operator delete(void* block) noexcept { free(block); }
+
+[[gnu::noinline]] void operator delete[](void* block) noexcept { free(block); }
+
+[[gnu::noinline]] void operator delete(void* block, size_t) noexcept { free(block); }
+
+[[gnu::noinline]] void operator delete[](void* block, size_t) noexcept { free(block); }
+
+[[gnu::noinline]] void* operator new(size_t size, std::align_val_t alignment)
+{
+    ++allocations;
+    void* block = nullptr;
+    if (posix_memalign(&block, std::max((size_t)alignment, sizeof(void*)), size) != 0)
+    {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+[[gnu::noinline]] void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+[[gnu::noinline]] void operator delete(void* block, std::align_val_t) noexcept { free(block); }
+
+[[gnu::noinline]] void operator delete[](void* block, std::align_val_t) noexcept { free(block); }
+
+[[gnu::noinline]] void operator delete(void* block, size_t, std::align_val_t) noexcept
+{
+    free(block);
+}
+
+[[gnu::noinline]] void operator delete[](void* block, size_t, std::align_val_t) noexcept
+{
+    free(block);
+}
+
+static void ParseRawMessage(benchmark::State& state)
+{
+    const auto rawMessage = MakeRawMessage((Corpus)state.range(0));
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        MessageHeaders::MessageHeaders headers;
+        benchmark::DoNotOptimize(headers.ParseRawMessage(rawMessage));
+    }
+    ReportCounters(state, allocationsBefore, rawMessage.length());
+}
+BENCHMARK(ParseRawMessage)->DenseRange(HttpRequest, EmailMessage);
+
+static void ParseRawMessageProfile(benchmark::State& state)
+{
+    const auto corpus = (Corpus)state.range(0);
+    const auto rawMessage = MakeRawMessage(corpus);
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        MessageHeaders::MessageHeaders headers;
+        switch (corpus)
+        {
+        case HttpRequest:
+            benchmark::DoNotOptimize(
+                headers.ParseRawMessage<MessageHeaders::HttpProfile>(rawMessage));
+            break;
+        case SipInvite:
+            benchmark::DoNotOptimize(
+                headers.ParseRawMessage<MessageHeaders::SipProfile>(rawMessage));
+            break;
+        default:
+            benchmark::DoNotOptimize(
+                headers.ParseRawMessage<MessageHeaders::EmailProfile>(rawMessage));
+            break;
+        }
+    }
+    ReportCounters(state, allocationsBefore, rawMessage.length());
+}
+BENCHMARK(ParseRawMessageProfile)->DenseRange(HttpRequest, EmailMessage);
+
+static void ParseRawMessagePooled(benchmark::State& state)
+{
+    const auto rawMessage = MakeRawMessage((Corpus)state.range(0));
+    MessageHeaders::MessageHeadersPool pool;
+    auto warmUp = pool.Acquire();
+    (void)warmUp.ParseRawMessage(rawMessage);
+    pool.Release(std::move(warmUp));
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        auto headers = pool.Acquire();
+        benchmark::DoNotOptimize(headers.ParseRawMessage(rawMessage));
+        pool.Release(std::move(headers));
+    }
+    ReportCounters(state, allocationsBefore, rawMessage.length());
+}
+BENCHMARK(ParseRawMessagePooled)->DenseRange(HttpRequest, EmailMessage);
+
+static void ParseRawMessageEvents(benchmark::State& state)
+{
+    const auto rawMessage = MakeRawMessage((Corpus)state.range(0));
+    MessageHeaders::HeaderEventParser parser;
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+            parser.ParseRawMessage(rawMessage,
+                                   [](std::string_view name, std::string_view value)
+                                   {
+                                       benchmark::DoNotOptimize(name.data());
+                                       benchmark::DoNotOptimize(value.data());
+                                   }));
+    }
+    ReportCounters(state, allocationsBefore, rawMessage.length());
+}
+BENCHMARK(ParseRawMessageEvents)->DenseRange(HttpRequest, EmailMessage);
+
+static void ParseRawMessageLazy(benchmark::State& state)
+{
+    const auto corpus = (Corpus)state.range(0);
+    const auto rawMessage = MakeRawMessage(corpus);
+    const MessageHeaders::MessageHeaders::HeaderName name(LateHeaderName(corpus));
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        MessageHeaders::MessageHeaders headers;
+        headers.SetLazyValues(true);
+        benchmark::DoNotOptimize(headers.ParseRawMessage(rawMessage));
+        benchmark::DoNotOptimize(headers.GetHeaderValue(name));
+    }
+    ReportCounters(state, allocationsBefore, rawMessage.length());
+}
+BENCHMARK(ParseRawMessageLazy)->DenseRange(HttpRequest, EmailMessage);
+
+static void ParseRawMessageView(benchmark::State& state)
+{
+    const auto rawMessage = MakeRawMessage((Corpus)state.range(0));
+    MessageHeaders::MessageHeadersView headers;
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        headers.Clear();
+        benchmark::DoNotOptimize(headers.ParseRawMessage(rawMessage));
+    }
+    ReportCounters(state, allocationsBefore, rawMessage.length());
+}
+BENCHMARK(ParseRawMessageView)->DenseRange(HttpRequest, EmailMessage);
+
+static void IndexMbox(benchmark::State& state)
+{
+    const auto rawMessage = MakeRawMessage(EmailMessage);
+    std::string contents;
+    for (size_t i = 0; i < 10000; ++i)
+    {
+        contents += "From alice@atlanta.example.com Tue May 14 10:12:08 2024\r\n";
+        contents += rawMessage;
+        contents += "Please find the report attached.\r\n\r\n";
+    }
+    const MessageHeaders::MessageFileScanner scanner(
+        MessageHeaders::MessageFileScanner::Framing::Mbox, (size_t)state.range(0));
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(scanner.Index(contents));
+    }
+    ReportCounters(state, allocationsBefore, contents.length());
+}
+BENCHMARK(IndexMbox)->Arg(1)->Arg(4)->UseRealTime();
+
+static void GetHeaderValue(benchmark::State& state)
+{
+    const auto corpus = (Corpus)state.range(0);
+    const auto headers = ParseCorpus(corpus);
+    const MessageHeaders::MessageHeaders::HeaderName name(LateHeaderName(corpus));
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(headers.GetHeaderValue(name));
+    }
+    ReportCounters(state, allocationsBefore, 0);
+}
+BENCHMARK(GetHeaderValue)->DenseRange(HttpRequest, EmailMessage);
+
+/**
+ * These are the headers a load balancer typically picks out of each request.
+ */
+const std::vector<MessageHeaders::MessageHeaders::HeaderName> ExtractedHeaderNames = {
+    "Host", "X-Forwarded-For", "Cookie", "Authorization", "User-Agent", "Accept"};
+
+static void ParseAndGetHeaderValues(benchmark::State& state)
+{
+    const auto rawMessage = MakeRawMessage((Corpus)state.range(0));
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        MessageHeaders::MessageHeaders headers;
+        benchmark::DoNotOptimize(headers.ParseRawMessage(rawMessage));
+        for (const auto& name : ExtractedHeaderNames)
+        {
+            benchmark::DoNotOptimize(headers.GetHeaderValue(name));
+        }
+    }
+    ReportCounters(state, allocationsBefore, rawMessage.length());
+}
+BENCHMARK(ParseAndGetHeaderValues)->DenseRange(HttpRequest, EmailMessage);
+
+static void ExtractHeaderValues(benchmark::State& state)
+{
+    const auto rawMessage = MakeRawMessage((Corpus)state.range(0));
+    const MessageHeaders::ExtractionPlan plan(ExtractedHeaderNames);
+    MessageHeaders::ExtractionPlan::Extraction extraction;
+    (void)plan.Extract(rawMessage, extraction);
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(plan.Extract(rawMessage, extraction));
+        benchmark::DoNotOptimize(extraction.slots.data());
+    }
+    ReportCounters(state, allocationsBefore, rawMessage.length());
+}
+BENCHMARK(ExtractHeaderValues)->DenseRange(HttpRequest, EmailMessage);
+
+static void GetHeaderTokens(benchmark::State& state)
+{
+    const auto corpus = (Corpus)state.range(0);
+    const auto headers = ParseCorpus(corpus);
+    const MessageHeaders::MessageHeaders::HeaderName name(ListHeaderName(corpus));
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(headers.GetHeaderTokens(name));
+    }
+    ReportCounters(state, allocationsBefore, 0);
+}
+BENCHMARK(GetHeaderTokens)->DenseRange(HttpRequest, EmailMessage);
+
+static void ForEachHeaderToken(benchmark::State& state)
+{
+    const auto corpus = (Corpus)state.range(0);
+    const auto headers = ParseCorpus(corpus);
+    const MessageHeaders::MessageHeaders::HeaderName name(ListHeaderName(corpus));
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        headers.ForEachHeaderToken(name, [](std::string_view token)
+                                   { benchmark::DoNotOptimize(token.data()); });
+    }
+    ReportCounters(state, allocationsBefore, 0);
+}
+BENCHMARK(ForEachHeaderToken)->DenseRange(HttpRequest, EmailMessage);
+
+static void GetAll(benchmark::State& state)
+{
+    const auto headers = ParseCorpus((Corpus)state.range(0));
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(headers.GetAll());
+    }
+    ReportCounters(state, allocationsBefore, 0);
+}
+BENCHMARK(GetAll)->DenseRange(HttpRequest, EmailMessage);
+
+static void ForEachHeader(benchmark::State& state)
+{
+    const auto headers = ParseCorpus((Corpus)state.range(0));
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        headers.ForEachHeader(
+            [](std::string_view name, std::string_view value)
+            {
+                benchmark::DoNotOptimize(name.data());
+                benchmark::DoNotOptimize(value.data());
+            });
+    }
+    ReportCounters(state, allocationsBefore, 0);
+}
+BENCHMARK(ForEachHeader)->DenseRange(HttpRequest, EmailMessage);
+
+static void HasHeader(benchmark::State& state)
+{
+    const auto headers = ParseCorpus((Corpus)state.range(0));
+    const MessageHeaders::MessageHeaders::HeaderName name("X-Not-There");
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(headers.HasHeader(name));
+    }
+    ReportCounters(state, allocationsBefore, 0);
+}
+BENCHMARK(HasHeader)->DenseRange(HttpRequest, EmailMessage);
+
+static void SetAndRemoveHeader(benchmark::State& state)
+{
+    auto headers = ParseCorpus((Corpus)state.range(0));
+    const MessageHeaders::MessageHeaders::HeaderName name("X-Forwarded-For");
+    const MessageHeaders::MessageHeaders::HeaderValue value("203.0.113.195");
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        headers.SetHeader(name, value);
+        headers.RemoveHeader(name);
+    }
+    ReportCounters(state, allocationsBefore, 0);
+}
+BENCHMARK(SetAndRemoveHeader)->DenseRange(HttpRequest, EmailMessage);
+
+static void RemoveHeaders(benchmark::State& state)
+{
+    const auto corpus = (Corpus)state.range(0);
+    const auto original = ParseCorpus(corpus);
+    const std::vector<MessageHeaders::MessageHeaders::HeaderName> names{
+        "Via", "Record-Route", "Received", "Connection", "Keep-Alive"};
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto headers = original.Clone();
+        headers.Reserve(0);
+        state.ResumeTiming();
+        headers.RemoveHeaders(names);
+        benchmark::DoNotOptimize(headers);
+    }
+    ReportCounters(state, allocationsBefore, 0);
+}
+BENCHMARK(RemoveHeaders)->DenseRange(HttpRequest, EmailMessage);
+
+static void CloneAndModifyHeader(benchmark::State& state)
+{
+    const auto headers = ParseCorpus((Corpus)state.range(0));
+    const MessageHeaders::MessageHeaders::HeaderName name("Via");
+    const MessageHeaders::MessageHeaders::HeaderValue value("SIP/2.0/UDP branch.example.com");
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        auto clone = headers.Clone();
+        if (state.range(1) != 0)
+        {
+            clone.AddHeader(name, value);
+        }
+        benchmark::DoNotOptimize(clone);
+    }
+    ReportCounters(state, allocationsBefore, 0);
+}
+BENCHMARK(CloneAndModifyHeader)->ArgsProduct({{HttpRequest, SipInvite, EmailMessage}, {0, 1}});
+
+static void GenerateRawHeaders(benchmark::State& state)
+{
+    auto headers = ParseCorpus((Corpus)state.range(0));
+    headers.SetLineLimit((size_t)state.range(1));
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(headers.GenerateRawHeaders());
+    }
+    ReportCounters(state, allocationsBefore, headers.GetRawSize());
+}
+BENCHMARK(GenerateRawHeaders)->ArgsProduct({{HttpRequest, SipInvite, EmailMessage}, {0, 78, 998}});
+
+static void GetRawSize(benchmark::State& state)
+{
+    const auto headers = ParseCorpus((Corpus)state.range(0));
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(headers.GetRawSize());
+    }
+    ReportCounters(state, allocationsBefore, 0);
+}
+BENCHMARK(GetRawSize)->DenseRange(HttpRequest, EmailMessage);
+
+static void AppendRawHeaders(benchmark::State& state)
+{
+    auto headers = ParseCorpus((Corpus)state.range(0));
+    headers.SetLineLimit((size_t)state.range(1));
+    std::string output;
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        output.clear();
+        headers.AppendRawHeaders(output);
+        benchmark::DoNotOptimize(output.data());
+    }
+    ReportCounters(state, allocationsBefore, output.size());
+}
+BENCHMARK(AppendRawHeaders)->ArgsProduct({{HttpRequest, SipInvite, EmailMessage}, {0, 78, 998}});
+
+static void ParseFoldedLines(benchmark::State& state)
+{
+    std::string rawMessage = "Subject: first line";
+    for (int64_t i = 0; i < state.range(0); ++i)
+    {
+        rawMessage += "\r\n and another line";
+    }
+    rawMessage += "\r\n\r\n";
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        MessageHeaders::MessageHeaders headers;
+        benchmark::DoNotOptimize(headers.ParseRawMessage(rawMessage));
+    }
+    ReportCounters(state, allocationsBefore, rawMessage.length());
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK(ParseFoldedLines)->RangeMultiplier(8)->Range(8, 32768)->Complexity(benchmark::oN);
+
+static void ParseUnterminatedLineInPieces(benchmark::State& state)
+{
+    const auto rawMessage = "Subject: " + std::string((size_t)state.range(0), 'x');
+    constexpr size_t pieceSize = 64;
+    const auto allocationsBefore = allocations.load();
+    for (auto _ : state)
+    {
+        MessageHeaders::MessageHeaders headers;
+        for (size_t end = pieceSize; end <= rawMessage.length(); end += pieceSize)
+        {
+            benchmark::DoNotOptimize(
+                headers.ParseRawMessage(std::string_view(rawMessage).substr(0, end)));
+        }
+    }
+    ReportCounters(state, allocationsBefore, rawMessage.length());
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK(ParseUnterminatedLineInPieces)
+    ->RangeMultiplier(8)
+    ->Range(512, 1 << 21)
+    ->Complexity(benchmark::oN);
+
+BENCHMARK_MAIN();
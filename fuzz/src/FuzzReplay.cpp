@@ -0,0 +1,93 @@
+/**
+ * @file FuzzReplay.cpp
+ *
+ * This module contains a program which runs the fuzz target over files
+ * given on the command line, or all the files in directories given on
+ * the command line, so that a corpus can be replayed as a regression test
+ * by builds which don't have libFuzzer.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+namespace
+{
+    /**
+     * This function runs the fuzz target over the contents of the file
+     * at the given path.
+     *
+     * @param[in] path
+     *      This is the path of the file to replay.
+     *
+     * @return
+     *      An indication of whether or not the file could be read
+     *      is returned.
+     */
+    bool Replay(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            fprintf(stderr, "Unable to read %s\n", path.string().c_str());
+            return false;
+        }
+        const std::string input((std::istreambuf_iterator<char>(file)),
+                                std::istreambuf_iterator<char>());
+        printf("%s: %zu characters\n", path.string().c_str(), input.length());
+        (void)LLVMFuzzerTestOneInput((const uint8_t*)input.data(), input.length());
+        return true;
+    }
+}  // namespace
+
+/**
+ * This is the entry point of the program.
+ *
+ * @param[in] argc
+ *      This is the number of command-line arguments given to the program.
+ *
+ * @param[in] argv
+ *      This is the array of command-line arguments given to the program,
+ *      which are the paths of the files, or directories of files, to replay.
+ *
+ * @return
+ *      Zero is returned if every file was replayed, or one otherwise.
+ */
+int main(int argc, char* argv[])
+{
+    auto success = (argc > 1);
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::filesystem::path path(argv[i]);
+        std::error_code error;
+        if (!std::filesystem::is_directory(path, error))
+        {
+            success = Replay(path) && success;
+            continue;
+        }
+        std::vector<std::filesystem::path> paths;
+        for (const auto& entry : std::filesystem::directory_iterator(path, error))
+        {
+            if (entry.is_regular_file())
+            {
+                paths.push_back(entry.path());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+        for (const auto& filePath : paths)
+        {
+            success = Replay(filePath) && success;
+        }
+    }
+    return success ? 0 : 1;
+}
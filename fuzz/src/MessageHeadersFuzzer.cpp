@@ -0,0 +1,457 @@
+/**
+ * @file MessageHeadersFuzzer.cpp
+ *
+ * This module contains the libFuzzer target which feeds arbitrary input
+ * to MessageHeaders::MessageHeaders::ParseRawMessage, checking that the
+ * different ways of parsing the same header block agree, and that the
+ * time taken grows no faster than the input.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <MessageHeaders/MessageHeaders.hpp>
+#include <MessageHeaders/MessageHeadersView.hpp>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <string_view>
+
+namespace
+{
+    /**
+     * This is the number of times the input is repeated to make the
+     * smaller of the two messages whose parsing times are compared.
+     */
+    constexpr size_t ShortRepeats = 4;
+
+    /**
+     * This is the number of times the input is repeated to make the
+     * larger of the two messages whose parsing times are compared.
+     */
+    constexpr size_t LongRepeats = 32;
+
+    /**
+     * This is how many times slower than linear the parsing of the
+     * larger message may be before the input is reported, which leaves
+     * room for noise in the measurements.
+     */
+    constexpr double SlowdownAllowed = 4.0;
+
+    /**
+     * This is the shortest parsing time, in seconds, that is compared,
+     * since timings shorter than this mostly measure noise.
+     */
+    constexpr double ShortestTimeCompared = 0.001;
+
+    /**
+     * This is the number of times each parsing time is measured,
+     * keeping the fastest, to leave out interruptions.
+     */
+    constexpr size_t Measurements = 3;
+
+    /**
+     * This function stops the fuzzer, reporting the given problem
+     * found with the input.
+     *
+     * @param[in] problem
+     *      This describes the problem found.
+     */
+    [[noreturn]] void Fail(const char* problem)
+    {
+        fprintf(stderr, "MessageHeadersFuzzer: %s\n", problem);
+        abort();
+    }
+
+    /**
+     * This function checks whether or not the given collections of
+     * headers hold the same headers, with the same names and values,
+     * in the same order.
+     *
+     * @param[in] lhs
+     *      This is one collection to compare.
+     *
+     * @param[in] rhs
+     *      This is the other collection to compare.
+     *
+     * @return
+     *      An indication of whether or not the collections hold the same
+     *      headers is returned.
+     */
+    bool SameHeaders(const MessageHeaders::MessageHeaders::Headers& lhs,
+                     const MessageHeaders::MessageHeaders::Headers& rhs)
+    {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                          [](const MessageHeaders::MessageHeaders::Header& lhsHeader,
+                             const MessageHeaders::MessageHeaders::Header& rhsHeader)
+                          {
+                              return (static_cast<const std::string&>(lhsHeader.name) ==
+                                      static_cast<const std::string&>(rhsHeader.name)) &&
+                                     (lhsHeader.value == rhsHeader.value);
+                          });
+    }
+
+    /**
+     * This function checks whether or not the given view over a raw
+     * message finds the same headers as the given collection of headers,
+     * with the same values.
+     *
+     * @param[in] view
+     *      This is the view to check.
+     *
+     * @param[in] headers
+     *      This is the collection of headers to compare with.
+     *
+     * @return
+     *      An indication of whether or not the view finds the same
+     *      headers is returned.
+     */
+    bool SameHeaders(const MessageHeaders::MessageHeadersView& view,
+                     const MessageHeaders::MessageHeaders& headers)
+    {
+        const auto allHeaders = headers.GetAll();
+        if (view.GetHeaderCount() != allHeaders.size())
+        {
+            return false;
+        }
+        for (const auto& header : allHeaders)
+        {
+            if (view.GetHeaderValue(static_cast<const std::string&>(header.name)) !=
+                headers.GetHeaderValue(header.name))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * This function parses the given raw message by handing it over
+     * a few characters at a time, as it would arrive from a network
+     * connection.
+     *
+     * @param[in,out] headers
+     *      This is the parser, which is where the headers parsed
+     *      are stored.
+     *
+     * @param[in] rawMessage
+     *      This is the raw message to parse.
+     *
+     * @param[in] chunkSize
+     *      This is the number of characters handed over each time.
+     *
+     * @param[out] bodyOffset
+     *      This is where to store the offset where the body begins.
+     *
+     * @return
+     *      The outcome of the last parse is returned.
+     */
+    template <typename Parser>
+    MessageHeaders::MessageHeaders::State ParseInChunks(Parser& headers,
+                                                        std::string_view rawMessage,
+                                                        size_t chunkSize, size_t& bodyOffset)
+    {
+        auto state = MessageHeaders::MessageHeaders::State::Incomplete;
+        bodyOffset = 0;
+        for (size_t end = std::min(chunkSize, rawMessage.length());;
+             end = std::min(end + chunkSize, rawMessage.length()))
+        {
+            state = headers.ParseRawMessage(rawMessage.substr(0, end), bodyOffset);
+            if ((state != MessageHeaders::MessageHeaders::State::Incomplete) ||
+                (end == rawMessage.length()))
+            {
+                return state;
+            }
+        }
+    }
+
+    /**
+     * This function checks that parsers which were already used, for
+     * part of another message, then cleared or made to abandon that
+     * parse, parse the given raw message just as new ones do.
+     *
+     * @param[in] rawMessage
+     *      This is the raw message to parse.
+     *
+     * @param[in] chunkSize
+     *      This is the number of characters handed over at a time when
+     *      parsing the message as it would arrive from a network.
+     *
+     * @param[in] expected
+     *      These are the headers parsed from the raw message by a new
+     *      parser.
+     *
+     * @param[in] expectedState
+     *      This is the outcome of parsing the raw message with a new
+     *      parser.
+     *
+     * @param[in] expectedBodyOffset
+     *      This is where a new parser found the body to begin, if the
+     *      header block is complete.
+     */
+    void CheckReuse(std::string_view rawMessage, size_t chunkSize,
+                    const MessageHeaders::MessageHeaders& expected,
+                    MessageHeaders::MessageHeaders::State expectedState, size_t expectedBodyOffset)
+    {
+        // The other message is the second half of the input, of which
+        // only the first chunk is given, which often leaves it incomplete,
+        // even part way through its first line.
+        const auto otherMessage = rawMessage.substr(rawMessage.length() / 2);
+        const auto otherPart = otherMessage.substr(0, std::min(chunkSize, otherMessage.length()));
+        const auto parsesAsExpected = [&](auto& parser)
+        {
+            size_t bodyOffset = 0;
+            const auto state = ParseInChunks(parser, rawMessage, chunkSize, bodyOffset);
+            return (state == expectedState) &&
+                   ((state != MessageHeaders::MessageHeaders::State::Complete) ||
+                    (bodyOffset == expectedBodyOffset));
+        };
+
+        MessageHeaders::MessageHeaders abandoned;
+        if (abandoned.ParseRawMessage(otherPart) ==
+            MessageHeaders::MessageHeaders::State::Incomplete)
+        {
+            abandoned.AbandonParse();
+        }
+        else
+        {
+            abandoned.Clear();
+        }
+        if (!parsesAsExpected(abandoned))
+        {
+            Fail("parsing after abandoning a parse and with a new object disagree");
+        }
+
+        MessageHeaders::MessageHeaders cleared;
+        cleared.SetLazyValues(true);
+        (void)cleared.ParseRawMessage(otherPart);
+        cleared.Clear();
+        if (!parsesAsExpected(cleared))
+        {
+            Fail("parsing after clearing and with a new object disagree");
+        }
+
+        MessageHeaders::MessageHeadersView view;
+        (void)view.ParseRawMessage(otherPart);
+        view.Clear();
+        if (!parsesAsExpected(view))
+        {
+            Fail("parsing without copying after clearing and with a new object disagree");
+        }
+
+        if (expectedState != MessageHeaders::MessageHeaders::State::Complete)
+        {
+            return;
+        }
+        const auto headers = expected.GetAll();
+        if (!SameHeaders(abandoned.GetAll(), headers) || !SameHeaders(cleared.GetAll(), headers) ||
+            !SameHeaders(view, expected))
+        {
+            Fail("headers parsed by reused and new objects differ");
+        }
+    }
+
+    /**
+     * This function parses the given raw message in every way the
+     * parsers offer, checking that they all agree on the outcome, and
+     * where the body begins if the header block is complete, and
+     * that valid headers generated from the result parse back into
+     * the same headers, also when the parsers were used before.
+     *
+     * @param[in] rawMessage
+     *      This is the raw message to parse.
+     *
+     * @param[in] chunkSize
+     *      This is the number of characters handed over at a time when
+     *      parsing the message as it would arrive from a network.
+     */
+    void CheckParsers(std::string_view rawMessage, size_t chunkSize)
+    {
+        MessageHeaders::MessageHeaders eager;
+        size_t eagerBodyOffset = 0;
+        const auto state = eager.ParseRawMessage(rawMessage, eagerBodyOffset);
+
+        MessageHeaders::MessageHeaders lazy;
+        lazy.SetLazyValues(true);
+        size_t lazyBodyOffset = 0;
+        if ((lazy.ParseRawMessage(rawMessage, lazyBodyOffset) != state) ||
+            ((state == MessageHeaders::MessageHeaders::State::Complete) &&
+             (lazyBodyOffset != eagerBodyOffset)))
+        {
+            Fail("lazy and eager parsing disagree");
+        }
+
+        MessageHeaders::MessageHeaders chunked;
+        size_t chunkedBodyOffset = 0;
+        if ((ParseInChunks(chunked, rawMessage, chunkSize, chunkedBodyOffset) != state) ||
+            ((state == MessageHeaders::MessageHeaders::State::Complete) &&
+             (chunkedBodyOffset != eagerBodyOffset)))
+        {
+            Fail("parsing in one go and in pieces disagree");
+        }
+
+        MessageHeaders::MessageHeadersView view;
+        size_t viewBodyOffset = 0;
+        if ((view.ParseRawMessage(rawMessage, viewBodyOffset) != state) ||
+            ((state == MessageHeaders::MessageHeaders::State::Complete) &&
+             (viewBodyOffset != eagerBodyOffset)))
+        {
+            Fail("parsing with and without copying disagree");
+        }
+
+        MessageHeaders::MessageHeadersView chunkedView;
+        size_t chunkedViewBodyOffset = 0;
+        if ((ParseInChunks(chunkedView, rawMessage, chunkSize, chunkedViewBodyOffset) != state) ||
+            ((state == MessageHeaders::MessageHeaders::State::Complete) &&
+             (chunkedViewBodyOffset != eagerBodyOffset)))
+        {
+            Fail("parsing without copying in one go and in pieces disagree");
+        }
+
+        CheckReuse(rawMessage, chunkSize, eager, state, eagerBodyOffset);
+
+        MessageHeaders::MessageHeaders profiled;
+        (void)profiled.ParseRawMessage<MessageHeaders::HttpProfile>(rawMessage);
+        profiled.Clear();
+        (void)profiled.ParseRawMessage<MessageHeaders::SipProfile>(rawMessage);
+        profiled.Clear();
+        (void)profiled.ParseRawMessage<MessageHeaders::EmailProfile>(rawMessage);
+
+        if (state != MessageHeaders::MessageHeaders::State::Complete)
+        {
+            return;
+        }
+        const auto headers = eager.GetAll();
+        if (!SameHeaders(lazy.GetAll(), headers) || !SameHeaders(chunked.GetAll(), headers))
+        {
+            Fail("headers parsed differ");
+        }
+        for (const auto& header : headers)
+        {
+            if (!eager.HasHeader(header.name))
+            {
+                Fail("header values differ");
+            }
+        }
+        if (!SameHeaders(view, lazy) || !SameHeaders(chunkedView, lazy))
+        {
+            Fail("header values differ");
+        }
+        if (lazy.IsValid() != eager.IsValid())
+        {
+            Fail("lazy and eager parsing disagree on validity");
+        }
+        const auto rawHeaders = lazy.GenerateRawHeaders();
+        if (rawHeaders.length() != lazy.GetRawSize())
+        {
+            Fail("raw size disagrees with headers generated");
+        }
+
+        // Headers which aren't valid, such as those whose names begin with
+        // whitespace, may not read the same once generated.
+        if (!eager.IsValid())
+        {
+            return;
+        }
+        MessageHeaders::MessageHeaders reparsed;
+        if ((reparsed.ParseRawMessage(rawHeaders) != state) ||
+            !SameHeaders(reparsed.GetAll(), headers))
+        {
+            Fail("headers generated don't parse back into the same headers");
+        }
+    }
+
+    /**
+     * This function measures how long the given raw message takes
+     * to parse, both in one go and in pieces, with and without copying.
+     *
+     * @param[in] rawMessage
+     *      This is the raw message to parse.
+     *
+     * @return
+     *      The fastest of several measurements, in seconds, is returned.
+     */
+    double MeasureParsing(std::string_view rawMessage)
+    {
+        auto fastest = 0.0;
+        for (size_t i = 0; i < Measurements; ++i)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            MessageHeaders::MessageHeaders headers;
+            size_t bodyOffset = 0;
+            if (headers.ParseRawMessage(rawMessage, bodyOffset) ==
+                MessageHeaders::MessageHeaders::State::Complete)
+            {
+                (void)headers.GetHeaderValue("Subject");
+                (void)headers.GenerateRawHeaders();
+            }
+            MessageHeaders::MessageHeaders chunked;
+            (void)ParseInChunks(chunked, rawMessage, 64, bodyOffset);
+            MessageHeaders::MessageHeadersView chunkedView;
+            (void)ParseInChunks(chunkedView, rawMessage, 64, bodyOffset);
+            const std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - start;
+            fastest = (i == 0) ? elapsed.count() : std::min(fastest, elapsed.count());
+        }
+        return fastest;
+    }
+
+    /**
+     * This function checks that the time taken to parse the given input
+     * repeated many times grows no faster than the number of times it's
+     * repeated, catching inputs, such as many folded lines or a line
+     * missing its CRLF, which make the parser go over the same
+     * characters again and again.
+     *
+     * @param[in] input
+     *      This is the input to repeat.
+     */
+    void CheckLinearTime(std::string_view input)
+    {
+        if (input.empty())
+        {
+            return;
+        }
+        std::string shortMessage;
+        for (size_t i = 0; i < ShortRepeats; ++i)
+        {
+            shortMessage += input;
+        }
+        std::string longMessage;
+        for (size_t i = 0; i < LongRepeats / ShortRepeats; ++i)
+        {
+            longMessage += shortMessage;
+        }
+        const auto shortTime = std::max(MeasureParsing(shortMessage), ShortestTimeCompared);
+        const auto longTime = MeasureParsing(longMessage);
+        if (longTime > shortTime * (LongRepeats / ShortRepeats) * SlowdownAllowed)
+        {
+            fprintf(stderr, "MessageHeadersFuzzer: %zu characters parsed in %g s, %zu in %g s\n",
+                    shortMessage.length(), shortTime, longMessage.length(), longTime);
+            Fail("parsing time grows faster than the input");
+        }
+    }
+}  // namespace
+
+/**
+ * This is the entry point called by libFuzzer with each input.
+ *
+ * @param[in] data
+ *      This points to the first character of the input.
+ *
+ * @param[in] size
+ *      This is the number of characters in the input.
+ *
+ * @return
+ *      Zero is returned, as libFuzzer expects.
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    const std::string_view input((const char*)data, size);
+    CheckParsers(input, (size == 0) ? 1 : ((size_t)data[0] % 16) + 1);
+    CheckLinearTime(input);
+    return 0;
+}
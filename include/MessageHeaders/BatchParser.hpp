@@ -0,0 +1,146 @@
+#ifndef MESSAGE_HEADERS_BATCH_PARSER_HPP
+#define MESSAGE_HEADERS_BATCH_PARSER_HPP
+/**
+ * @file BatchParser.hpp
+ *
+ * This module contains the declaration of the MessageHeaders::BatchParser class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stddef.h>
+#include <MessageHeaders/MessageHeaders.hpp>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace MessageHeaders
+{
+    /**
+     * This class parses the headers of many raw messages at once,
+     * spreading the work across a pool of worker threads.  Each worker
+     * starts with an equal share of the messages, and takes over part
+     * of the share of another worker once its own runs out, so that
+     * a few unusually large messages don't leave the other workers idle.
+     *
+     * The worker threads are kept between batches.  Batches given to
+     * the same object from multiple threads are parsed one at a time.
+     */
+    class BatchParser
+    {
+        // Types
+    public:
+        /**
+         * This holds the outcome of parsing a single raw message.
+         */
+        struct Result
+        {
+            /**
+             * These are the headers parsed from the raw message.
+             */
+            MessageHeaders headers;
+
+            /**
+             * This is the outcome of parsing the raw message.
+             */
+            MessageHeaders::State state = MessageHeaders::State::Incomplete;
+
+            /**
+             * This is the offset into the raw message where the headers
+             * ended and the body begins, if the headers are complete.
+             */
+            size_t bodyOffset = 0;
+        };
+
+        // Lifecycle management
+    public:
+        ~BatchParser() noexcept;
+        BatchParser(const BatchParser&) = delete;
+        BatchParser(BatchParser&&) = delete;
+        BatchParser& operator=(const BatchParser&) = delete;
+        BatchParser& operator=(BatchParser&&) = delete;
+
+        // Public methods
+    public:
+        /**
+         * This constructs the object, starting its worker threads.
+         *
+         * @param[in] threadCount
+         *      This is the number of threads, including the one calling
+         *      Parse, which should work on each batch, or zero to use
+         *      as many as the hardware can run at once.
+         */
+        explicit BatchParser(size_t threadCount = 0);
+
+        /**
+         * This method returns the number of threads, including the
+         * one calling Parse, which work on each batch.
+         *
+         * @return
+         *      The number of threads which work on each batch is returned.
+         */
+        size_t GetThreadCount() const;
+
+        /**
+         * This method parses the headers of each of the given raw messages.
+         *
+         * @param[in] rawMessages
+         *      This points to the first of the raw messages to parse.
+         *
+         * @param[in] count
+         *      This is the number of raw messages to parse.
+         *
+         * @return
+         *      The outcome of parsing each raw message is returned,
+         *      in the same order as the raw messages.
+         */
+        std::vector<Result> Parse(const std::string* rawMessages, size_t count);
+
+        /**
+         * This method parses the headers of each of the given raw messages,
+         * which may be views of buffers the caller keeps, such as memory
+         * mapped files, so that they don't need to be copied into strings.
+         *
+         * @param[in] rawMessages
+         *      This points to the first of the raw messages to parse.
+         *      The characters they view must stay put until this returns.
+         *
+         * @param[in] count
+         *      This is the number of raw messages to parse.
+         *
+         * @return
+         *      The outcome of parsing each raw message is returned,
+         *      in the same order as the raw messages.
+         */
+        std::vector<Result> Parse(const std::string_view* rawMessages, size_t count);
+
+        /**
+         * This method parses the headers of each of the given raw messages.
+         *
+         * @param[in] rawMessages
+         *      These are the raw messages to parse.
+         *
+         * @return
+         *      The outcome of parsing each raw message is returned,
+         *      in the same order as the raw messages.
+         */
+        std::vector<Result> Parse(const std::vector<std::string>& rawMessages);
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr<struct Impl> impl_;
+    };
+}  // namespace MessageHeaders
+
+#endif /* MESSAGE_HEADERS_BATCH_PARSER_HPP */
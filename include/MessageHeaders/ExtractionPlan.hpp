@@ -0,0 +1,258 @@
+#ifndef MESSAGE_HEADERS_EXTRACTION_PLAN_HPP
+#define MESSAGE_HEADERS_EXTRACTION_PLAN_HPP
+/**
+ * @file ExtractionPlan.hpp
+ *
+ * This module contains the declaration of the MessageHeaders::ExtractionPlan class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <MessageHeaders/HeaderScanner.hpp>
+#include <MessageHeaders/MessageHeaders.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace MessageHeaders
+{
+    /**
+     * This class picks the values of a fixed set of headers out of
+     * messages, in a single pass over each message, rather than looking
+     * up each header in turn.  It's built once from the names of the
+     * headers wanted, each of which is given a slot, and can then be
+     * used with any number of messages, either already parsed, or raw,
+     * in which case the headers not wanted are never stored at all.
+     *
+     * Only the first header with each name is picked, as with
+     * MessageHeaders::GetHeaderValue.
+     */
+    class ExtractionPlan
+    {
+        // Types
+    public:
+        /**
+         * This is the type used to report the outcome of extracting
+         * from a raw message.
+         */
+        typedef MessageHeaders::State State;
+
+        /**
+         * This selects the rules that the names of headers must follow.
+         */
+        typedef MessageHeaders::Strictness Strictness;
+
+        /**
+         * These are limits on the resources a single header block may use.
+         */
+        typedef MessageHeaders::Limits Limits;
+
+        /**
+         * This holds what was picked for one of the headers wanted.
+         */
+        struct Slot
+        {
+            /**
+             * This indicates whether or not the message has a header
+             * with the name of the slot.
+             */
+            bool found = false;
+
+            /**
+             * This is the value of the first header with the name of the
+             * slot, unfolded if necessary.  It refers either to the message
+             * it was picked from, or to unfoldedValue.
+             */
+            std::string_view value;
+
+            /**
+             * This is where the value is unfolded, if the header was
+             * folded in the raw message.  Its capacity is kept from one
+             * message to the next.
+             */
+            std::string unfoldedValue;
+        };
+
+        /**
+         * This holds what was picked from a single message.  It can be
+         * reused for one message after another, so that once it's been
+         * used, picking from messages allocates nothing.  It must not be
+         * copied while in use, since the values of its slots may refer
+         * to its own unfolded values.
+         */
+        struct Extraction
+        {
+            /**
+             * These are the slots of the headers wanted, in the order in
+             * which their names were given to the plan.
+             */
+            std::vector<Slot> slots;
+
+            /**
+             * This indicates whether or not all the headers of the raw
+             * message passed the validity checks, including the ones
+             * which weren't wanted.
+             */
+            bool valid = true;
+
+            /**
+             * This is the offset into the raw message where the headers
+             * ended and the body begins, if the headers are complete,
+             * or the number of characters consumed otherwise.
+             */
+            size_t bodyOffset = 0;
+        };
+
+        // Lifecycle management
+    public:
+        ~ExtractionPlan() noexcept = default;
+        ExtractionPlan(const ExtractionPlan&) = default;
+        ExtractionPlan(ExtractionPlan&&) noexcept = default;
+        ExtractionPlan& operator=(const ExtractionPlan&) = default;
+        ExtractionPlan& operator=(ExtractionPlan&&) noexcept = default;
+
+        // Public Methods
+    public:
+        /**
+         * This constructs the plan for the given header names.
+         *
+         * @param[in] headerNames
+         *      These are the names of the headers wanted, one per slot.
+         *      If the same name is given more than once, each of its
+         *      slots is filled in.
+         */
+        explicit ExtractionPlan(const std::vector<MessageHeaders::HeaderName>& headerNames);
+
+        /**
+         * This method returns the number of slots of the plan.
+         *
+         * @return
+         *      The number of slots of the plan is returned.
+         */
+        size_t GetSlotCount() const;
+
+        /**
+         * This method picks the wanted headers out of the given raw message,
+         * finding its headers as MessageHeaders::ParseRawMessage does, but
+         * storing only the ones wanted, which refer to the raw message
+         * where they are, unless they have to be unfolded.
+         *
+         * @param[in] rawMessage
+         *      This is the string rendering of the message.  It must outlive
+         *      the use of the values picked out of it.
+         *
+         * @param[out] extraction
+         *      This is where to store what was picked out of the message.
+         *
+         * @return
+         *      The outcome of finding the headers is returned.  Unlike
+         *      MessageHeaders::ParseRawMessage, an incomplete message can't
+         *      be resumed; the headers picked are those found so far.
+         */
+        State Extract(std::string_view rawMessage, Extraction& extraction) const;
+
+        /**
+         * This method picks the wanted headers out of the given headers,
+         * already parsed, in a single pass over them.
+         *
+         * @param[in] headers
+         *      These are the headers from which to pick.  The values
+         *      picked refer to them, and are only valid until they're
+         *      next modified.
+         *
+         * @param[out] extraction
+         *      This is where to store what was picked out of the headers.
+         */
+        void Extract(const MessageHeaders& headers, Extraction& extraction) const;
+
+        /**
+         * This method sets the maximum number of characters, including
+         * the line terminator, allowed for a single header line of
+         * raw messages.
+         *
+         * @param[in] lineLengthLimit
+         *      This is the maximum number of characters allowed
+         *      for a single header line, or zero for no limit.
+         */
+        void SetLineLimit(size_t lineLengthLimit);
+
+        /**
+         * This method selects the rules that the names of headers of
+         * raw messages must follow.
+         *
+         * @param[in] strictness
+         *      This selects the rules that header names must follow.
+         */
+        void SetStrictness(Strictness strictness);
+
+        /**
+         * This method sets limits on the resources a single header block
+         * of raw messages may use.
+         *
+         * @param[in] limits
+         *      These are the limits to enforce.
+         */
+        void SetLimits(const Limits& limits);
+
+        // Private Methods
+    private:
+        /**
+         * This method returns the first slot of the plan for the given
+         * header name.
+         *
+         * @param[in] name
+         *      This is the name of the header.
+         *
+         * @return
+         *      The position of the first slot for the header name is
+         *      returned, or the number of slots if it isn't wanted.
+         */
+        size_t FindSlot(std::string_view name) const;
+
+        /**
+         * This method empties the given extraction, making sure it has
+         * the same number of slots as the plan.
+         *
+         * @param[in,out] extraction
+         *      This is the extraction to empty.
+         */
+        void Prepare(Extraction& extraction) const;
+
+        // Private properties
+    private:
+        /**
+         * These are the names of the headers wanted, one per slot.
+         */
+        std::vector<std::string> names_;
+
+        /**
+         * These are the case-insensitive hashes of the names of
+         * the headers wanted, one per slot.
+         */
+        std::vector<uint32_t> hashes_;
+
+        /**
+         * This holds, for each slot, the position of the next slot
+         * for the same name, or the number of slots if there isn't one.
+         */
+        std::vector<size_t> nextWithSameName_;
+
+        /**
+         * This is an open-addressing hash table, keyed by header name,
+         * holding one more than the position of the first slot for each
+         * name wanted, or zero for an empty entry.  Its size is always
+         * a power of two.
+         */
+        std::vector<uint32_t> table_;
+
+        /**
+         * This is set up with the settings used to find the headers of
+         * raw messages, and copied for each one.
+         */
+        HeaderScanner scanner_;
+    };
+}  // namespace MessageHeaders
+
+#endif /* MESSAGE_HEADERS_EXTRACTION_PLAN_HPP */
@@ -0,0 +1,154 @@
+#ifndef MESSAGE_HEADERS_HEADER_BLOCK_CURSOR_HPP
+#define MESSAGE_HEADERS_HEADER_BLOCK_CURSOR_HPP
+/**
+ * @file HeaderBlockCursor.hpp
+ *
+ * This module contains the declaration of the MessageHeaders::HeaderBlockCursor class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stddef.h>
+#include <MessageHeaders/MessageHeadersView.hpp>
+#include <string_view>
+
+namespace MessageHeaders
+{
+    /**
+     * This class walks through a buffer holding several messages back to
+     * back, such as what's received from a connection carrying pipelined
+     * HTTP/1.1 requests or SIP over TCP, parsing the header block of each
+     * message in turn without copying it out of the buffer.
+     *
+     * After the header block of a message is parsed, the caller works out
+     * the length of its body (for example from its Content-Length header)
+     * and skips over it, so that the cursor reaches the next message.
+     */
+    class HeaderBlockCursor
+    {
+        // Types
+    public:
+        /**
+         * This is the type used to report the outcome of parsing.
+         */
+        typedef MessageHeadersView::State State;
+
+        /**
+         * This describes a header block found in the buffer.
+         */
+        struct Block
+        {
+            /**
+             * This is the outcome of parsing the header block.
+             */
+            State state = State::Incomplete;
+
+            /**
+             * This is the header block, including the blank line that
+             * ends it, if State::Complete was returned.  Otherwise it's
+             * everything left in the buffer.
+             */
+            std::string_view rawHeaders;
+
+            /**
+             * This is the offset into the buffer where the body begins,
+             * if State::Complete was returned.
+             */
+            size_t bodyOffset = 0;
+        };
+
+        // Public Methods
+    public:
+        /**
+         * This constructs the cursor at the beginning of the given buffer.
+         *
+         * @param[in] buffer
+         *      This is the buffer holding the messages.  It must outlive
+         *      any use of the headers parsed from it.
+         */
+        explicit HeaderBlockCursor(std::string_view buffer = {});
+
+        /**
+         * This method replaces the buffer with a longer one beginning with
+         * the same characters, such as after more characters are received,
+         * keeping the cursor where it was.  The new buffer may be at a
+         * different address.
+         *
+         * @param[in] buffer
+         *      This is the buffer holding the messages.
+         */
+        void SetBuffer(std::string_view buffer);
+
+        /**
+         * This method parses the header block at the cursor, storing the
+         * headers found in the given object.  If the header block is
+         * complete, the cursor moves to the beginning of the body.
+         *
+         * If the header block is incomplete, the cursor stays where it is.
+         * Calling this method again with the same object, once more
+         * characters are in the buffer, resumes the parse where it left
+         * off rather than starting over.
+         *
+         * @param[out] headers
+         *      This is where to store the headers found.  Any headers it
+         *      held from a previous header block are forgotten.
+         *
+         * @return
+         *      A description of the header block found is returned.
+         */
+        Block Next(MessageHeadersView& headers);
+
+        /**
+         * This method moves the cursor forward past the given number of
+         * characters, such as the body of the message whose header block
+         * was just parsed.
+         *
+         * @param[in] length
+         *      This is the number of characters to skip.
+         *
+         * @return
+         *      An indication of whether or not the buffer held enough
+         *      characters to skip is returned.  If not, the cursor
+         *      doesn't move.
+         */
+        bool Skip(size_t length);
+
+        /**
+         * This method returns the offset of the cursor into the buffer.
+         *
+         * @return
+         *      The offset of the cursor into the buffer is returned.
+         */
+        size_t GetOffset() const;
+
+        /**
+         * This method returns the part of the buffer from the cursor on,
+         * which is what should be kept when the buffer is compacted.
+         *
+         * @return
+         *      The part of the buffer from the cursor on is returned.
+         */
+        std::string_view GetRemaining() const;
+
+        // Private properties
+    private:
+        /**
+         * This is the buffer holding the messages.
+         */
+        std::string_view buffer_;
+
+        /**
+         * This is the offset of the cursor into the buffer.
+         */
+        size_t offset_ = 0;
+
+        /**
+         * This points to the object which was given to the last call
+         * to Next, if that call found an incomplete header block,
+         * so that the next call with the same object can resume it.
+         */
+        MessageHeadersView* suspendedHeaders_ = nullptr;
+    };
+}  // namespace MessageHeaders
+
+#endif /* MESSAGE_HEADERS_HEADER_BLOCK_CURSOR_HPP */
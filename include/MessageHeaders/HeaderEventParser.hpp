@@ -0,0 +1,241 @@
+#ifndef MESSAGE_HEADERS_HEADER_EVENT_PARSER_HPP
+#define MESSAGE_HEADERS_HEADER_EVENT_PARSER_HPP
+/**
+ * @file HeaderEventParser.hpp
+ *
+ * This module contains the declaration of the MessageHeaders::HeaderEventParser class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stddef.h>
+#include <MessageHeaders/HeaderScanner.hpp>
+#include <MessageHeaders/MessageHeaders.hpp>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace MessageHeaders
+{
+    /**
+     * This class finds the headers of raw messages, like
+     * MessageHeaders::ParseRawMessage, but rather than storing them,
+     * it hands each one to a handler as soon as it's found, and then
+     * forgets about it.  Nothing is allocated for each message, other
+     * than the first time a folded value longer than any before it
+     * has to be unfolded.
+     */
+    class HeaderEventParser
+    {
+        // Types
+    public:
+        /**
+         * This is the type used to report the outcome of parsing.
+         */
+        typedef MessageHeaders::State State;
+
+        /**
+         * This selects the rules that the names of headers must follow.
+         */
+        typedef MessageHeaders::Strictness Strictness;
+
+        /**
+         * These are limits on the resources a single header block may use.
+         */
+        typedef MessageHeaders::Limits Limits;
+
+        // Lifecycle management
+    public:
+        ~HeaderEventParser() noexcept = default;
+        HeaderEventParser(const HeaderEventParser&) = delete;
+        HeaderEventParser(HeaderEventParser&&) noexcept = default;
+        HeaderEventParser& operator=(const HeaderEventParser&) = delete;
+        HeaderEventParser& operator=(HeaderEventParser&&) noexcept = default;
+
+        // Public Methods
+    public:
+        /**
+         * This is the default constructor.
+         */
+        HeaderEventParser() = default;
+
+        /**
+         * This method finds the headers of the given raw message, calling
+         * the given handler with each one, in order.
+         *
+         * @param[in] rawMessage
+         *      This is the string rendering of the message to parse.
+         *
+         * @param[out] bodyOffset
+         *      This is where to store the offset into the given
+         *      raw message where the headers ended and the body begins.
+         *      If the headers are incomplete, this is where to store
+         *      the number of characters consumed so far.
+         *
+         * @param[in] handler
+         *      This is the function to call with the name and value of
+         *      each header, both as a std::string_view, the value being
+         *      unfolded and without margin whitespace.  The name refers to
+         *      the raw message, and so does the value unless it had to be
+         *      unfolded, in which case it's only valid during the call.
+         *
+         * @return
+         *      whether or not the message was parsed successfully
+         *      is returned.
+         *
+         * @note
+         *      As with MessageHeaders::ParseRawMessage, when State::Incomplete
+         *      is returned the parse is suspended, and the next call is expected
+         *      to pass the same raw message with more characters appended to it.
+         *      The handler is only called with each header once, when it's
+         *      known to be complete.
+         */
+        template <typename Handler>
+        State ParseRawMessage(std::string_view rawMessage, size_t& bodyOffset, Handler&& handler)
+        {
+            // If the raw message is shorter than what we already scanned, it
+            // can't be a continuation of the interrupted parse, so start over.
+            if (rawMessage.length() < scanner_.GetScannedLength())
+            {
+                scanner_.Reset();
+            }
+            HeaderScanner::ScannedHeader header;
+            for (;;)
+            {
+                switch (scanner_.Next(rawMessage, header))
+                {
+                case HeaderScanner::Result::Header:
+                {
+                    if (!header.validName || !header.validValue)
+                    {
+                        valid_ = false;
+                    }
+                    const auto name = HeaderScanner::GetName(rawMessage, header);
+                    if (header.folded)
+                    {
+                        HeaderScanner::UnfoldValue(rawMessage, header, unfoldedValue_);
+                        handler(name, std::string_view(unfoldedValue_));
+                    }
+                    else
+                    {
+                        handler(name, HeaderScanner::GetValue(rawMessage, header));
+                    }
+                }
+                break;
+                case HeaderScanner::Result::End:
+                {
+                    bodyOffset = scanner_.GetOffset();
+                    scanner_.Reset();
+                    return State::Complete;
+                }
+                case HeaderScanner::Result::Incomplete:
+                {
+                    bodyOffset = scanner_.GetOffset();
+                    return State::Incomplete;
+                }
+                case HeaderScanner::Result::Error:
+                default:
+                {
+                    valid_ = false;
+                    scanner_.Reset();
+                    return State::Error;
+                }
+                }
+            }
+        }
+
+        /**
+         * This method finds the headers of the given raw message, calling
+         * the given handler with each one, in order.
+         *
+         * @param[in] rawMessage
+         *      This is the string rendering of the message to parse.
+         *
+         * @param[in] handler
+         *      This is the function to call with the name and value of
+         *      each header, both as a std::string_view.
+         *
+         * @return
+         *      whether or not the message was parsed successfully
+         *      is returned.
+         */
+        template <typename Handler>
+        State ParseRawMessage(std::string_view rawMessage, Handler&& handler)
+        {
+            size_t bodyOffset;
+            return ParseRawMessage(rawMessage, bodyOffset, std::forward<Handler>(handler));
+        }
+
+        /**
+         * This method sets a limit for the number of characters
+         * in any header line.
+         *
+         * @param[in] lineLengthLimit
+         *      This is the maximum number of characters, including
+         *      the 2-characters CRLF line terminator, that should
+         *      be allowed for a single header line.
+         */
+        void SetLineLimit(size_t lineLengthLimit);
+
+        /**
+         * This method selects the rules that the names of headers
+         * must follow.  Headers whose names break these rules, or whose
+         * values contain control characters, are still handed over, but
+         * make the parser invalid.
+         *
+         * @param[in] strictness
+         *      This selects the rules that header names must follow.
+         */
+        void SetStrictness(Strictness strictness);
+
+        /**
+         * This method sets limits on the resources a single header block
+         * may use, beyond which parsing fails.
+         *
+         * @param[in] limits
+         *      These are the limits to enforce.
+         */
+        void SetLimits(const Limits& limits);
+
+        /**
+         * This method checks whether or not all the headers handed over
+         * since the parser was constructed or last cleared passed all
+         * validity checks.
+         *
+         * @return
+         *      An indication of whether or not the headers are valid
+         *      is returned.
+         */
+        bool IsValid() const;
+
+        /**
+         * This method forgets any parse in progress, and whether or not
+         * the headers were valid, so that the parser can be used for
+         * another message.  Its settings are kept.
+         */
+        void Clear();
+
+        // Private properties
+    private:
+        /**
+         * This is used to find the headers in raw messages,
+         * remembering where it left off when the raw message
+         * turns out to be incomplete.
+         */
+        HeaderScanner scanner_;
+
+        /**
+         * This is used to hold each folded header value as it's
+         * unfolded, so that its capacity can be reused for the next one.
+         */
+        std::string unfoldedValue_;
+
+        /**
+         * This indicates whether or not all validity checks
+         * have passed for the headers.
+         */
+        bool valid_ = true;
+    };
+}  // namespace MessageHeaders
+
+#endif /* MESSAGE_HEADERS_HEADER_EVENT_PARSER_HPP */
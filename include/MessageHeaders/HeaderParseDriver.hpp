@@ -0,0 +1,239 @@
+#ifndef MESSAGE_HEADERS_HEADER_PARSE_DRIVER_HPP
+#define MESSAGE_HEADERS_HEADER_PARSE_DRIVER_HPP
+/**
+ * @file HeaderParseDriver.hpp
+ *
+ * This module contains the declaration of the MessageHeaders::HeaderParseDriver class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stddef.h>
+#include <MessageHeaders/MessageHeaders.hpp>
+#include <string_view>
+
+#if defined(__cpp_impl_coroutine) && (__cpp_impl_coroutine >= 201902L)
+#include <coroutine>
+#endif
+
+namespace MessageHeaders
+{
+    /**
+     * This class drives the incremental parse of the header block of
+     * a message which arrives a piece at a time, such as from a
+     * non-blocking socket, into a MessageHeaders::MessageHeaders object.
+     *
+     * Whoever receives characters hands the driver a view of everything
+     * received so far for the message, each time more arrives.  The
+     * buffer belongs to the caller, and may move or grow between calls,
+     * as long as it begins with the same characters; nothing is copied
+     * out of it, other than what the MessageHeaders object keeps.  Since
+     * the parser needs the header block to be contiguous, a ring buffer
+     * must be linearized (for example by mirroring it, or by moving the
+     * unparsed part to its start) before being handed over.
+     *
+     * Whoever needs the headers waits for the parse to finish, either by
+     * polling GetOutcome, or, when compiled as C++20, by co_await-ing the
+     * object returned by Parse, which suspends the coroutine until the
+     * header block is complete or found to be bad, and then resumes it
+     * from within the call to Receive or Close.
+     *
+     * The driver isn't thread-safe; characters must be handed over on
+     * the thread running the waiting coroutine, or with the caller's own
+     * synchronization.
+     */
+    class HeaderParseDriver
+    {
+        // Types
+    public:
+        /**
+         * This is the type used to report the outcome of parsing.
+         */
+        typedef MessageHeaders::State State;
+
+        /**
+         * This describes how far the parse got.
+         */
+        struct Outcome
+        {
+            /**
+             * This is the outcome of parsing the header block, which
+             * is State::Incomplete until it's complete or bad.
+             */
+            State state = State::Incomplete;
+
+            /**
+             * This is the offset into the buffer where the body begins,
+             * if the header block is complete, or the number of characters
+             * consumed so far otherwise.
+             */
+            size_t bodyOffset = 0;
+        };
+
+        // Lifecycle management
+    public:
+        ~HeaderParseDriver() noexcept = default;
+        HeaderParseDriver(const HeaderParseDriver&) = delete;
+        HeaderParseDriver(HeaderParseDriver&&) noexcept = delete;
+        HeaderParseDriver& operator=(const HeaderParseDriver&) = delete;
+        HeaderParseDriver& operator=(HeaderParseDriver&&) noexcept = delete;
+
+        // Public Methods
+    public:
+        /**
+         * This constructs the driver.
+         *
+         * @param[in,out] headers
+         *      This is where to store the headers parsed.  It must
+         *      outlive the driver.
+         */
+        explicit HeaderParseDriver(MessageHeaders& headers);
+
+        /**
+         * This method hands over everything received so far for the
+         * message, resuming the parse where it left off, and resuming
+         * the coroutine waiting for the parse, if any, once it's done.
+         * Nothing happens once the parse is done.
+         *
+         * @param[in] buffer
+         *      This is everything received so far for the message,
+         *      beginning with its header block.
+         *
+         * @return
+         *      The outcome of the parse so far is returned.
+         */
+        Outcome Receive(std::string_view buffer);
+
+        /**
+         * This method indicates that no more characters will arrive for
+         * the message, such as when the connection is closed.  Unless
+         * the parse was done, it fails, dropping the headers it found
+         * so far, and the coroutine waiting for it, if any, is resumed.
+         */
+        void Close();
+
+        /**
+         * This method returns how far the parse got.
+         *
+         * @return
+         *      The outcome of the parse so far is returned.
+         */
+        Outcome GetOutcome() const;
+
+        /**
+         * This method checks whether or not the parse is done, either
+         * because the header block is complete, or because it's bad.
+         *
+         * @return
+         *      An indication of whether or not the parse is done
+         *      is returned.
+         */
+        bool IsDone() const;
+
+        /**
+         * This method forgets the outcome of the parse, so that the driver
+         * can be used for the header block of another message.  A parse
+         * which isn't done is abandoned, dropping the headers it found so
+         * far; the headers of header blocks already parsed are left alone.
+         *
+         * @note
+         *      This must not be called while a coroutine waits for the parse.
+         */
+        void Reset();
+
+#if defined(__cpp_impl_coroutine) && (__cpp_impl_coroutine >= 201902L)
+        /**
+         * This is the type of object which a coroutine can co_await to
+         * wait for the parse to finish.  The outcome of the parse is
+         * the result of the co_await expression.
+         */
+        class Awaiter
+        {
+        public:
+            explicit Awaiter(HeaderParseDriver& driver) : driver_(driver) {}
+
+            bool await_ready() const noexcept { return driver_.IsDone(); }
+
+            void await_suspend(std::coroutine_handle<> coroutine) noexcept
+            {
+                driver_.Suspend(
+                    [](void* address) { std::coroutine_handle<>::from_address(address).resume(); },
+                    coroutine.address());
+            }
+
+            Outcome await_resume() const noexcept { return driver_.GetOutcome(); }
+
+        private:
+            /**
+             * This is the driver whose parse is awaited.
+             */
+            HeaderParseDriver& driver_;
+        };
+
+        /**
+         * This method returns an object which a coroutine can co_await
+         * to wait until the parse is done.
+         *
+         * @return
+         *      An object to co_await for the outcome of the parse
+         *      is returned.
+         */
+        Awaiter Parse() { return Awaiter(*this); }
+#endif
+
+        // Private Methods
+    private:
+        /**
+         * This is the type of function called to resume
+         * whatever waits for the parse.
+         *
+         * @param[in] waiter
+         *      This is what was given to Suspend along with the function.
+         */
+        typedef void (*Resumer)(void* waiter);
+
+        /**
+         * This method remembers what to resume when the parse is done.
+         * It lets the awaiter type, which is only there when compiled as
+         * C++20, suspend coroutines without changing the layout of the
+         * class.
+         *
+         * @param[in] resumer
+         *      This is the function to call when the parse is done.
+         *
+         * @param[in] waiter
+         *      This is passed through to the function.
+         */
+        void Suspend(Resumer resumer, void* waiter);
+
+        /**
+         * This method resumes whatever waits for the parse, if anything.
+         */
+        void ResumeWaiter();
+
+        // Private properties
+    private:
+        /**
+         * This is where to store the headers parsed.
+         */
+        MessageHeaders& headers_;
+
+        /**
+         * This is how far the parse got.
+         */
+        Outcome outcome_;
+
+        /**
+         * This is the function to call to resume whatever waits
+         * for the parse, or nullptr if nothing does.
+         */
+        Resumer resumer_ = nullptr;
+
+        /**
+         * This is passed through to the resumer function.
+         */
+        void* waiter_ = nullptr;
+    };
+}  // namespace MessageHeaders
+
+#endif /* MESSAGE_HEADERS_HEADER_PARSE_DRIVER_HPP */
@@ -0,0 +1,429 @@
+#ifndef MESSAGE_HEADERS_HEADER_SCANNER_HPP
+#define MESSAGE_HEADERS_HEADER_SCANNER_HPP
+/**
+ * @file HeaderScanner.hpp
+ *
+ * This module contains the declaration of the MessageHeaders::HeaderScanner class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stddef.h>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+namespace MessageHeaders
+{
+    /**
+     * This class splits the header block of a raw message into headers,
+     * without copying anything out of the raw message.  Each header found
+     * is described by offsets into the raw message, so that the scanner
+     * can be suspended when the raw message is incomplete, and resumed
+     * later on a longer copy of the same raw message, examining only
+     * the characters it hasn't consumed yet.
+     */
+    class HeaderScanner
+    {
+        // Types
+    public:
+        /**
+         * These are the possible outcomes of looking for the next header.
+         */
+        enum class Result
+        {
+            /**
+             * A complete header was found.
+             */
+            Header,
+
+            /**
+             * The blank line which ends the header block was found.
+             */
+            End,
+
+            /**
+             * More characters are needed to find the next header.
+             */
+            Incomplete,
+
+            /**
+             * Unrecoverable error, rejected input.
+             */
+            Error
+        };
+
+        /**
+         * These select the rules that the names of headers must follow.
+         */
+        enum class Strictness
+        {
+            /**
+             * Header names may contain any visible character except
+             * the colon ("ftext" from RFC 5322).
+             */
+            Email,
+
+            /**
+             * Header names must be tokens as defined by RFC 7230.
+             */
+            Http,
+
+            /**
+             * Header names must be tokens as defined by RFC 3261.
+             */
+            Sip
+        };
+
+        /**
+         * These are limits on the resources a single header block may
+         * use.  Any of them set to zero means there is no such limit.
+         * A header block which breaks one of them is rejected as soon
+         * as that's known, without looking at the rest of it.
+         */
+        struct Limits
+        {
+            /**
+             * This is the maximum number of headers allowed
+             * in the header block.
+             */
+            size_t headerCount = 0;
+
+            /**
+             * This is the maximum number of characters allowed in the
+             * header block, including the blank line which ends it.
+             */
+            size_t blockSize = 0;
+
+            /**
+             * This is the maximum number of continuation lines onto
+             * which any single header may be folded.
+             */
+            size_t continuationLines = 0;
+        };
+
+        /**
+         * This describes where a single header was found in the raw message.
+         */
+        struct ScannedHeader
+        {
+            /**
+             * This is the offset into the raw message of the header name.
+             */
+            size_t nameOffset = 0;
+
+            /**
+             * This is the number of characters in the header name.
+             */
+            size_t nameLength = 0;
+
+            /**
+             * This is the offset into the raw message of the first character
+             * after the colon that delimits the header name.
+             */
+            size_t valueOffset = 0;
+
+            /**
+             * This is the offset into the raw message of the line terminator
+             * of the last line of the header.
+             */
+            size_t valueEnd = 0;
+
+            /**
+             * This indicates whether or not the header value continues
+             * on one or more folded lines.
+             */
+            bool folded = false;
+
+            /**
+             * This indicates whether or not the header name contains
+             * only characters permitted in header names.
+             */
+            bool validName = true;
+
+            /**
+             * This indicates whether or not the header value contains
+             * only visible characters, whitespace and "obs-text" (no
+             * control characters other than horizontal tabs).
+             */
+            bool validValue = true;
+        };
+
+        // Public Methods
+    public:
+        /**
+         * This method sets a limit for the number of characters
+         * in any header line.
+         *
+         * @param[in] lineLengthLimit
+         *      This is the maximum number of characters, including
+         *      the 2-characters CRLF line terminator, that should
+         *      be allowed for a single header line, or zero if
+         *      there is no limit.
+         */
+        void SetLineLimit(size_t lineLengthLimit);
+
+        /**
+         * This method selects the rules that the names of headers
+         * must follow in order to be considered valid.
+         *
+         * @param[in] strictness
+         *      This selects the rules that header names must follow.
+         */
+        void SetStrictness(Strictness strictness);
+
+        /**
+         * This method sets limits on the resources a single header
+         * block may use.
+         *
+         * @param[in] limits
+         *      These are the limits to enforce.
+         */
+        void SetLimits(const Limits& limits);
+
+        /**
+         * This method looks for the next header in the given raw message,
+         * starting where the previous call left off.
+         *
+         * @param[in] rawMessage
+         *      This is the raw message to scan.  It must begin with the
+         *      characters passed to all previous calls since the last reset.
+         *
+         * @param[out] header
+         *      This is where to store the location of the header found,
+         *      if Result::Header is returned.
+         *
+         * @return
+         *      The outcome of looking for the next header is returned.
+         */
+        Result Next(std::string_view rawMessage, ScannedHeader& header);
+
+        /**
+         * This method looks for the next header in the given raw message,
+         * starting where the previous call left off, following the rules
+         * of the given profile, which are fixed at compile time so that
+         * features the protocol doesn't need are left out of the loop.
+         * The rules for header names, if the profile fixes them, override
+         * the configured strictness, and the profile's line limit applies
+         * unless a line limit is configured.
+         *
+         * @param[in] rawMessage
+         *      This is the raw message to scan.  It must begin with the
+         *      characters passed to all previous calls since the last reset.
+         *
+         * @param[out] header
+         *      This is where to store the location of the header found,
+         *      if Result::Header is returned.
+         *
+         * @return
+         *      The outcome of looking for the next header is returned.
+         *
+         * @note
+         *      Only the profiles declared in ParserProfiles.hpp are supported.
+         */
+        template <typename Profile> Result Next(std::string_view rawMessage, ScannedHeader& header);
+
+        /**
+         * This method returns the number of characters of the raw message
+         * consumed so far.  Once Result::End is returned, this is the
+         * offset where the headers ended and the body begins.
+         *
+         * @return
+         *      The number of characters consumed so far is returned.
+         */
+        size_t GetOffset() const;
+
+        /**
+         * This method returns the length of the raw message passed to the
+         * last call to Next since the last reset, which any raw message
+         * continuing the same header block must be at least as long as.
+         * Unlike the offset, this is only zero if no parse is under way,
+         * even if the first line isn't complete yet.
+         *
+         * @return
+         *      The length of the raw message scanned last is returned.
+         */
+        size_t GetScannedLength() const;
+
+        /**
+         * This method forgets everything about the raw message scanned
+         * so far, so that the next call to Next starts over at the
+         * beginning of its raw message.
+         */
+        void Reset();
+
+        /**
+         * This function returns the name of the given header
+         * found in the given raw message.
+         *
+         * @param[in] rawMessage
+         *      This is the raw message in which the header was found.
+         *
+         * @param[in] header
+         *      This is the header whose name should be returned.
+         *
+         * @return
+         *      A view of the header name in the raw message is returned.
+         */
+        static std::string_view GetName(std::string_view rawMessage, const ScannedHeader& header);
+
+        /**
+         * This function returns the value of the given header found in
+         * the given raw message, without any margin whitespace.  If the
+         * header is folded, the value still contains its line terminators
+         * and should instead be obtained with UnfoldValue.
+         *
+         * @param[in] rawMessage
+         *      This is the raw message in which the header was found.
+         *
+         * @param[in] header
+         *      This is the header whose value should be returned.
+         *
+         * @return
+         *      A view of the header value in the raw message is returned.
+         */
+        static std::string_view GetValue(std::string_view rawMessage, const ScannedHeader& header);
+
+        /**
+         * This function unfolds the value of the given header found in the
+         * given raw message, and strips any margin whitespace from it.
+         *
+         * @param[in] rawMessage
+         *      This is the raw message in which the header was found.
+         *
+         * @param[in] header
+         *      This is the header whose value should be unfolded.
+         *
+         * @param[out] value
+         *      This is where to store the unfolded header value.
+         *      Its previous contents are replaced, but its capacity is reused.
+         */
+        static void UnfoldValue(std::string_view rawMessage, const ScannedHeader& header,
+                                std::string& value);
+
+        /**
+         * This function unfolds the value of the given header found in the
+         * given raw message, and strips any margin whitespace from it,
+         * storing the result in a string allocated from a memory resource.
+         *
+         * @param[in] rawMessage
+         *      This is the raw message in which the header was found.
+         *
+         * @param[in] header
+         *      This is the header whose value should be unfolded.
+         *
+         * @param[out] value
+         *      This is where to store the unfolded header value.
+         *      Its previous contents are replaced, but its capacity is reused.
+         */
+        static void UnfoldValue(std::string_view rawMessage, const ScannedHeader& header,
+                                std::pmr::string& value);
+
+        /**
+         * This function returns the given string without any whitespace
+         * that might be at its beginning or end.
+         *
+         * @param[in] s
+         *      This is the string to strip.
+         *
+         * @return
+         *      A view of the given string without its margin
+         *      whitespace is returned.
+         */
+        static std::string_view StripMarginWhitespace(std::string_view s);
+
+        // Private properties
+    private:
+        /**
+         * This is the maximum number of characters, including
+         * the 2-characters CRLF line terminator, that should
+         * be allowed for a single header line.
+         */
+        size_t lineLengthLimit_ = 0;
+
+        /**
+         * This selects the rules that header names must follow.
+         */
+        Strictness strictness_ = Strictness::Email;
+
+        /**
+         * These are the limits on the resources a single header
+         * block may use.
+         */
+        Limits limits_;
+
+        /**
+         * This is the number of headers found so far in the
+         * header block, including the pending header.
+         */
+        size_t headerCount_ = 0;
+
+        /**
+         * This is the number of continuation lines folded so far
+         * into the pending header.
+         */
+        size_t continuationLines_ = 0;
+
+        /**
+         * This is the offset into the raw message of the first line
+         * which hasn't yet been consumed.
+         */
+        size_t parseOffset_ = 0;
+
+        /**
+         * This is the length of the raw message passed to the last call
+         * to Next since the last reset.
+         */
+        size_t scannedLength_ = 0;
+
+        /**
+         * This is the offset into the raw message where the search for
+         * the next line terminator resumes, so that characters already
+         * known not to contain one aren't scanned again.
+         */
+        size_t scanOffset_ = 0;
+
+        /**
+         * This indicates whether or not the line beginning at parseOffset_
+         * has already been scanned, by a call that returned the header
+         * preceding it.
+         */
+        bool lineScanned_ = false;
+
+        /**
+         * This is the offset of the line terminator of the line already
+         * scanned, if lineScanned_ is set.
+         */
+        size_t scannedLineTerminator_ = 0;
+
+        /**
+         * This is the offset of the first colon at or after the start of
+         * the line already scanned, or npos if none was found.  This is
+         * also kept for the part of a line scanned before running out
+         * of characters.
+         */
+        size_t scannedColon_ = 0;
+
+        /**
+         * This is the offset of the first control character at or after
+         * the start of the line already scanned, or npos if none was
+         * found.  This is also kept for the part of a line scanned before
+         * running out of characters.
+         */
+        size_t scannedControl_ = 0;
+
+        /**
+         * This indicates whether or not a header line has been consumed
+         * but not yet returned, because the lines that follow it might
+         * still fold into its value.
+         */
+        bool pendingHeader_ = false;
+
+        /**
+         * This is the location of the pending header.
+         */
+        ScannedHeader pending_;
+    };
+}  // namespace MessageHeaders
+
+#endif /* MESSAGE_HEADERS_HEADER_SCANNER_HPP */
@@ -0,0 +1,98 @@
+#ifndef MESSAGE_HEADERS_HEADER_TOKENIZER_HPP
+#define MESSAGE_HEADERS_HEADER_TOKENIZER_HPP
+/**
+ * @file HeaderTokenizer.hpp
+ *
+ * This module contains the declaration of the MessageHeaders::HeaderTokenizer class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stddef.h>
+#include <string_view>
+
+namespace MessageHeaders
+{
+    /**
+     * This class splits a header value which holds a list of elements,
+     * such as the values of Accept, Allow or Via headers, into its
+     * elements, without copying any of them.  Each element is a view
+     * into the header value, which must therefore outlive the tokenizer
+     * and the elements it finds.
+     *
+     * Empty elements, such as those between two consecutive delimiters,
+     * are skipped, as RFC 7230 (https://tools/ieft.org/html/rfc7230)
+     * requires of recipients of lists.
+     */
+    class HeaderTokenizer
+    {
+        // Public Methods
+    public:
+        /**
+         * This constructs the tokenizer at the beginning of the given
+         * header value.
+         *
+         * @param[in] value
+         *      This is the header value to split into elements.
+         *
+         * @param[in] trimWhitespace
+         *      This indicates whether or not whitespace at the beginning
+         *      or end of each element should be left out of it.
+         *
+         * @param[in] quotedStrings
+         *      This indicates whether or not delimiters inside quoted
+         *      strings (between double quotes, where a backslash escapes
+         *      the character after it) should be treated as part of the
+         *      element rather than ending it.
+         *
+         * @param[in] delimiter
+         *      This is the character that separates elements.
+         */
+        explicit HeaderTokenizer(std::string_view value, bool trimWhitespace = true,
+                                 bool quotedStrings = true, char delimiter = ',');
+
+        /**
+         * This method finds the next element of the header value.
+         *
+         * @param[out] token
+         *      This is where to store the element found.
+         *
+         * @return
+         *      An indication of whether or not another element
+         *      was found is returned.
+         */
+        bool Next(std::string_view& token);
+
+        // Private properties
+    private:
+        /**
+         * This is the header value being split into elements.
+         */
+        std::string_view value_;
+
+        /**
+         * This is the offset into the header value where
+         * the search for the next element begins.
+         */
+        size_t offset_ = 0;
+
+        /**
+         * This indicates whether or not whitespace at the beginning
+         * or end of each element should be left out of it.
+         */
+        bool trimWhitespace_;
+
+        /**
+         * This indicates whether or not delimiters inside quoted
+         * strings are treated as part of the element.
+         */
+        bool quotedStrings_;
+
+        /**
+         * This is the character that separates elements.
+         */
+        char delimiter_;
+    };
+}  // namespace MessageHeaders
+
+#endif /* MESSAGE_HEADERS_HEADER_TOKENIZER_HPP */
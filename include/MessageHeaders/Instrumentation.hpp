@@ -0,0 +1,139 @@
+#ifndef MESSAGE_HEADERS_INSTRUMENTATION_HPP
+#define MESSAGE_HEADERS_INSTRUMENTATION_HPP
+/**
+ * @file Instrumentation.hpp
+ *
+ * This module contains the declaration of the MessageHeaders::Instrumentation class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stdint.h>
+
+namespace MessageHeaders
+{
+    /**
+     * This class gives access to counters of what the library does
+     * while parsing, looking up and generating headers, so that they
+     * can be scraped into a metrics system.
+     *
+     * The counters are only kept if the library is built with the
+     * MESSAGE_HEADERS_INSTRUMENTATION option, and cost nothing otherwise.
+     * They're shared by all threads, and updated without ordering, so a
+     * snapshot taken while other threads are busy may be slightly behind.
+     */
+    class Instrumentation
+    {
+        // Types
+    public:
+        /**
+         * This holds the values of all the counters at one moment.
+         */
+        struct Snapshot
+        {
+            /**
+             * This is the number of header blocks parsed to the end.
+             */
+            uint64_t messagesParsed = 0;
+
+            /**
+             * This is the number of headers parsed.  Dividing it by
+             * messagesParsed gives the average number of headers per message.
+             */
+            uint64_t headersParsed = 0;
+
+            /**
+             * This is the number of headers parsed which were folded
+             * onto more than one line.
+             */
+            uint64_t foldedHeadersParsed = 0;
+
+            /**
+             * This is the number of parses which ran out of characters
+             * before reaching the end of the header block.
+             */
+            uint64_t incompleteParses = 0;
+
+            /**
+             * This is the number of characters which had already been
+             * scanned by a parse that ran out of characters, and which were
+             * scanned again when the parse was resumed.
+             */
+            uint64_t bytesRescanned = 0;
+
+            /**
+             * This is the number of parses which failed.
+             */
+            uint64_t parseErrors = 0;
+
+            /**
+             * This is the number of parses which failed because a header
+             * line was longer than the line length limit.
+             */
+            uint64_t lineLimitErrors = 0;
+
+            /**
+             * This is the number of parses which failed because the header
+             * block had too many headers, too many characters, or a header
+             * folded onto too many lines.
+             */
+            uint64_t limitErrors = 0;
+
+            /**
+             * This is the number of times a header was looked up
+             * and found.
+             */
+            uint64_t lookupHits = 0;
+
+            /**
+             * This is the number of times a header was looked up
+             * and not found.
+             */
+            uint64_t lookupMisses = 0;
+
+            /**
+             * This is the number of times raw headers were generated.
+             */
+            uint64_t rawHeadersGenerated = 0;
+
+            /**
+             * This is the number of characters of raw headers generated.
+             */
+            uint64_t rawBytesGenerated = 0;
+
+            /**
+             * This is the number of header lines generated which had
+             * to be folded to stay within the line length limit.
+             */
+            uint64_t headerLinesFolded = 0;
+        };
+
+        // Public Methods
+    public:
+        /**
+         * This function returns an indication of whether or not the
+         * library was built to keep its counters.
+         *
+         * @return
+         *      An indication of whether or not the counters
+         *      are kept is returned.
+         */
+        static bool IsEnabled();
+
+        /**
+         * This function returns the current values of the counters,
+         * which are all zero if they aren't kept.
+         *
+         * @return
+         *      The current values of the counters are returned.
+         */
+        static Snapshot GetSnapshot();
+
+        /**
+         * This function sets all the counters back to zero.
+         */
+        static void Reset();
+    };
+}  // namespace MessageHeaders
+
+#endif /* MESSAGE_HEADERS_INSTRUMENTATION_HPP */
@@ -0,0 +1,93 @@
+#ifndef MESSAGE_HEADERS_MAPPED_FILE_HPP
+#define MESSAGE_HEADERS_MAPPED_FILE_HPP
+/**
+ * @file MappedFile.hpp
+ *
+ * This module contains the declaration of the MessageHeaders::MappedFile class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace MessageHeaders
+{
+    /**
+     * This class maps a whole file into memory, read-only, so that its
+     * contents can be parsed where they are, without reading them into
+     * a buffer first.  The operating system only pages in the parts of
+     * the file which are actually touched.
+     */
+    class MappedFile
+    {
+        // Lifecycle management
+    public:
+        ~MappedFile() noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile(MappedFile&&) noexcept;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile& operator=(MappedFile&&) noexcept;
+
+        // Public Methods
+    public:
+        /**
+         * This is the default constructor, which maps no file.
+         */
+        MappedFile();
+
+        /**
+         * This method maps the file at the given path into memory,
+         * unmapping any file mapped before.
+         *
+         * @param[in] path
+         *      This is the path of the file to map.
+         *
+         * @return
+         *      An indication of whether or not the file was
+         *      mapped successfully is returned.
+         */
+        bool Open(const std::string& path);
+
+        /**
+         * This method unmaps the file mapped, if any.  Views of its
+         * contents are no longer valid afterwards.
+         */
+        void Close();
+
+        /**
+         * This method checks whether or not a file is mapped.
+         *
+         * @return
+         *      An indication of whether or not a file is mapped is returned.
+         */
+        bool IsOpen() const;
+
+        /**
+         * This method returns the contents of the file mapped, which
+         * remain valid until the file is unmapped.
+         *
+         * @return
+         *      The contents of the file mapped are returned, or an
+         *      empty view if no file is mapped.
+         */
+        std::string_view GetContents() const;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr<struct Impl> impl_;
+    };
+}  // namespace MessageHeaders
+
+#endif /* MESSAGE_HEADERS_MAPPED_FILE_HPP */
@@ -0,0 +1,331 @@
+#ifndef MESSAGE_HEADERS_MESSAGE_FILE_SCANNER_HPP
+#define MESSAGE_HEADERS_MESSAGE_FILE_SCANNER_HPP
+/**
+ * @file MessageFileScanner.hpp
+ *
+ * This module contains the declaration of the MessageHeaders::MessageFileScanner class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stddef.h>
+#include <MessageHeaders/MessageHeadersView.hpp>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace MessageHeaders
+{
+    /**
+     * This class walks through the contents of a file holding many
+     * messages, such as an mbox mail archive or a SIP trace, typically
+     * mapped into memory with MessageHeaders::MappedFile, finding where
+     * each message begins and ends and parsing its header block where
+     * it is, with MessageHeaders::MessageHeadersView.
+     *
+     * Header blocks whose lines end in a bare line feed, as is usual
+     * in mbox files, are the only ones copied, since the header parser
+     * expects CRLF line terminators; only the header block is copied,
+     * never the body.
+     *
+     * Files in which messages are framed by "From " lines can be split
+     * between several threads, at message boundaries, since these can be
+     * found anywhere in the file.  Files in which messages are framed by
+     * their Content-Length header are always walked by a single thread,
+     * since each message has to be parsed to find the next one.
+     */
+    class MessageFileScanner
+    {
+        // Types
+    public:
+        /**
+         * This is the type used to report the outcome of parsing
+         * a header block.
+         */
+        typedef MessageHeadersView::State State;
+
+        /**
+         * This selects how messages are laid out in the file.
+         */
+        enum class Framing
+        {
+            /**
+             * Each message begins with a "From " line, at the beginning
+             * of the file or after a blank line, as in mbox files.  The
+             * header block follows the "From " line, and the message
+             * ends where the next one begins.
+             */
+            Mbox,
+
+            /**
+             * Messages follow each other directly, each one beginning with
+             * a request or status line, followed by the header block, and
+             * a body as long as its Content-Length header (or its compact
+             * form, "l") says, as in traces of SIP over TCP.  Blank lines
+             * between messages, such as keep-alives, are skipped.
+             */
+            ContentLength
+        };
+
+        /**
+         * This describes where a single message is in the file.
+         */
+        struct Message
+        {
+            /**
+             * This is the offset of the first character of the message.
+             */
+            size_t offset = 0;
+
+            /**
+             * This is the offset of the first character of the header block.
+             */
+            size_t headersOffset = 0;
+
+            /**
+             * This is the offset of the first character of the body, if
+             * the header block is complete, or the end of the message
+             * otherwise.
+             */
+            size_t bodyOffset = 0;
+
+            /**
+             * This is the offset just past the last character of the message.
+             */
+            size_t end = 0;
+
+            /**
+             * This is the outcome of parsing the header block.
+             */
+            State state = State::Incomplete;
+
+            /**
+             * This indicates whether or not all the headers of the message
+             * passed the validity checks.
+             */
+            bool valid = true;
+        };
+
+        /**
+         * This is the type used to configure the parsing of header blocks.
+         */
+        typedef MessageHeadersView::Strictness Strictness;
+
+        /**
+         * These are limits on the resources a single header block may use.
+         */
+        typedef MessageHeadersView::Limits Limits;
+
+        // Public Methods
+    public:
+        /**
+         * This constructs the scanner.
+         *
+         * @param[in] framing
+         *      This selects how messages are laid out in the files scanned.
+         *
+         * @param[in] threadCount
+         *      This is the number of threads, including the calling one,
+         *      which should share the work of scanning files whose framing
+         *      allows it, or zero to use as many as the hardware can run
+         *      at once.
+         */
+        explicit MessageFileScanner(Framing framing = Framing::Mbox, size_t threadCount = 1);
+
+        /**
+         * This method finds all the messages in the given file contents.
+         *
+         * @param[in] contents
+         *      These are the contents of the file to scan.
+         *
+         * @return
+         *      A description of each message found is returned,
+         *      in the order in which they're in the file.
+         */
+        std::vector<Message> Index(std::string_view contents) const;
+
+        /**
+         * This method finds all the messages in the given file contents,
+         * calling the given handler with each one, along with its headers.
+         * If the work is shared between several threads, the handler
+         * is called from all of them at once, and the messages of
+         * different parts of the file aren't handed over in order.
+         *
+         * @param[in] contents
+         *      These are the contents of the file to scan.
+         *
+         * @param[in] handler
+         *      This is the function to call with each message, as a
+         *      const Message&, and its headers, as a const
+         *      MessageHeadersView&.  The headers refer to the contents
+         *      of the file, unless they had to be copied, in which case
+         *      they're only valid during the call.
+         */
+        template <typename Handler>
+        void ForEachMessage(std::string_view contents, Handler&& handler) const
+        {
+            using HandlerType = std::remove_reference_t<Handler>;
+            VisitMessages(
+                contents,
+                [](void* context, size_t, const Message& message,
+                   const MessageHeadersView& headers)
+                { (*static_cast<HandlerType*>(context))(message, headers); },
+                const_cast<void*>(static_cast<const void*>(&handler)));
+        }
+
+        /**
+         * This method sets a limit for the number of characters
+         * in any header line.
+         *
+         * @param[in] lineLengthLimit
+         *      This is the maximum number of characters, including
+         *      the 2-characters CRLF line terminator, that should
+         *      be allowed for a single header line.
+         */
+        void SetLineLimit(size_t lineLengthLimit);
+
+        /**
+         * This method selects the rules that the names of headers
+         * must follow.
+         *
+         * @param[in] strictness
+         *      This selects the rules that header names must follow.
+         */
+        void SetStrictness(Strictness strictness);
+
+        /**
+         * This method sets limits on the resources a single header block
+         * may use, beyond which parsing it fails.
+         *
+         * @param[in] limits
+         *      These are the limits to enforce.
+         */
+        void SetLimits(const Limits& limits);
+
+        // Private Methods
+    private:
+        /**
+         * This is the type of function called with each message
+         * by the VisitMessages method.
+         *
+         * @param[in] context
+         *      This is the context given to VisitMessages.
+         *
+         * @param[in] part
+         *      This is the position of the part of the file in which
+         *      the message was found, parts being numbered in the order
+         *      in which they're in the file.
+         *
+         * @param[in] message
+         *      This describes where the message is in the file.
+         *
+         * @param[in] headers
+         *      These are the headers of the message.
+         */
+        typedef void (*MessageVisitor)(void* context, size_t part, const Message& message,
+                                       const MessageHeadersView& headers);
+
+        /**
+         * This method finds all the messages in the given file contents,
+         * calling the given function with each one.  It lets the visitor
+         * templates do their work without exposing the implementation.
+         *
+         * @param[in] contents
+         *      These are the contents of the file to scan.
+         *
+         * @param[in] visitor
+         *      This is the function to call with each message.
+         *
+         * @param[in] context
+         *      This is passed through to the visitor function.
+         *
+         * @return
+         *      The number of parts into which the file was split
+         *      is returned.
+         */
+        size_t VisitMessages(std::string_view contents, MessageVisitor visitor,
+                             void* context) const;
+
+        /**
+         * This method finds the messages of the given part of the given
+         * file contents, framed by "From " lines, which must begin
+         * where the part begins.
+         *
+         * @param[in] contents
+         *      These are the contents of the file to scan.
+         *
+         * @param[in] begin
+         *      This is the offset where the part begins.
+         *
+         * @param[in] end
+         *      This is the offset where the part ends.
+         *
+         * @param[in] part
+         *      This is the position of the part.
+         *
+         * @param[in] visitor
+         *      This is the function to call with each message.
+         *
+         * @param[in] context
+         *      This is passed through to the visitor function.
+         */
+        void ScanMbox(std::string_view contents, size_t begin, size_t end, size_t part,
+                      MessageVisitor visitor, void* context) const;
+
+        /**
+         * This method finds the messages of the given file contents,
+         * framed by their Content-Length headers.
+         *
+         * @param[in] contents
+         *      These are the contents of the file to scan.
+         *
+         * @param[in] visitor
+         *      This is the function to call with each message.
+         *
+         * @param[in] context
+         *      This is passed through to the visitor function.
+         */
+        void ScanContentLength(std::string_view contents, MessageVisitor visitor,
+                               void* context) const;
+
+        /**
+         * This method sets up the given object with the settings
+         * used to parse header blocks.
+         *
+         * @param[in,out] headers
+         *      This is the object to set up.
+         */
+        void Configure(MessageHeadersView& headers) const;
+
+        // Private properties
+    private:
+        /**
+         * This selects how messages are laid out in the files scanned.
+         */
+        Framing framing_;
+
+        /**
+         * This is the number of threads which share the work of scanning
+         * files whose framing allows it.
+         */
+        size_t threadCount_;
+
+        /**
+         * This is the maximum number of characters allowed for a single
+         * header line, or zero for no limit.
+         */
+        size_t lineLengthLimit_ = 0;
+
+        /**
+         * This selects the rules that the names of headers must follow.
+         */
+        Strictness strictness_ = Strictness::Email;
+
+        /**
+         * These are limits on the resources a single header block may use.
+         */
+        Limits limits_;
+    };
+}  // namespace MessageHeaders
+
+#endif /* MESSAGE_HEADERS_MESSAGE_FILE_SCANNER_HPP */
@@ -9,11 +9,19 @@
  */
 
 #include <ctype.h>
+#include <stdint.h>
 #include <functional>
+#include <MessageHeaders/HeaderScanner.hpp>
+#include <MessageHeaders/HeaderTokenizer.hpp>
+#include <MessageHeaders/ParserProfiles.hpp>
+#include <MessageHeaders/WellKnownHeaders.hpp>
 #include <memory>
+#include <memory_resource>
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace MessageHeaders
@@ -24,6 +32,19 @@ namespace MessageHeaders
      * - e-mail : as defined in RFC 5322 (https://tools/ieft.org/html/rfc5322).
      * - HTTP (web): as defined in RFC 7230 (https://tools/ieft.org/html/rfc7230).
      * - SIP (VoIP): as defined in RFC 3261 (https://tools/ieft.org/html/rfc3261)
+     *
+     * Looking up headers by name builds an index of the headers the
+     * first time it's needed, even from const methods, so an object
+     * shouldn't be used from multiple threads at once without
+     * synchronization.
+     *
+     * The names and values of the headers of one object are kept in
+     * buffers of at most 4 GiB - 1 characters each (one for headers
+     * added or changed, one for the raw header blocks lazy values are
+     * parsed from), since their offsets are kept in 32 bits.  Parsing
+     * a header which doesn't fit fails the parse, while adding or
+     * changing one throws std::length_error, as a string which can't
+     * grow any longer would.
      */
 
     class MessageHeaders
@@ -51,6 +72,17 @@ namespace MessageHeaders
              */
             Error
         };
+
+        /**
+         * This selects the rules that the names of headers must follow.
+         */
+        typedef HeaderScanner::Strictness Strictness;
+
+        /**
+         * These are limits on the resources a single header block may use.
+         */
+        typedef HeaderScanner::Limits Limits;
+
         /**
          * This is how we handle the name of an Message header.
          */
@@ -69,7 +101,7 @@ namespace MessageHeaders
              * This is the default constractor
              *
              */
-            HeaderName() = default;
+            HeaderName();
 
             /**
              * This constructs the header name based on a normal C++ string.
@@ -79,13 +111,35 @@ namespace MessageHeaders
              */
             HeaderName(const std::string& s);
 
+            /**
+             * This constructs the header name by taking over the given
+             * C++ string, rather than copying it.
+             *
+             * @param[in] s
+             *      This is the name to set for the header name.
+             */
+            HeaderName(std::string&& s);
+
+            /**
+             * This constructs the header name based on a view of a string.
+             *
+             * @param[in] s
+             *      This is the name to set for the header name.
+             */
+            HeaderName(std::string_view s);
+
             /**
              * This constructs the header name based on a normal C string.
              *
              * @param[in] s
              *      This si the name to set for the header name.
              */
-            HeaderName(const char* s) : name_(s) {}
+            HeaderName(const char* s) :
+                name_(s),
+                hash_(Hash(name_)),
+                id_(FindWellKnownHeader(name_, hash_))
+            {
+            }
 
             /**
              * This assignment operator assigns the header name
@@ -111,6 +165,56 @@ namespace MessageHeaders
              */
             bool operator==(const HeaderName& rhs) const;
 
+            /**
+             * This function compares the given header names,
+             * without regard to case.
+             *
+             * @param[in] lhs
+             *      This is the first header name to compare.
+             *
+             * @param[in] rhs
+             *      This is the second header name to compare.
+             *
+             * @return
+             *      returns an indication of whether or not headers names
+             *      are equivalent (case-insensitive).
+             */
+            static bool Equivalent(std::string_view lhs, std::string_view rhs);
+
+            /**
+             * This method returns the hash of the header name, which is
+             * computed without regard to case, so that equivalent header
+             * names always have the same hash.
+             *
+             * @return
+             *      returns the case-insensitive hash of the header name.
+             */
+            uint32_t GetHash() const;
+
+            /**
+             * This method returns the identifier of the header name,
+             * if it's one of the well-known header names, so that it
+             * can be compared as an integer rather than as a string.
+             *
+             * @return
+             *      returns the identifier of the header name, or
+             *      WellKnownHeader::Unknown if it's not a well-known one.
+             */
+            WellKnownHeader GetId() const;
+
+            /**
+             * This function computes the hash of the given header name,
+             * without regard to case, so that equivalent header names
+             * always have the same hash.
+             *
+             * @param[in] name
+             *      This is the header name to hash.
+             *
+             * @return
+             *      returns the case-insensitive hash of the given header name.
+             */
+            static uint32_t Hash(std::string_view name);
+
             /**
              * This is used in range-for constructs, to get the beginning
              * iterator of the sequence. It's merely going to forward to
@@ -119,7 +223,7 @@ namespace MessageHeaders
              * @return
              *      returns the beginning iterator of the sequence.
              */
-            auto begin() const;
+            std::string::const_iterator begin() const { return name_.begin(); }
 
             /**
              * This is used in range-for constructs, to get the ending
@@ -129,7 +233,7 @@ namespace MessageHeaders
              * @return
              *      returns the ending iterator of the sequence.
              */
-            auto end() const;
+            std::string::const_iterator end() const { return name_.end(); }
 
             /**
              * This is the type cast operator to c++ string
@@ -144,6 +248,19 @@ namespace MessageHeaders
              * This is the content of the headerName.
              */
             std::string name_;
+
+            /**
+             * This is the case-insensitive hash of the header name,
+             * computed once so that it can be used to quickly rule out
+             * header names that aren't equivalent.
+             */
+            uint32_t hash_;
+
+            /**
+             * This is the identifier of the header name, if it's one
+             * of the well-known header names.
+             */
+            WellKnownHeader id_;
         };
 
         typedef std::string HeaderValue;
@@ -166,6 +283,18 @@ namespace MessageHeaders
             HeaderValue value;
 
             Header(const HeaderName& newName, const HeaderValue& newValue);
+
+            /**
+             * This constructs the header by taking over the given
+             * name and value, rather than copying them.
+             *
+             * @param[in] newName
+             *      This is the name of the header.
+             *
+             * @param[in] newValue
+             *      This is the value of the header.
+             */
+            Header(HeaderName&& newName, HeaderValue&& newValue) noexcept;
         };
 
         /**
@@ -173,6 +302,44 @@ namespace MessageHeaders
          * of the Message.
          */
         typedef std::vector<Header> Headers;
+
+        /**
+         * This represents a single change to make to the headers
+         * as part of a bulk edit.
+         */
+        struct HeaderEdit
+        {
+            /**
+             * These are the kinds of change that can be made.
+             */
+            enum class Action
+            {
+                /**
+                 * This sets the header, as the SetHeader method does.
+                 */
+                Set,
+
+                /**
+                 * This removes the header, as the RemoveHeader method does.
+                 */
+                Remove,
+            };
+
+            /**
+             * This is the kind of change to make.
+             */
+            Action action;
+
+            /**
+             * This is the name of the header to change.
+             */
+            HeaderName name;
+
+            /**
+             * This is the value to give the header, if it's being set.
+             */
+            HeaderValue value;
+        };
         // Lifecycle management
     public:
         ~MessageHeaders();
@@ -197,6 +364,32 @@ namespace MessageHeaders
          */
         MessageHeaders();
 
+        /**
+         * This constructs the object so that all of its headers, including
+         * their names and values, are allocated from the given memory
+         * resource, such as a per-connection arena which is released in
+         * one shot once the message has been handled.
+         *
+         * @param[in] resource
+         *      This is the memory resource from which to allocate the headers.
+         *      It must outlive the object.
+         */
+        explicit MessageHeaders(std::pmr::memory_resource* resource);
+
+        /**
+         * This method returns a copy of the headers, such as one for each
+         * target to which a message is forwarded.  The copy shares the
+         * headers with the original, and whichever of them is modified
+         * first (by parsing, or by setting, adding or removing a header)
+         * only then makes its own copy of them, so cloning costs the same
+         * however many headers there are.  The copy allocates from the
+         * same memory resource, and has the same settings, as the original.
+         *
+         * @return
+         *      A copy of the headers is returned.
+         */
+        MessageHeaders Clone() const;
+
         /**
          * This is the equality comparison operator for the class
          *
@@ -230,12 +423,25 @@ namespace MessageHeaders
          * @param[out] bodyOffset
          *       This is where to store the offset into the given
          *       raw message where the headers ended and the body begins.
+         *       If the headers are incomplete, this is where to store
+         *       the number of characters consumed so far.
          *
          * @return
          *       whether or not the Message was parsed successfully
          *       is returned.
+         *
+         * @note
+         *       When State::Incomplete is returned, the parse is suspended
+         *       rather than abandoned.  The next call is expected to pass
+         *       the same raw message with more characters appended to it,
+         *       and picks up where this one left off, examining only the
+         *       characters that weren't yet consumed.  Passing a raw message
+         *       shorter than what was consumed starts the parse over.  The
+         *       raw message doesn't have to be at the same address each time,
+         *       so it can be a view of a buffer which grows as characters
+         *       are received.
          */
-        State ParseRawMessage(const std::string& rawMessageString, size_t& bodyOffset);
+        State ParseRawMessage(std::string_view rawMessageString, size_t& bodyOffset);
 
         /**
          * This method build the Message by determining the headers
@@ -249,7 +455,54 @@ namespace MessageHeaders
          *       whether or not the Message was parsed successfully
          *       is returned.
          */
-        State ParseRawMessage(const std::string& rawMessageString);
+        State ParseRawMessage(std::string_view rawMessageString);
+
+        /**
+         * This method build the Message by determining the headers
+         * parts from the elements parsed from the given string
+         * rendering of an Message, following the rules of the given
+         * profile, such as HttpProfile, SipProfile or EmailProfile,
+         * which are fixed at compile time so that features the protocol
+         * doesn't need are left out of the parser.  Otherwise, it works
+         * just like the method which isn't specialized for a profile.
+         *
+         * @param[in] rawMessageString
+         *       This is the string rendering of the Message to parce.
+         * @param[out] bodyOffset
+         *       This is where to store the offset into the given
+         *       raw message where the headers ended and the body begins.
+         *       If the headers are incomplete, this is where to store
+         *       the number of characters consumed so far.
+         *
+         * @return
+         *       whether or not the Message was parsed successfully
+         *       is returned.
+         *
+         * @note
+         *       Only the profiles declared in ParserProfiles.hpp are
+         *       supported.
+         */
+        template <typename Profile>
+        State ParseRawMessage(std::string_view rawMessageString, size_t& bodyOffset);
+
+        /**
+         * This method build the Message by determining the headers
+         * parts from the elements parsed from the given string
+         * rendering of an Message, following the rules of the given
+         * profile.
+         *
+         * @param[in] rawMessageString
+         *       This is the string rendering of the Message to parce.
+         *
+         * @return
+         *       whether or not the Message was parsed successfully
+         *       is returned.
+         */
+        template <typename Profile> State ParseRawMessage(std::string_view rawMessageString)
+        {
+            size_t bodyOffset;
+            return ParseRawMessage<Profile>(rawMessageString, bodyOffset);
+        }
 
         /**
          * This method returns the collection of Headers elements of the Message.
@@ -262,6 +515,25 @@ namespace MessageHeaders
          */
         Headers GetAll() const;
 
+        /**
+         * This method calls the given visitor with the name and value of
+         * each header in the message, in order, without copying any of
+         * them.  This is the counterpart of GetAll which builds no
+         * collection.  The views given to the visitor are only valid
+         * until the headers are next modified.
+         *
+         * @param[in] visitor
+         *      This is the function to call with the name and value
+         *      of each header, both as a std::string_view.
+         */
+        template <typename Visitor> void ForEachHeader(Visitor&& visitor) const
+        {
+            using VisitorType = std::remove_reference_t<Visitor>;
+            VisitHeaders([](void* context, std::string_view name, std::string_view value)
+                         { (*static_cast<VisitorType*>(context))(name, value); },
+                         const_cast<void*>(static_cast<const void*>(&visitor)));
+        }
+
         /**
          * This method checks if there is a header with the given name
          * in the message.
@@ -323,6 +595,70 @@ namespace MessageHeaders
          */
         std::vector<HeaderValue> GetHeaderTokens(const HeaderName& headerName) const;
 
+        /**
+         * This method calls the given visitor with each value of the
+         * header with the given name in the message, in order, without
+         * copying any of them.  The views given to the visitor are only
+         * valid until the headers are next modified.
+         *
+         * @param[in] headerName
+         *      This is the name of the header whose values should be visited.
+         *
+         * @param[in] visitor
+         *      This is the function to call with each header value,
+         *      as a std::string_view.
+         */
+        template <typename Visitor>
+        void ForEachHeaderValue(const HeaderName& headerName, Visitor&& visitor) const
+        {
+            using VisitorType = std::remove_reference_t<Visitor>;
+            VisitHeaderValues(
+                headerName,
+                [](void* context, std::string_view value)
+                { (*static_cast<VisitorType*>(context))(value); },
+                const_cast<void*>(static_cast<const void*>(&visitor)));
+        }
+
+        /**
+         * This method calls the given visitor with each token of the
+         * values of the header with the given name in the message, in
+         * order, without copying any of them.  This is the counterpart of
+         * GetHeaderTokens which builds no collection, and which can leave
+         * commas inside quoted strings alone.  The views given to the
+         * visitor are only valid until the headers are next modified.
+         *
+         * @param[in] headerName
+         *      This is the name of the header whose tokens should be visited.
+         *
+         * @param[in] visitor
+         *      This is the function to call with each token,
+         *      as a std::string_view.
+         *
+         * @param[in] trimWhitespace
+         *      This indicates whether or not whitespace at the beginning
+         *      or end of each token should be left out of it.
+         *
+         * @param[in] quotedStrings
+         *      This indicates whether or not commas inside quoted strings
+         *      should be treated as part of the token rather than ending it.
+         */
+        template <typename Visitor>
+        void ForEachHeaderToken(const HeaderName& headerName, Visitor&& visitor,
+                                bool trimWhitespace = true, bool quotedStrings = true) const
+        {
+            ForEachHeaderValue(headerName,
+                               [&](std::string_view value)
+                               {
+                                   HeaderTokenizer tokenizer(value, trimWhitespace,
+                                                             quotedStrings);
+                                   std::string_view token;
+                                   while (tokenizer.Next(token))
+                                   {
+                                       visitor(token);
+                                   }
+                               });
+        }
+
         /**
          * This method add or modifie the header with the given name,
          * to have the given one.
@@ -332,8 +668,11 @@ namespace MessageHeaders
          *
          * @param[in] value
          *      This is the value of the header to add or replace.
+         *      It's copied straight into the headers, so it may be any
+         *      kind of string, but it must not be a view of the value of
+         *      one of the headers themselves.
          */
-        void SetHeader(const HeaderName& name, const HeaderValue& value);
+        void SetHeader(const HeaderName& name, std::string_view value);
 
         /**
          * This method add or modifie the header with the given name,
@@ -361,9 +700,12 @@ namespace MessageHeaders
          *
          * @param[in] values
          *      This is the value of the header to add.
+         *      It's copied straight into the headers, so it may be any
+         *      kind of string, but it must not be a view of the value of
+         *      one of the headers themselves.
          *
          */
-        void AddHeader(const HeaderName& name, const HeaderValue& value);
+        void AddHeader(const HeaderName& name, std::string_view value);
 
         /**
          * This method adds  the header with the given name,
@@ -389,6 +731,56 @@ namespace MessageHeaders
          */
         void RemoveHeader(const HeaderName& headerName);
 
+        /**
+         * This method makes room for the given number of headers, so that
+         * headers can then be added, such as when generating a response,
+         * without the collection of headers growing one step at a time.
+         *
+         * @param[in] headerCount
+         *      This is the number of headers for which to make room.
+         */
+        void Reserve(size_t headerCount);
+
+        /**
+         * This method removes all the headers, and forgets any parse
+         * in progress along with whether or not the headers were valid,
+         * so that the object can be reused for another message.  The
+         * memory already allocated for headers is kept, so that once the
+         * object has held a message as big as the next one, parsing it
+         * allocates nothing.  Settings such as the line limit, lazy
+         * values, strictness and limits are kept as well.
+         */
+        void Clear();
+
+        /**
+         * This method abandons the parse in progress, if the last call to
+         * ParseRawMessage returned State::Incomplete, dropping any headers
+         * stored by that parse, so that the next call starts parsing a new
+         * message instead of expecting more of the interrupted one.  The
+         * headers of the messages parsed before are left alone.
+         */
+        void AbandonParse();
+
+        /**
+         * This method removes all the headers with any of the given
+         * names, going over the headers only once however many headers
+         * are removed.
+         *
+         * @param[in] headerNames
+         *      These are the names of the headers to remove.
+         */
+        void RemoveHeaders(const std::vector<HeaderName>& headerNames);
+
+        /**
+         * This method makes the given changes to the headers, leaving
+         * them the same as making each change in turn would, but going
+         * over the headers only once however many headers are changed.
+         *
+         * @param[in] edits
+         *      These are the changes to make, in order.
+         */
+        void EditHeaders(const std::vector<HeaderEdit>& edits);
+
         /**
          * This method constructs and returns the raw string
          * message based on the headers parts that have been
@@ -400,6 +792,66 @@ namespace MessageHeaders
          */
         std::string GenerateRawHeaders() const;
 
+        /**
+         * This method returns the number of characters in the raw
+         * headers that would be generated from the headers collected
+         * by the object.  Unless a line limit is set, this is kept up
+         * to date as headers are changed, and so takes constant time,
+         * other than the first time after parsing with lazy values.
+         *
+         * @return
+         *      The number of characters in the raw headers,
+         *      including the blank line that ends them, is returned.
+         */
+        size_t GetRawSize() const;
+
+        /**
+         * This method generates the raw headers from the headers collected
+         * by the object, directly into the given buffer, provided it's
+         * large enough to hold them.
+         *
+         * @param[out] buffer
+         *      This is where to store the raw headers.
+         *
+         * @param[in] bufferSize
+         *      This is the number of characters the buffer can hold.
+         *
+         * @return
+         *      The number of characters in the raw headers is returned.
+         *      If this is larger than the buffer size, nothing was stored
+         *      in the buffer.
+         */
+        size_t GenerateRawHeaders(char* buffer, size_t bufferSize) const;
+
+        /**
+         * This method generates the raw headers from the headers collected
+         * by the object, appending them to the given string, which grows
+         * only once to make room for them.
+         *
+         * @param[in,out] output
+         *      This is the string to which to append the raw headers.
+         */
+        void AppendRawHeaders(std::string& output) const;
+
+        /**
+         * This method generates the raw headers from the headers collected
+         * by the object as a list of spans, ready to be gathered up by
+         * a scatter/gather write such as writev, without copying them
+         * into a single string.  The spans refer to the names and values
+         * stored in the object, and to static separators and line
+         * terminators.  The line of each header is kept in one piece
+         * unless its value was changed in place or wasn't found as it
+         * would be generated, so the lines of headers parsed and left
+         * alone, one after another, make up a single span.  Folded
+         * lines are made up of separate spans.
+         *
+         * @param[out] spans
+         *      This is where to append the spans of the raw headers.
+         *      They remain valid only until the headers are next changed,
+         *      or the object is destroyed.
+         */
+        void GenerateRawHeaderSpans(std::vector<std::string_view>& spans) const;
+
         /**
          * This method sets a limit for the number of characters
          * in any header line.
@@ -411,6 +863,41 @@ namespace MessageHeaders
          */
         void SetLineLimit(size_t lineLengthLimit);
 
+        /**
+         * This method selects the rules that the names of headers
+         * must follow when parsing a raw message.  Headers whose names
+         * break these rules, or whose values contain control characters,
+         * are still stored, but make the object invalid.
+         *
+         * @param[in] strictness
+         *      This selects the rules that header names must follow.
+         */
+        void SetStrictness(Strictness strictness);
+
+        /**
+         * This method sets limits on the resources a single header block
+         * may use when parsing a raw message.  Parsing a header block which
+         * breaks one of them stops with State::Error as soon as that's known.
+         *
+         * @param[in] limits
+         *      These are the limits to enforce.
+         */
+        void SetLimits(const Limits& limits);
+
+        /**
+         * This method selects whether or not header values are left as
+         * they are in the raw message when parsing, and only unfolded and
+         * stripped of margin whitespace the first time they're needed.
+         * The header block is then copied as a whole, instead of each
+         * value being copied on its own, which saves the work of handling
+         * the values of headers that are never looked at.
+         *
+         * @param[in] lazyValues
+         *      This indicates whether or not header values parsed
+         *      from now on should be handled lazily.
+         */
+        void SetLazyValues(bool lazyValues);
+
         /**
          * This method return an indication of whether or not the headers
          * constructed have all been valid.
@@ -430,6 +917,74 @@ namespace MessageHeaders
          * This contains the private properties of the instance.
          */
         std::unique_ptr<struct Impl> impl_;
+
+        // Private methods
+    private:
+        /**
+         * This constructs the object around the given private properties.
+         *
+         * @param[in] impl
+         *      These are the private properties of the object.
+         */
+        explicit MessageHeaders(std::unique_ptr<Impl>&& impl);
+
+        /**
+         * This is the type of function called with each header value
+         * by the VisitHeaderValues method.
+         *
+         * @param[in] context
+         *      This is the context given to VisitHeaderValues.
+         *
+         * @param[in] value
+         *      This is the header value being visited.
+         */
+        typedef void (*ValueVisitor)(void* context, std::string_view value);
+
+        /**
+         * This method calls the given function with each value of the
+         * header with the given name in the message.  It lets the visitor
+         * templates do their work without exposing the implementation.
+         *
+         * @param[in] headerName
+         *      This is the name of the header whose values should be visited.
+         *
+         * @param[in] visitor
+         *      This is the function to call with each header value.
+         *
+         * @param[in] context
+         *      This is passed through to the visitor function.
+         */
+        void VisitHeaderValues(const HeaderName& headerName, ValueVisitor visitor,
+                               void* context) const;
+
+        /**
+         * This is the type of function called with each header
+         * by the VisitHeaders method.
+         *
+         * @param[in] context
+         *      This is the context given to VisitHeaders.
+         *
+         * @param[in] name
+         *      This is the name of the header being visited.
+         *
+         * @param[in] value
+         *      This is the value of the header being visited.
+         */
+        typedef void (*HeaderVisitor)(void* context, std::string_view name,
+                                      std::string_view value);
+
+        /**
+         * This method calls the given function with the name and value
+         * of each header in the message.  It lets the visitor templates
+         * do their work without exposing the implementation.
+         *
+         * @param[in] visitor
+         *      This is the function to call with each header.
+         *
+         * @param[in] context
+         *      This is passed through to the visitor function.
+         */
+        void VisitHeaders(HeaderVisitor visitor, void* context) const;
     };
 
     /**
@@ -0,0 +1,102 @@
+#ifndef MESSAGE_HEADERS_MESSAGE_HEADERS_POOL_HPP
+#define MESSAGE_HEADERS_MESSAGE_HEADERS_POOL_HPP
+/**
+ * @file MessageHeadersPool.hpp
+ *
+ * This module contains the declaration of the MessageHeaders::MessageHeadersPool class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stddef.h>
+#include <MessageHeaders/MessageHeaders.hpp>
+#include <memory>
+#include <memory_resource>
+
+namespace MessageHeaders
+{
+    /**
+     * This class keeps MessageHeaders objects which are done with, so that
+     * they can be handed out again rather than constructing new ones.
+     * Since each object keeps the memory it allocated for headers, once
+     * the objects have been warmed up by messages as big as the ones that
+     * follow, parsing with them allocates nothing.
+     *
+     * The pool isn't safe to use from multiple threads at once; each
+     * thread parsing messages is expected to keep a pool of its own.
+     */
+    class MessageHeadersPool
+    {
+        // Lifecycle management
+    public:
+        ~MessageHeadersPool() noexcept;
+        MessageHeadersPool(const MessageHeadersPool&) = delete;
+        MessageHeadersPool(MessageHeadersPool&&) = delete;
+        MessageHeadersPool& operator=(const MessageHeadersPool&) = delete;
+        MessageHeadersPool& operator=(MessageHeadersPool&&) = delete;
+
+        // Public methods
+    public:
+        /**
+         * This constructs the pool, empty.
+         *
+         * @param[in] maxIdle
+         *      This is the largest number of objects the pool keeps
+         *      while they're not in use.  Objects given back beyond
+         *      this are destroyed.
+         *
+         * @param[in] resource
+         *      This is the memory resource from which the objects
+         *      constructed by the pool allocate their headers.
+         */
+        explicit MessageHeadersPool(
+            size_t maxIdle = 64,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        /**
+         * This method hands out an object, either one given back earlier,
+         * with no headers but with the settings it had, or a new one
+         * if there isn't any.
+         *
+         * @return
+         *      The object handed out is returned.
+         */
+        MessageHeaders Acquire();
+
+        /**
+         * This method gives back an object handed out earlier, clearing
+         * it so that it can be handed out again, or destroying it if the
+         * pool already keeps as many objects as it may.
+         *
+         * @param[in] headers
+         *      This is the object to give back.  It must not have been
+         *      moved from.
+         */
+        void Release(MessageHeaders headers);
+
+        /**
+         * This method returns the number of objects kept by the pool
+         * which aren't in use.
+         *
+         * @return
+         *      The number of objects kept which aren't in use is returned.
+         */
+        size_t GetIdleCount() const;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr<struct Impl> impl_;
+    };
+}  // namespace MessageHeaders
+
+#endif /* MESSAGE_HEADERS_MESSAGE_HEADERS_POOL_HPP */
@@ -0,0 +1,302 @@
+#ifndef MESSAGE_HEADERS_MESSAGE_HEADERS_VIEW_HPP
+#define MESSAGE_HEADERS_MESSAGE_HEADERS_VIEW_HPP
+/**
+ * @file MessageHeadersView.hpp
+ *
+ * This module contains the declaration of the MessageHeaders::MessageHeadersView class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <MessageHeaders/HeaderScanner.hpp>
+#include <MessageHeaders/MessageHeaders.hpp>
+#include <deque>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace MessageHeaders
+{
+    /**
+     * This class represents the headers of a message, like the
+     * MessageHeaders::MessageHeaders class, except that the header names
+     * and values aren't copied out of the raw message.  Instead they
+     * are views which point into the caller's buffer, which must
+     * therefore outlive the object, or at least its last use.
+     *
+     * Only the values of folded headers are copied, since they
+     * have to be unfolded into a single line.
+     */
+    class MessageHeadersView
+    {
+        // Types
+    public:
+        /**
+         * This is the type used to report the outcome of parsing.
+         */
+        typedef MessageHeaders::State State;
+
+        /**
+         * This selects the rules that the names of headers must follow.
+         */
+        typedef MessageHeaders::Strictness Strictness;
+
+        /**
+         * These are limits on the resources a single header block may use.
+         */
+        typedef MessageHeaders::Limits Limits;
+
+        /**
+         * This represents a single header of the message.
+         */
+        struct HeaderView
+        {
+            /**
+             * This is the part of the header that come before the colon.
+             */
+            std::string_view name;
+
+            /**
+             * This is the part of the header that comes after the colon,
+             * without any margin whitespace, and unfolded if necessary.
+             */
+            std::string_view value;
+        };
+
+        // Lifecycle management
+    public:
+        ~MessageHeadersView() noexcept = default;
+        MessageHeadersView(const MessageHeadersView&) = delete;
+        MessageHeadersView(MessageHeadersView&&) noexcept = default;
+        MessageHeadersView& operator=(const MessageHeadersView&) = delete;
+        MessageHeadersView& operator=(MessageHeadersView&&) noexcept = default;
+
+        // Public Methods
+    public:
+        /**
+         * This is the default constructor.
+         */
+        MessageHeadersView() = default;
+
+        /**
+         * This constructs the object so that the header records and unfolded
+         * values are allocated from the given memory resource, such as a
+         * per-connection arena which is released in one shot once the
+         * message has been handled.
+         *
+         * @param[in] resource
+         *      This is the memory resource from which to allocate.
+         *      It must outlive the object.
+         */
+        explicit MessageHeadersView(std::pmr::memory_resource* resource);
+
+        /**
+         * This method finds the headers of the given raw message,
+         * referring to them where they are in the raw message.
+         *
+         * @param[in] rawMessage
+         *       This is the string rendering of the message to parse.
+         *
+         * @param[out] bodyOffset
+         *       This is where to store the offset into the given
+         *       raw message where the headers ended and the body begins.
+         *       If the headers are incomplete, this is where to store
+         *       the number of characters consumed so far.
+         *
+         * @return
+         *       whether or not the message was parsed successfully
+         *       is returned.
+         *
+         * @note
+         *       As with MessageHeaders::ParseRawMessage, when State::Incomplete
+         *       is returned the parse is suspended, and the next call is expected
+         *       to pass the same raw message with more characters appended to it.
+         *       The longer raw message may be at a different address; the
+         *       headers found so far then refer to it instead.
+         *
+         * @note
+         *       Unlike MessageHeaders::ParseRawMessage, which adds the headers
+         *       of each message parsed to those it already holds, starting
+         *       to parse a message forgets the headers of any message parsed
+         *       before, as Clear does, since they refer to a raw message the
+         *       object no longer refers to.
+         */
+        State ParseRawMessage(std::string_view rawMessage, size_t& bodyOffset);
+
+        /**
+         * This method finds the headers of the given raw message,
+         * referring to them where they are in the raw message.
+         *
+         * @param[in] rawMessage
+         *       This is the string rendering of the message to parse.
+         *
+         * @return
+         *       whether or not the message was parsed successfully
+         *       is returned.
+         */
+        State ParseRawMessage(std::string_view rawMessage);
+
+        /**
+         * This method returns the number of headers in the message.
+         *
+         * @return
+         *      The number of headers in the message is returned.
+         */
+        size_t GetHeaderCount() const;
+
+        /**
+         * This method returns the header at the given position
+         * in the message.
+         *
+         * @param[in] index
+         *      This is the position of the header to return,
+         *      which must be less than GetHeaderCount().
+         *
+         * @return
+         *      The header at the given position is returned.
+         */
+        HeaderView GetHeader(size_t index) const;
+
+        /**
+         * This method checks if there is a header with the given name
+         * (case-insensitive) in the message.
+         *
+         * @param[in] headerName
+         *      This is the header name to check if it's present in the message.
+         *
+         * @return
+         *      return an indication of whether or not the message has
+         *      a header with the given name.
+         */
+        bool HasHeader(std::string_view headerName) const;
+
+        /**
+         * This method returns the value of the first header with the
+         * given name (case-insensitive) in the message.
+         *
+         * @param[in] headerName
+         *      This is the name of the header whose value should be returned.
+         *
+         * @return
+         *      returns the value of the given header name.
+         *
+         * @note
+         *      If there is no header with the given name in the message
+         *      then just an empty view is returned.
+         */
+        std::string_view GetHeaderValue(std::string_view headerName) const;
+
+        /**
+         * This method sets a limit for the number of characters
+         * in any header line.
+         *
+         * @param[in] lineLengthLimit
+         *      This is the maximum number of characters, including
+         *      the 2-characters CRLF line terminator, that should
+         *      be allowed for a single header line.
+         */
+        void SetLineLimit(size_t lineLengthLimit);
+
+        /**
+         * This method selects the rules that the names of headers
+         * must follow.  Headers whose names break these rules, or whose
+         * values contain control characters, are still found, but make
+         * the object invalid.
+         *
+         * @param[in] strictness
+         *      This selects the rules that header names must follow.
+         */
+        void SetStrictness(Strictness strictness);
+
+        /**
+         * This method sets limits on the resources a single header block
+         * may use.  Parsing a header block which breaks one of them stops
+         * with State::Error as soon as that's known.
+         *
+         * @param[in] limits
+         *      These are the limits to enforce.
+         */
+        void SetLimits(const Limits& limits);
+
+        /**
+         * This method return an indication of whether or not the headers
+         * found have all been valid.
+         */
+        bool IsValid() const;
+
+        /**
+         * This method forgets all headers found so far, so that
+         * the object can be used to parse another message.
+         */
+        void Clear();
+
+        // Private properties
+    private:
+        /**
+         * This describes where a single header is found.
+         */
+        struct Record
+        {
+            /**
+             * This is the offset into the raw message of the header name.
+             */
+            size_t nameOffset;
+
+            /**
+             * This is the number of characters in the header name.
+             */
+            size_t nameLength;
+
+            /**
+             * This is the offset into the raw message of the header value,
+             * or if the header was unfolded, the position of its value in
+             * the unfolded values.
+             */
+            size_t valueOffset;
+
+            /**
+             * This is the number of characters in the header value.
+             */
+            size_t valueLength;
+
+            /**
+             * This indicates whether or not the header value is
+             * found in the unfolded values rather than the raw message.
+             */
+            bool unfolded;
+        };
+
+        /**
+         * This is the raw message most recently parsed, which the
+         * offsets in the header records refer to.
+         */
+        std::string_view rawMessage_;
+
+        /**
+         * This describes where each header is found, in the order
+         * in which they appear in the raw message.
+         */
+        std::pmr::vector<Record> records_;
+
+        /**
+         * These are the values of the folded headers, after unfolding.
+         * A deque is used so that they stay where they are as more
+         * of them are added.
+         */
+        std::pmr::deque<std::pmr::string> unfoldedValues_;
+
+        /**
+         * This is used to find the headers in the raw message.
+         */
+        HeaderScanner scanner_;
+
+        /**
+         * This indicates whether or not all validity checks
+         * have passed for the headers.
+         */
+        bool valid_ = true;
+    };
+}  // namespace MessageHeaders
+
+#endif /* MESSAGE_HEADERS_MESSAGE_HEADERS_VIEW_HPP */
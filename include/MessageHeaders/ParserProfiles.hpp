@@ -0,0 +1,103 @@
+#ifndef MESSAGE_HEADERS_PARSER_PROFILES_HPP
+#define MESSAGE_HEADERS_PARSER_PROFILES_HPP
+/**
+ * @file ParserProfiles.hpp
+ *
+ * This module contains the declarations of the profiles which specialize
+ * header parsing for a single protocol at compile time.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stddef.h>
+#include <MessageHeaders/HeaderScanner.hpp>
+
+namespace MessageHeaders
+{
+    /**
+     * This profile parses headers however the parser was configured
+     * at run time, which is what the parse methods which aren't
+     * specialized for a profile do.
+     */
+    struct ConfiguredProfile
+    {
+        /**
+         * This indicates whether or not the rules header names must
+         * follow are fixed by the profile, rather than configured.
+         */
+        static constexpr bool fixedStrictness = false;
+
+        /**
+         * These are the rules header names must follow, if they're
+         * fixed by the profile.
+         */
+        static constexpr HeaderScanner::Strictness strictness = HeaderScanner::Strictness::Email;
+
+        /**
+         * This indicates whether or not header values may be folded onto
+         * continuation lines.  If not, a line beginning with whitespace
+         * is rejected.
+         */
+        static constexpr bool folding = true;
+
+        /**
+         * This indicates whether or not the single-letter compact forms
+         * of header names are replaced by the full header names.
+         */
+        static constexpr bool compactNames = false;
+
+        /**
+         * This is the maximum number of characters, including the line
+         * terminator, allowed for a single header line, unless a limit
+         * is configured, or zero for no limit.
+         */
+        static constexpr size_t lineLengthLimit = 0;
+    };
+
+    /**
+     * This profile parses HTTP headers (RFC 7230).  Header names must be
+     * tokens, and obsolete line folding is rejected outright, as allowed
+     * by section 3.2.4, so each header is handed over as soon as its line
+     * is complete.
+     */
+    struct HttpProfile
+    {
+        static constexpr bool fixedStrictness = true;
+        static constexpr HeaderScanner::Strictness strictness = HeaderScanner::Strictness::Http;
+        static constexpr bool folding = false;
+        static constexpr bool compactNames = false;
+        static constexpr size_t lineLengthLimit = 0;
+    };
+
+    /**
+     * This profile parses SIP headers (RFC 3261).  Header names must be
+     * SIP tokens, folding is allowed, and the compact forms of header
+     * names (section 7.3.3), such as "v" for "Via", are replaced by the
+     * full header names.
+     */
+    struct SipProfile
+    {
+        static constexpr bool fixedStrictness = true;
+        static constexpr HeaderScanner::Strictness strictness = HeaderScanner::Strictness::Sip;
+        static constexpr bool folding = true;
+        static constexpr bool compactNames = true;
+        static constexpr size_t lineLengthLimit = 0;
+    };
+
+    /**
+     * This profile parses e-mail headers (RFC 5322).  Header names may
+     * contain any visible character but the colon, folding is allowed,
+     * and, unless another limit is configured, lines are limited to
+     * 998 characters, not counting the line terminator (section 2.1.1).
+     */
+    struct EmailProfile
+    {
+        static constexpr bool fixedStrictness = true;
+        static constexpr HeaderScanner::Strictness strictness = HeaderScanner::Strictness::Email;
+        static constexpr bool folding = true;
+        static constexpr bool compactNames = false;
+        static constexpr size_t lineLengthLimit = 1000;
+    };
+}  // namespace MessageHeaders
+
+#endif /* MESSAGE_HEADERS_PARSER_PROFILES_HPP */
@@ -0,0 +1,201 @@
+#ifndef MESSAGE_HEADERS_WELL_KNOWN_HEADERS_HPP
+#define MESSAGE_HEADERS_WELL_KNOWN_HEADERS_HPP
+/**
+ * @file WellKnownHeaders.hpp
+ *
+ * This module contains the declaration of the MessageHeaders::WellKnownHeader
+ * identifiers and the functions used to recognize them.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stdint.h>
+#include <string_view>
+
+namespace MessageHeaders
+{
+    /**
+     * These identify the header names most commonly found in e-mail,
+     * HTTP and SIP messages.  A header name which is one of them
+     * (case-insensitive) carries its identifier, so that it can be
+     * compared with other header names as a single integer.
+     */
+    enum class WellKnownHeader : uint8_t
+    {
+        /**
+         * The header name isn't one of the well-known ones.
+         */
+        Unknown = 0,
+
+        Accept,
+        AcceptCharset,
+        AcceptEncoding,
+        AcceptLanguage,
+        AcceptRanges,
+        Age,
+        AlertInfo,
+        Allow,
+        AllowEvents,
+        AuthenticationInfo,
+        Authorization,
+        Bcc,
+        CacheControl,
+        CallId,
+        CallInfo,
+        Cc,
+        Comments,
+        Connection,
+        Contact,
+        ContentDisposition,
+        ContentEncoding,
+        ContentLanguage,
+        ContentLength,
+        ContentLocation,
+        ContentRange,
+        ContentTransferEncoding,
+        ContentType,
+        Cookie,
+        CSeq,
+        Date,
+        DeliveredTo,
+        DkimSignature,
+        ErrorInfo,
+        ETag,
+        Event,
+        Expect,
+        Expires,
+        Forwarded,
+        From,
+        Host,
+        IfMatch,
+        IfModifiedSince,
+        IfNoneMatch,
+        IfRange,
+        IfUnmodifiedSince,
+        InReplyTo,
+        KeepAlive,
+        Keywords,
+        LastModified,
+        Location,
+        MaxForwards,
+        MessageId,
+        MimeVersion,
+        MinExpires,
+        Organization,
+        Origin,
+        Pragma,
+        Priority,
+        ProxyAuthenticate,
+        ProxyAuthorization,
+        ProxyRequire,
+        Range,
+        Received,
+        RecordRoute,
+        Referer,
+        References,
+        ReplyTo,
+        Require,
+        ResentDate,
+        ResentFrom,
+        ResentMessageId,
+        ResentTo,
+        RetryAfter,
+        ReturnPath,
+        Route,
+        Sender,
+        Server,
+        SetCookie,
+        Subject,
+        SubscriptionState,
+        Supported,
+        Te,
+        Timestamp,
+        To,
+        Trailer,
+        TransferEncoding,
+        Unsupported,
+        Upgrade,
+        UserAgent,
+        Vary,
+        Via,
+        Warning,
+        WwwAuthenticate,
+        XForwardedFor,
+        XForwardedProto,
+    };
+
+    /**
+     * This function computes the hash of the given header name,
+     * without regard to case, so that equivalent header names
+     * always have the same hash.  It's the 32-bit FNV-1a hash
+     * (http://www.isthe.com/chongo/tech/comp/fnv/) of the name
+     * with its letters folded to lower case.
+     *
+     * @param[in] name
+     *      This is the header name to hash.
+     *
+     * @return
+     *      returns the case-insensitive hash of the given header name.
+     */
+    constexpr uint32_t HashHeaderName(std::string_view name)
+    {
+        uint32_t hash = 2166136261u;
+        for (auto c : name)
+        {
+            if ((c >= 'A') && (c <= 'Z'))
+            {
+                c += 'a' - 'A';
+            }
+            hash ^= (uint32_t)(unsigned char)c;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    /**
+     * This function recognizes the given header name if it's
+     * one of the well-known ones.
+     *
+     * @param[in] name
+     *      This is the header name to recognize.
+     *
+     * @param[in] hash
+     *      This is the hash of the header name, as computed
+     *      by HashHeaderName.
+     *
+     * @return
+     *      The identifier of the header name is returned, or
+     *      WellKnownHeader::Unknown if it's not a well-known one.
+     */
+    WellKnownHeader FindWellKnownHeader(std::string_view name, uint32_t hash);
+
+    /**
+     * This function recognizes the given header name if it's the
+     * compact form of a well-known SIP header name, such as "v"
+     * for "Via" (case-insensitive).
+     *
+     * @param[in] name
+     *      This is the header name to recognize.
+     *
+     * @return
+     *      The identifier of the header name for which the given one is
+     *      the compact form is returned, or WellKnownHeader::Unknown if
+     *      it's not a compact form.
+     */
+    WellKnownHeader FindCompactHeader(std::string_view name);
+
+    /**
+     * This function returns the usual spelling of the
+     * well-known header name with the given identifier.
+     *
+     * @param[in] id
+     *      This is the identifier of the well-known header name.
+     *
+     * @return
+     *      The usual spelling of the header name is returned,
+     *      or an empty string for WellKnownHeader::Unknown.
+     */
+    std::string_view GetWellKnownHeaderName(WellKnownHeader id);
+}  // namespace MessageHeaders
+
+#endif /* MESSAGE_HEADERS_WELL_KNOWN_HEADERS_HPP */
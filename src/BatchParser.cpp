@@ -0,0 +1,327 @@
+/**
+ * @file BatchParser.cpp
+ *
+ * This module contains the implementation of the MessageHeaders::BatchParser class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stdint.h>
+#include <MessageHeaders/BatchParser.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace MessageHeaders
+{
+    /**
+     * This contains the private properties of a BatchParser instance.
+     */
+    struct BatchParser::Impl
+    {
+        /**
+         * This holds the range of positions of the raw messages
+         * that a single worker has yet to parse.
+         */
+        struct WorkQueue
+        {
+            /**
+             * This is used to synchronize access to the range.
+             */
+            std::mutex mutex;
+
+            /**
+             * This is the position of the next raw message to parse.
+             */
+            size_t next = 0;
+
+            /**
+             * This is the position just past the last raw message to parse.
+             */
+            size_t end = 0;
+        };
+
+        /**
+         * This is used to synchronize access to the properties which
+         * describe the batch being parsed.
+         */
+        std::mutex mutex;
+
+        /**
+         * This is used to wake up the worker threads when a new batch
+         * is ready, or when they should stop.
+         */
+        std::condition_variable wakeCondition;
+
+        /**
+         * This is used to wake up the thread which called Parse when
+         * all the worker threads are done with the batch.
+         */
+        std::condition_variable doneCondition;
+
+        /**
+         * This is used to make sure batches are parsed one at a time.
+         */
+        std::mutex parseMutex;
+
+        /**
+         * These are the threads which help the thread calling Parse.
+         */
+        std::vector<std::thread> workers;
+
+        /**
+         * These are the ranges of the raw messages left for each worker
+         * to parse.  The first one belongs to the thread calling Parse.
+         */
+        std::vector<std::unique_ptr<WorkQueue>> queues;
+
+        /**
+         * This is incremented every time a new batch is ready.
+         */
+        uint64_t generation = 0;
+
+        /**
+         * This is the number of worker threads which have yet to finish
+         * with the current batch.
+         */
+        size_t busyWorkers = 0;
+
+        /**
+         * This indicates whether or not the worker threads should stop.
+         */
+        bool stop = false;
+
+        /**
+         * This points to the raw messages of the current batch, if they're
+         * strings.
+         */
+        const std::string* rawMessages = nullptr;
+
+        /**
+         * This points to the raw messages of the current batch, if they're
+         * views of strings.
+         */
+        const std::string_view* rawMessageViews = nullptr;
+
+        /**
+         * This points to where to store the outcome of parsing
+         * each raw message of the current batch.
+         */
+        Result* results = nullptr;
+
+        /**
+         * This constructs the private properties, including starting
+         * the worker threads.
+         *
+         * @param[in] threadCount
+         *      This is the number of threads, including the one calling
+         *      Parse, which should work on each batch.
+         */
+        explicit Impl(size_t threadCount)
+        {
+            for (size_t i = 0; i < threadCount; ++i)
+            {
+                queues.emplace_back(new WorkQueue());
+            }
+            for (size_t i = 1; i < threadCount; ++i)
+            {
+                workers.emplace_back(&Impl::Worker, this, i);
+            }
+        }
+
+        /**
+         * This function takes the position of the next raw message for
+         * the given worker to parse, from its own queue if possible, or
+         * by taking over half of what's left in the queue of another
+         * worker otherwise.
+         *
+         * @param[in] self
+         *      This is the index of the worker looking for work.
+         *
+         * @param[out] position
+         *      This is where to store the position of the raw message
+         *      to parse.
+         *
+         * @return
+         *      An indication of whether or not any raw messages are left
+         *      to parse is returned.
+         */
+        bool Take(size_t self, size_t& position)
+        {
+            auto& ownQueue = *queues[self];
+            {
+                std::lock_guard<decltype(ownQueue.mutex)> lock(ownQueue.mutex);
+                if (ownQueue.next < ownQueue.end)
+                {
+                    position = ownQueue.next++;
+                    return true;
+                }
+            }
+            for (size_t i = 1; i < queues.size(); ++i)
+            {
+                auto& victim = *queues[(self + i) % queues.size()];
+                size_t stolenBegin, stolenEnd;
+                {
+                    std::lock_guard<decltype(victim.mutex)> lock(victim.mutex);
+                    const auto remaining = victim.end - victim.next;
+                    if (remaining == 0)
+                    {
+                        continue;
+                    }
+                    stolenEnd = victim.end;
+                    stolenBegin = victim.end - (remaining + 1) / 2;
+                    victim.end = stolenBegin;
+                }
+                std::lock_guard<decltype(ownQueue.mutex)> lock(ownQueue.mutex);
+                position = stolenBegin;
+                ownQueue.next = stolenBegin + 1;
+                ownQueue.end = stolenEnd;
+                return true;
+            }
+            return false;
+        }
+
+        /**
+         * This function returns the raw message of the current batch
+         * at the given position.
+         *
+         * @param[in] position
+         *      This is the position of the raw message to return.
+         *
+         * @return
+         *      The raw message at the given position is returned.
+         */
+        std::string_view GetRawMessage(size_t position) const
+        {
+            return (rawMessageViews == nullptr) ? std::string_view(rawMessages[position])
+                                                : rawMessageViews[position];
+        }
+
+        /**
+         * This function parses the current batch, once the raw messages
+         * have been given, with the help of the worker threads.
+         *
+         * @param[in] count
+         *      This is the number of raw messages to parse.
+         *
+         * @return
+         *      The outcome of parsing each raw message is returned,
+         *      in the same order as the raw messages.
+         */
+        std::vector<Result> ParseBatch(size_t count)
+        {
+            std::vector<Result> batchResults(count);
+            const auto workerCount = queues.size();
+            for (size_t i = 0; i < workerCount; ++i)
+            {
+                auto& queue = *queues[i];
+                std::lock_guard<decltype(queue.mutex)> lock(queue.mutex);
+                queue.next = count * i / workerCount;
+                queue.end = count * (i + 1) / workerCount;
+            }
+            results = batchResults.data();
+            {
+                std::lock_guard<decltype(mutex)> lock(mutex);
+                ++generation;
+                busyWorkers = workers.size();
+            }
+            wakeCondition.notify_all();
+            Work(0);
+            std::unique_lock<decltype(mutex)> lock(mutex);
+            doneCondition.wait(lock, [this] { return busyWorkers == 0; });
+            return batchResults;
+        }
+
+        /**
+         * This function parses raw messages of the current batch
+         * until none are left.
+         *
+         * @param[in] self
+         *      This is the index of the worker doing the parsing.
+         */
+        void Work(size_t self)
+        {
+            size_t position;
+            while (Take(self, position))
+            {
+                auto& result = results[position];
+                result.state = result.headers.ParseRawMessage(GetRawMessage(position),
+                                                              result.bodyOffset);
+            }
+        }
+
+        /**
+         * This is the body of each worker thread.
+         *
+         * @param[in] self
+         *      This is the index of the worker.
+         */
+        void Worker(size_t self)
+        {
+            uint64_t lastGeneration = 0;
+            std::unique_lock<decltype(mutex)> lock(mutex);
+            for (;;)
+            {
+                wakeCondition.wait(lock, [this, lastGeneration] {
+                    return stop || (generation != lastGeneration);
+                });
+                if (stop)
+                {
+                    return;
+                }
+                lastGeneration = generation;
+                lock.unlock();
+                Work(self);
+                lock.lock();
+                if (--busyWorkers == 0)
+                {
+                    doneCondition.notify_all();
+                }
+            }
+        }
+    };
+
+    BatchParser::~BatchParser() noexcept
+    {
+        {
+            std::lock_guard<decltype(impl_->mutex)> lock(impl_->mutex);
+            impl_->stop = true;
+        }
+        impl_->wakeCondition.notify_all();
+        for (auto& worker : impl_->workers)
+        {
+            worker.join();
+        }
+    }
+
+    BatchParser::BatchParser(size_t threadCount) :
+        impl_(new Impl(
+            (threadCount == 0) ? std::max(std::thread::hardware_concurrency(), 1u) : threadCount))
+    {
+    }
+
+    size_t BatchParser::GetThreadCount() const { return impl_->queues.size(); }
+
+    auto BatchParser::Parse(const std::string* rawMessages, size_t count) -> std::vector<Result>
+    {
+        std::lock_guard<decltype(impl_->parseMutex)> parseLock(impl_->parseMutex);
+        impl_->rawMessages = rawMessages;
+        impl_->rawMessageViews = nullptr;
+        return impl_->ParseBatch(count);
+    }
+
+    auto BatchParser::Parse(const std::string_view* rawMessages, size_t count)
+        -> std::vector<Result>
+    {
+        std::lock_guard<decltype(impl_->parseMutex)> parseLock(impl_->parseMutex);
+        impl_->rawMessages = nullptr;
+        impl_->rawMessageViews = rawMessages;
+        return impl_->ParseBatch(count);
+    }
+
+    auto BatchParser::Parse(const std::vector<std::string>& rawMessages) -> std::vector<Result>
+    {
+        return Parse(rawMessages.data(), rawMessages.size());
+    }
+}  // namespace MessageHeaders
@@ -0,0 +1,59 @@
+#ifndef MESSAGE_HEADERS_COUNTERS_HPP
+#define MESSAGE_HEADERS_COUNTERS_HPP
+/**
+ * @file Counters.hpp
+ *
+ * This module declares the counters behind the
+ * MessageHeaders::Instrumentation class, and the macro used
+ * to update them, which does nothing unless the library is built
+ * with the MESSAGE_HEADERS_INSTRUMENTATION option.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#ifdef MESSAGE_HEADERS_INSTRUMENTATION
+
+#include <stdint.h>
+#include <atomic>
+
+namespace MessageHeaders
+{
+    namespace Counters
+    {
+        /**
+         * This is a single counter, kept on a cache line of its own so
+         * that threads updating different counters don't slow each other
+         * down.
+         */
+        struct alignas(64) Counter
+        {
+            std::atomic<uint64_t> value{0};
+        };
+
+        extern Counter messagesParsed;
+        extern Counter headersParsed;
+        extern Counter foldedHeadersParsed;
+        extern Counter incompleteParses;
+        extern Counter bytesRescanned;
+        extern Counter parseErrors;
+        extern Counter lineLimitErrors;
+        extern Counter limitErrors;
+        extern Counter lookupHits;
+        extern Counter lookupMisses;
+        extern Counter rawHeadersGenerated;
+        extern Counter rawBytesGenerated;
+        extern Counter headerLinesFolded;
+    }  // namespace Counters
+}  // namespace MessageHeaders
+
+#define MESSAGE_HEADERS_COUNT(counter, amount)                          \
+    ::MessageHeaders::Counters::counter.value.fetch_add((uint64_t)(amount), \
+                                                        std::memory_order_relaxed)
+
+#else
+
+#define MESSAGE_HEADERS_COUNT(counter, amount) ((void)0)
+
+#endif /* MESSAGE_HEADERS_INSTRUMENTATION */
+
+#endif /* MESSAGE_HEADERS_COUNTERS_HPP */
@@ -0,0 +1,177 @@
+/**
+ * @file ExtractionPlan.cpp
+ *
+ * This module contains the implementation of the MessageHeaders::ExtractionPlan class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <MessageHeaders/ExtractionPlan.hpp>
+
+namespace MessageHeaders
+{
+    ExtractionPlan::ExtractionPlan(const std::vector<MessageHeaders::HeaderName>& headerNames) :
+        nextWithSameName_(headerNames.size(), headerNames.size())
+    {
+        names_.reserve(headerNames.size());
+        hashes_.reserve(headerNames.size());
+        size_t capacity = 8;
+        while (capacity < headerNames.size() * 2)
+        {
+            capacity <<= 1;
+        }
+        table_.assign(capacity, 0);
+        const auto mask = capacity - 1;
+        for (size_t i = 0; i < headerNames.size(); ++i)
+        {
+            names_.push_back(headerNames[i]);
+            hashes_.push_back(headerNames[i].GetHash());
+            for (auto entryIndex = hashes_[i] & mask;; entryIndex = (entryIndex + 1) & mask)
+            {
+                auto& entry = table_[entryIndex];
+                if (entry == 0)
+                {
+                    entry = (uint32_t)(i + 1);
+                    break;
+                }
+                auto slot = (size_t)(entry - 1);
+                if ((hashes_[slot] == hashes_[i])
+                    && MessageHeaders::HeaderName::Equivalent(names_[slot], names_[i]))
+                {
+                    while (nextWithSameName_[slot] != headerNames.size())
+                    {
+                        slot = nextWithSameName_[slot];
+                    }
+                    nextWithSameName_[slot] = i;
+                    break;
+                }
+            }
+        }
+    }
+
+    size_t ExtractionPlan::GetSlotCount() const { return names_.size(); }
+
+    auto ExtractionPlan::Extract(std::string_view rawMessage, Extraction& extraction) const
+        -> State
+    {
+        Prepare(extraction);
+        auto scanner = scanner_;
+        HeaderScanner::ScannedHeader header;
+        for (;;)
+        {
+            switch (scanner.Next(rawMessage, header))
+            {
+            case HeaderScanner::Result::Header:
+            {
+                if (!header.validName || !header.validValue)
+                {
+                    extraction.valid = false;
+                }
+                auto slot = FindSlot(HeaderScanner::GetName(rawMessage, header));
+                if ((slot == names_.size()) || extraction.slots[slot].found)
+                {
+                    break;
+                }
+                std::string_view value;
+                if (header.folded)
+                {
+                    auto& unfoldedValue = extraction.slots[slot].unfoldedValue;
+                    HeaderScanner::UnfoldValue(rawMessage, header, unfoldedValue);
+                    value = unfoldedValue;
+                }
+                else
+                {
+                    value = HeaderScanner::GetValue(rawMessage, header);
+                }
+                for (; slot != names_.size(); slot = nextWithSameName_[slot])
+                {
+                    extraction.slots[slot].found = true;
+                    extraction.slots[slot].value = value;
+                }
+            }
+            break;
+            case HeaderScanner::Result::End:
+            {
+                extraction.bodyOffset = scanner.GetOffset();
+                return State::Complete;
+            }
+            case HeaderScanner::Result::Incomplete:
+            {
+                extraction.bodyOffset = scanner.GetOffset();
+                return State::Incomplete;
+            }
+            case HeaderScanner::Result::Error:
+            default:
+            {
+                extraction.bodyOffset = scanner.GetOffset();
+                extraction.valid = false;
+                return State::Error;
+            }
+            }
+        }
+    }
+
+    void ExtractionPlan::Extract(const MessageHeaders& headers, Extraction& extraction) const
+    {
+        Prepare(extraction);
+        headers.ForEachHeader(
+            [&](std::string_view name, std::string_view value)
+            {
+                auto slot = FindSlot(name);
+                if ((slot == names_.size()) || extraction.slots[slot].found)
+                {
+                    return;
+                }
+                for (; slot != names_.size(); slot = nextWithSameName_[slot])
+                {
+                    extraction.slots[slot].found = true;
+                    extraction.slots[slot].value = value;
+                }
+            });
+        extraction.valid = headers.IsValid();
+    }
+
+    void ExtractionPlan::SetLineLimit(size_t lineLengthLimit)
+    {
+        scanner_.SetLineLimit(lineLengthLimit);
+    }
+
+    void ExtractionPlan::SetStrictness(Strictness strictness)
+    {
+        scanner_.SetStrictness(strictness);
+    }
+
+    void ExtractionPlan::SetLimits(const Limits& limits) { scanner_.SetLimits(limits); }
+
+    size_t ExtractionPlan::FindSlot(std::string_view name) const
+    {
+        const auto hash = MessageHeaders::HeaderName::Hash(name);
+        const auto mask = table_.size() - 1;
+        for (auto entryIndex = hash & mask;; entryIndex = (entryIndex + 1) & mask)
+        {
+            const auto entry = table_[entryIndex];
+            if (entry == 0)
+            {
+                return names_.size();
+            }
+            const auto slot = (size_t)(entry - 1);
+            if ((hashes_[slot] == hash)
+                && MessageHeaders::HeaderName::Equivalent(names_[slot], name))
+            {
+                return slot;
+            }
+        }
+    }
+
+    void ExtractionPlan::Prepare(Extraction& extraction) const
+    {
+        extraction.slots.resize(names_.size());
+        for (auto& slot : extraction.slots)
+        {
+            slot.found = false;
+            slot.value = {};
+        }
+        extraction.valid = true;
+        extraction.bodyOffset = 0;
+    }
+}  // namespace MessageHeaders
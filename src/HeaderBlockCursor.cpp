@@ -0,0 +1,69 @@
+/**
+ * @file HeaderBlockCursor.cpp
+ *
+ * This module contains the implementation of the MessageHeaders::HeaderBlockCursor class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <MessageHeaders/HeaderBlockCursor.hpp>
+
+namespace MessageHeaders
+{
+    HeaderBlockCursor::HeaderBlockCursor(std::string_view buffer) : buffer_(buffer) {}
+
+    void HeaderBlockCursor::SetBuffer(std::string_view buffer) { buffer_ = buffer; }
+
+    auto HeaderBlockCursor::Next(MessageHeadersView& headers) -> Block
+    {
+        if (suspendedHeaders_ != &headers)
+        {
+            headers.Clear();
+        }
+        suspendedHeaders_ = nullptr;
+        Block block;
+        const auto rawMessage = buffer_.substr(offset_);
+        size_t bodyOffset = 0;
+        block.state = headers.ParseRawMessage(rawMessage, bodyOffset);
+        switch (block.state)
+        {
+        case State::Complete:
+        {
+            block.rawHeaders = rawMessage.substr(0, bodyOffset);
+            offset_ += bodyOffset;
+            block.bodyOffset = offset_;
+        }
+        break;
+
+        case State::Incomplete:
+        {
+            block.rawHeaders = rawMessage;
+            suspendedHeaders_ = &headers;
+        }
+        break;
+
+        case State::Error:
+        default:
+        {
+            block.rawHeaders = rawMessage;
+        }
+        break;
+        }
+        return block;
+    }
+
+    bool HeaderBlockCursor::Skip(size_t length)
+    {
+        if (length > buffer_.length() - offset_)
+        {
+            return false;
+        }
+        offset_ += length;
+        suspendedHeaders_ = nullptr;
+        return true;
+    }
+
+    size_t HeaderBlockCursor::GetOffset() const { return offset_; }
+
+    std::string_view HeaderBlockCursor::GetRemaining() const { return buffer_.substr(offset_); }
+}  // namespace MessageHeaders
@@ -0,0 +1,32 @@
+/**
+ * @file HeaderEventParser.cpp
+ *
+ * This module contains the implementation of the MessageHeaders::HeaderEventParser class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <MessageHeaders/HeaderEventParser.hpp>
+
+namespace MessageHeaders
+{
+    void HeaderEventParser::SetLineLimit(size_t lineLengthLimit)
+    {
+        scanner_.SetLineLimit(lineLengthLimit);
+    }
+
+    void HeaderEventParser::SetStrictness(Strictness strictness)
+    {
+        scanner_.SetStrictness(strictness);
+    }
+
+    void HeaderEventParser::SetLimits(const Limits& limits) { scanner_.SetLimits(limits); }
+
+    bool HeaderEventParser::IsValid() const { return valid_; }
+
+    void HeaderEventParser::Clear()
+    {
+        scanner_.Reset();
+        valid_ = true;
+    }
+}  // namespace MessageHeaders
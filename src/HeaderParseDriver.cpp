@@ -0,0 +1,69 @@
+/**
+ * @file HeaderParseDriver.cpp
+ *
+ * This module contains the implementation of the MessageHeaders::HeaderParseDriver class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <MessageHeaders/HeaderParseDriver.hpp>
+
+namespace MessageHeaders
+{
+    HeaderParseDriver::HeaderParseDriver(MessageHeaders& headers) : headers_(headers) {}
+
+    auto HeaderParseDriver::Receive(std::string_view buffer) -> Outcome
+    {
+        if (IsDone())
+        {
+            return outcome_;
+        }
+        outcome_.state = headers_.ParseRawMessage(buffer, outcome_.bodyOffset);
+        if (IsDone())
+        {
+            ResumeWaiter();
+        }
+        return outcome_;
+    }
+
+    void HeaderParseDriver::Close()
+    {
+        if (IsDone())
+        {
+            return;
+        }
+        headers_.AbandonParse();
+        outcome_.state = State::Error;
+        ResumeWaiter();
+    }
+
+    auto HeaderParseDriver::GetOutcome() const -> Outcome { return outcome_; }
+
+    bool HeaderParseDriver::IsDone() const { return (outcome_.state != State::Incomplete); }
+
+    void HeaderParseDriver::Reset()
+    {
+        headers_.AbandonParse();
+        outcome_ = Outcome();
+    }
+
+    void HeaderParseDriver::Suspend(Resumer resumer, void* waiter)
+    {
+        resumer_ = resumer;
+        waiter_ = waiter;
+    }
+
+    void HeaderParseDriver::ResumeWaiter()
+    {
+        // Forget the waiter before resuming it, since it may well
+        // reset the driver and wait for the next message right away.
+        const auto resumer = resumer_;
+        const auto waiter = waiter_;
+        resumer_ = nullptr;
+        waiter_ = nullptr;
+        if (resumer != nullptr)
+        {
+            resumer(waiter);
+        }
+    }
+}  // namespace MessageHeaders
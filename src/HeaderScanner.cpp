@@ -0,0 +1,685 @@
+/**
+ * @file HeaderScanner.cpp
+ *
+ * This module contains the implementation of the MessageHeaders::HeaderScanner class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stdint.h>
+#include <MessageHeaders/HeaderScanner.hpp>
+#include <MessageHeaders/ParserProfiles.hpp>
+#include <algorithm>
+#include <array>
+
+#include "Counters.hpp"
+
+#if !defined(MESSAGE_HEADERS_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define MESSAGE_HEADERS_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define MESSAGE_HEADERS_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    /**
+     * These are the characters that are considered whitespace and
+     * should be stripped off by the StripMarginWhitespace() function.
+     *
+     * The name of "WSP" was chosen to match the symbol name from
+     * RFC 2822 (https://tools/ieft.org/html/rfc2822) which refers
+     * to this specific character set.
+     */
+    constexpr std::string_view WSP = " \t";
+
+    /**
+     * This is the required line terminator for internet message header lines.
+     */
+    constexpr std::string_view CRLF = "\r\n";
+
+    /**
+     * These are the classes of characters that may be found in headers,
+     * which are combined as bits in the character class table.
+     */
+    enum CharacterClass : uint8_t
+    {
+        /**
+         * This is "ftext" from RFC 5322, the characters permitted
+         * in the names of e-mail headers.
+         */
+        Ftext = 0x01,
+
+        /**
+         * This is "tchar" from RFC 7230, the characters permitted
+         * in the names of HTTP headers.
+         */
+        Tchar = 0x02,
+
+        /**
+         * This is the set of characters of a "token" from RFC 3261,
+         * the characters permitted in the names of SIP headers.
+         */
+        SipTokenChar = 0x04,
+
+        /**
+         * This is visible characters ("VCHAR"), "obs-text" and
+         * whitespace ("WSP"), the characters permitted in header values.
+         */
+        FieldContent = 0x08,
+    };
+
+    /**
+     * This function builds the table giving the classes of each character.
+     *
+     * @return
+     *      The table giving the classes of each character is returned.
+     */
+    constexpr std::array<uint8_t, 256> MakeCharacterClasses()
+    {
+        std::array<uint8_t, 256> classes{};
+        for (int c = 0; c < 256; ++c)
+        {
+            const bool alphanumeric =
+                ((c >= '0') && (c <= '9')) || ((c >= 'A') && (c <= 'Z')) ||
+                ((c >= 'a') && (c <= 'z'));
+            uint8_t characterClasses = 0;
+            if ((c >= 33) && (c <= 126) && (c != ':'))
+            {
+                characterClasses |= Ftext;
+            }
+            if (alphanumeric || (std::string_view("!#$%&'*+-.^_`|~").find((char)c) !=
+                                 std::string_view::npos))
+            {
+                characterClasses |= Tchar;
+            }
+            if (alphanumeric ||
+                (std::string_view("-.!%*_+`'~").find((char)c) != std::string_view::npos))
+            {
+                characterClasses |= SipTokenChar;
+            }
+            if ((c == ' ') || (c == '\t') || ((c >= 33) && (c != 127)))
+            {
+                characterClasses |= FieldContent;
+            }
+            classes[c] = characterClasses;
+        }
+        return classes;
+    }
+
+    /**
+     * This is the table giving the classes of each character.
+     */
+    constexpr auto CharacterClasses = MakeCharacterClasses();
+
+    /**
+     * This function returns the class of characters permitted in
+     * header names by the given strictness.
+     *
+     * @param[in] strictness
+     *      This selects the rules header names must follow.
+     *
+     * @return
+     *      The class of characters permitted in header names is returned.
+     */
+    constexpr CharacterClass NameCharacterClass(
+        MessageHeaders::HeaderScanner::Strictness strictness)
+    {
+        switch (strictness)
+        {
+        case MessageHeaders::HeaderScanner::Strictness::Http: return Tchar;
+        case MessageHeaders::HeaderScanner::Strictness::Sip: return SipTokenChar;
+        case MessageHeaders::HeaderScanner::Strictness::Email:
+        default: return Ftext;
+        }
+    }
+
+    /**
+     * This function checks that all the characters in the given string
+     * are in the given class.
+     *
+     * @param[in] s
+     *      This is the string to check.
+     *
+     * @param[in] characterClass
+     *      This is the class the characters must be in.
+     *
+     * @return
+     *      An indication of whether or not all the characters in the string
+     *      are in the given class is returned.
+     */
+    bool AllInClass(std::string_view s, CharacterClass characterClass)
+    {
+        uint8_t classes = characterClass;
+        for (auto c : s)
+        {
+            classes &= CharacterClasses[(uint8_t)c];
+        }
+        return (classes != 0);
+    }
+
+    /**
+     * This describes what was found by scanning a raw message for
+     * the end of a line.
+     */
+    struct LineScan
+    {
+        /**
+         * This is the offset of the first line terminator found,
+         * or npos if the raw message doesn't contain one.
+         */
+        size_t lineTerminator = std::string_view::npos;
+
+        /**
+         * This is the offset of the first colon found, or npos if
+         * none was found.  It may come after the line terminator,
+         * in which case the line itself has no colon.
+         */
+        size_t colon = std::string_view::npos;
+
+        /**
+         * This is the offset of the first control character, other than
+         * a horizontal tab, found, or npos if none was found.  It may be
+         * the carriage return of the line terminator, or come after it,
+         * in which case the line itself has no control characters.
+         */
+        size_t control = std::string_view::npos;
+    };
+
+    /**
+     * This function returns the index of the least significant bit
+     * set in the given mask, which must not be zero.
+     *
+     * @param[in] mask
+     *      This is the mask to examine.
+     *
+     * @return
+     *      The index of the least significant bit set in the mask
+     *      is returned.
+     */
+    inline unsigned int LowestBit(uint64_t mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, mask);
+        return (unsigned int)index;
+#else
+        return (unsigned int)__builtin_ctzll(mask);
+#endif
+    }
+
+    /**
+     * This function checks the carriage returns marked in the given mask,
+     * which describes the block of the raw message beginning at the given
+     * offset, for one followed by a line feed, completing a line terminator.
+     *
+     * @param[in] rawMessage
+     *      This is the raw message being scanned.
+     *
+     * @param[in] blockOffset
+     *      This is the offset into the raw message of the block.
+     *
+     * @param[in] carriageReturns
+     *      This has one bit set for every carriage return in the block,
+     *      with bitsPerCharacter bits per character of the block.
+     *
+     * @param[in] bitsPerCharacter
+     *      This is the number of mask bits describing each character.
+     *
+     * @return
+     *      The offset of the first line terminator in the block is returned,
+     *      or npos if the block doesn't contain the start of one.
+     */
+    inline size_t FindTerminatorInBlock(std::string_view rawMessage, size_t blockOffset,
+                                        uint64_t carriageReturns, unsigned int bitsPerCharacter)
+    {
+        while (carriageReturns != 0)
+        {
+            const auto offset = blockOffset + LowestBit(carriageReturns) / bitsPerCharacter;
+            if ((offset + 1 < rawMessage.length()) && (rawMessage[offset + 1] == '\n'))
+            {
+                return offset;
+            }
+            carriageReturns &= carriageReturns - 1;
+        }
+        return std::string_view::npos;
+    }
+
+    /**
+     * This function scans the given raw message, starting at the given
+     * offset, for the next line terminator, noting the first colon and
+     * control character seen along the way, so that every character of
+     * a header line is examined only once.  Where the target supports it, the raw message is
+     * classified 16 characters at a time using vector instructions.
+     *
+     * @param[in] rawMessage
+     *      This is the raw message to scan.
+     *
+     * @param[in] offset
+     *      This is the offset into the raw message where to begin scanning.
+     *
+     * @return
+     *      What was found by the scan is returned.
+     */
+    LineScan ScanLine(std::string_view rawMessage, size_t offset)
+    {
+        LineScan scan;
+        const auto data = rawMessage.data();
+        const auto length = rawMessage.length();
+#if defined(MESSAGE_HEADERS_SSE2)
+        const auto carriageReturn = _mm_set1_epi8('\r');
+        const auto colon = _mm_set1_epi8(':');
+        const auto lastControl = _mm_set1_epi8(0x1F);
+        const auto tab = _mm_set1_epi8('\t');
+        const auto del = _mm_set1_epi8(0x7F);
+        for (; offset + 16 <= length; offset += 16)
+        {
+            const auto block = _mm_loadu_si128((const __m128i*)(data + offset));
+            const auto colons = (uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, colon));
+            if ((colons != 0) && (scan.colon == std::string_view::npos))
+            {
+                scan.colon = offset + LowestBit(colons);
+            }
+            const auto controls = (uint64_t)_mm_movemask_epi8(_mm_or_si128(
+                _mm_andnot_si128(_mm_cmpeq_epi8(block, tab),
+                                 _mm_cmpeq_epi8(_mm_min_epu8(block, lastControl), block)),
+                _mm_cmpeq_epi8(block, del)));
+            if ((controls != 0) && (scan.control == std::string_view::npos))
+            {
+                scan.control = offset + LowestBit(controls);
+            }
+            const auto carriageReturns =
+                (uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, carriageReturn));
+            if (carriageReturns != 0)
+            {
+                scan.lineTerminator =
+                    FindTerminatorInBlock(rawMessage, offset, carriageReturns, 1);
+                if (scan.lineTerminator != std::string_view::npos)
+                {
+                    return scan;
+                }
+            }
+        }
+#elif defined(MESSAGE_HEADERS_NEON)
+        // NEON has no equivalent of a byte "move mask", so the comparison
+        // results are narrowed to 4 bits per character instead, keeping
+        // only the top bit of each group of 4.
+        const auto carriageReturn = vdupq_n_u8('\r');
+        const auto colon = vdupq_n_u8(':');
+        const auto space = vdupq_n_u8(' ');
+        const auto tab = vdupq_n_u8('\t');
+        const auto del = vdupq_n_u8(0x7F);
+        const auto toMask = [](uint8x16_t matches) -> uint64_t {
+            const auto narrowed = vshrn_n_u16(vreinterpretq_u16_u8(matches), 4);
+            return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0) & 0x8888888888888888ull;
+        };
+        for (; offset + 16 <= length; offset += 16)
+        {
+            const auto block = vld1q_u8((const uint8_t*)(data + offset));
+            const auto colons = toMask(vceqq_u8(block, colon));
+            if ((colons != 0) && (scan.colon == std::string_view::npos))
+            {
+                scan.colon = offset + LowestBit(colons) / 4;
+            }
+            const auto controls = toMask(vorrq_u8(
+                vbicq_u8(vcltq_u8(block, space), vceqq_u8(block, tab)), vceqq_u8(block, del)));
+            if ((controls != 0) && (scan.control == std::string_view::npos))
+            {
+                scan.control = offset + LowestBit(controls) / 4;
+            }
+            const auto carriageReturns = toMask(vceqq_u8(block, carriageReturn));
+            if (carriageReturns != 0)
+            {
+                scan.lineTerminator =
+                    FindTerminatorInBlock(rawMessage, offset, carriageReturns, 4);
+                if (scan.lineTerminator != std::string_view::npos)
+                {
+                    return scan;
+                }
+            }
+        }
+#endif
+        for (; offset < length; ++offset)
+        {
+            const auto c = data[offset];
+            if ((c == ':') && (scan.colon == std::string_view::npos))
+            {
+                scan.colon = offset;
+            }
+            else if (((CharacterClasses[(uint8_t)c] & FieldContent) == 0) &&
+                     (scan.control == std::string_view::npos))
+            {
+                scan.control = offset;
+            }
+            if ((c == '\r') && (offset + 1 < length) && (data[offset + 1] == '\n'))
+            {
+                scan.lineTerminator = offset;
+                break;
+            }
+        }
+        return scan;
+    }
+
+    /**
+     * This function unfolds the value of the given header found in the
+     * given raw message, and strips any margin whitespace from it.
+     *
+     * @param[in] rawMessage
+     *      This is the raw message in which the header was found.
+     *
+     * @param[in] header
+     *      This is the header whose value should be unfolded.
+     *
+     * @param[out] value
+     *      This is where to store the unfolded header value.
+     */
+    template <typename String>
+    void UnfoldValueInto(std::string_view rawMessage,
+                         const MessageHeaders::HeaderScanner::ScannedHeader& header, String& value)
+    {
+        auto lineTerminator = std::min(rawMessage.find(CRLF, header.valueOffset), header.valueEnd);
+        value.assign(MessageHeaders::HeaderScanner::StripMarginWhitespace(
+            rawMessage.substr(header.valueOffset, lineTerminator - header.valueOffset)));
+        // Each continuation line contributes a single whitespace,
+        // followed by the rest of the line after its leading whitespace.
+        while (lineTerminator < header.valueEnd)
+        {
+            const auto nextLineStart = lineTerminator + CRLF.length();
+            lineTerminator = std::min(rawMessage.find(CRLF, nextLineStart), header.valueEnd);
+            const auto firstNonWhiteSpace =
+                std::min(rawMessage.find_first_not_of(WSP, nextLineStart), lineTerminator);
+            value += ' ';
+            value.append(
+                rawMessage.substr(firstNonWhiteSpace, lineTerminator - firstNonWhiteSpace));
+        }
+        const auto marginRight = value.find_last_not_of(WSP);
+        value.erase((marginRight == String::npos) ? 0 : marginRight + 1);
+        value.erase(0, std::min(value.find_first_not_of(WSP), value.length()));
+    }
+}  // namespace
+
+namespace MessageHeaders
+{
+    void HeaderScanner::SetLineLimit(size_t lineLengthLimit) { lineLengthLimit_ = lineLengthLimit; }
+
+    void HeaderScanner::SetStrictness(Strictness strictness) { strictness_ = strictness; }
+
+    void HeaderScanner::SetLimits(const Limits& limits) { limits_ = limits; }
+
+    auto HeaderScanner::Next(std::string_view rawMessage, ScannedHeader& header) -> Result
+    {
+        return Next<ConfiguredProfile>(rawMessage, header);
+    }
+
+    template <typename Profile>
+    auto HeaderScanner::Next(std::string_view rawMessage, ScannedHeader& header) -> Result
+    {
+        const auto lineLengthLimit =
+            (lineLengthLimit_ > 0) ? lineLengthLimit_ : Profile::lineLengthLimit;
+        const auto nameCharacterClass = Profile::fixedStrictness
+                                            ? NameCharacterClass(Profile::strictness)
+                                            : NameCharacterClass(strictness_);
+        scannedLength_ = rawMessage.length();
+        for (;;)
+        {
+            const auto lineStart = parseOffset_;
+
+            // Only search as far as the line terminator could be without
+            // breaking the limits, so that a line which is too long is
+            // rejected without scanning all of it.
+            auto scanEnd = rawMessage.length();
+            if (lineLengthLimit > 0)
+            {
+                scanEnd = std::min(scanEnd, lineStart + lineLengthLimit);
+            }
+            if (limits_.blockSize > 0)
+            {
+                scanEnd = std::min(scanEnd, limits_.blockSize);
+            }
+            LineScan scan;
+            if (lineScanned_)
+            {
+                scan.lineTerminator = scannedLineTerminator_;
+                scan.colon = scannedColon_;
+                scan.control = scannedControl_;
+                lineScanned_ = false;
+            }
+            else
+            {
+                // If the search for the line terminator resumes part way
+                // through the line, combine what's found with what was
+                // found in the part of the line already scanned.
+                const auto scanStart = std::max(lineStart, scanOffset_);
+                scan = ScanLine(rawMessage.substr(0, scanEnd), scanStart);
+                if (scanStart > lineStart)
+                {
+                    // Only the last character scanned before is scanned again,
+                    // in case it's the start of a line terminator.
+                    MESSAGE_HEADERS_COUNT(bytesRescanned, 1);
+                    scan.colon = std::min(scan.colon, scannedColon_);
+                    scan.control = std::min(scan.control, scannedControl_);
+                }
+            }
+            const auto lineTerminator = scan.lineTerminator;
+            if (lineTerminator == std::string_view::npos)
+            {
+                if (scanEnd < rawMessage.length())
+                {
+                    if (scanEnd == limits_.blockSize)
+                    {
+                        MESSAGE_HEADERS_COUNT(limitErrors, 1);
+                    }
+                    else
+                    {
+                        MESSAGE_HEADERS_COUNT(lineLimitErrors, 1);
+                    }
+                    return Result::Error;
+                }
+                // The line needs at least its terminator to be complete,
+                // of which a carriage return at the end may be the first half.
+                const auto terminatorMissing =
+                    ((rawMessage.length() > lineStart) && (rawMessage.back() == '\r'))
+                        ? CRLF.length() - 1
+                        : CRLF.length();
+                if (lineLengthLimit > 0)
+                {
+                    const auto unterminatedLineLength = rawMessage.length() - lineStart;
+                    if (unterminatedLineLength + terminatorMissing > lineLengthLimit)
+                    {
+                        MESSAGE_HEADERS_COUNT(lineLimitErrors, 1);
+                        return Result::Error;
+                    }
+                }
+                if ((limits_.blockSize > 0) &&
+                    (rawMessage.length() + terminatorMissing > limits_.blockSize))
+                {
+                    MESSAGE_HEADERS_COUNT(limitErrors, 1);
+                    return Result::Error;
+                }
+                // The last character might be the carriage return of a line
+                // terminator whose line feed hasn't arrived yet, so that's
+                // the earliest place where the next search must resume.
+                if (rawMessage.length() > lineStart)
+                {
+                    scanOffset_ = rawMessage.length() - 1;
+                    scannedColon_ = scan.colon;
+                    scannedControl_ = scan.control;
+                }
+                return Result::Incomplete;
+            }
+            scanOffset_ = 0;
+
+            if (lineLengthLimit > 0)
+            {
+                if (lineTerminator - lineStart + CRLF.length() > lineLengthLimit)
+                {
+                    MESSAGE_HEADERS_COUNT(lineLimitErrors, 1);
+                    return Result::Error;
+                }
+            }
+
+            // If the line begins with whitespace, it's a continuation
+            // of the previous header line, so fold it into that header,
+            // unless the profile doesn't allow folding.
+            const auto lineLength = lineTerminator - lineStart;
+            if constexpr (!Profile::folding)
+            {
+                if ((lineLength > 0) && (WSP.find(rawMessage[lineStart]) != std::string_view::npos))
+                {
+                    return Result::Error;
+                }
+            }
+            else if (pendingHeader_ && (lineLength > 2) &&
+                     (WSP.find(rawMessage[lineStart]) != std::string_view::npos))
+            {
+                if ((limits_.continuationLines > 0) &&
+                    (++continuationLines_ > limits_.continuationLines))
+                {
+                    MESSAGE_HEADERS_COUNT(limitErrors, 1);
+                    return Result::Error;
+                }
+                pending_.valueEnd = lineTerminator;
+                pending_.folded = true;
+                if (scan.control < lineTerminator)
+                {
+                    pending_.validValue = false;
+                }
+                parseOffset_ = lineTerminator + CRLF.length();
+                continue;
+            }
+
+            // Any other line means the pending header can't be folded
+            // any further, so it's complete.  The line itself is left
+            // for the next call, which won't need to scan it again.
+            if (pendingHeader_)
+            {
+                header = pending_;
+                pendingHeader_ = false;
+                lineScanned_ = true;
+                scannedLineTerminator_ = lineTerminator;
+                scannedColon_ = scan.colon;
+                scannedControl_ = scan.control;
+                return Result::Header;
+            }
+
+            if (lineTerminator == lineStart)
+            {
+                parseOffset_ = lineStart + CRLF.length();
+                return Result::End;
+            }
+
+            if (scan.colon > lineTerminator)
+            {
+                return Result::Error;
+            }
+            if ((limits_.headerCount > 0) && (headerCount_ == limits_.headerCount))
+            {
+                MESSAGE_HEADERS_COUNT(limitErrors, 1);
+                return Result::Error;
+            }
+            ++headerCount_;
+            continuationLines_ = 0;
+            const auto nameValueDelimiter = scan.colon - lineStart;
+            pending_.nameOffset = lineStart;
+            pending_.nameLength = nameValueDelimiter;
+            pending_.valueOffset = lineStart + nameValueDelimiter + 1;
+            pending_.valueEnd = lineTerminator;
+            pending_.folded = false;
+            const auto name = rawMessage.substr(lineStart, nameValueDelimiter);
+            // Every set of rules requires at least one character in a name.
+            pending_.validName = !name.empty() && AllInClass(name, nameCharacterClass);
+            if (scan.control < scan.colon)
+            {
+                // The control character found is in the name, so the value
+                // still needs to be checked on its own.
+                pending_.validValue = AllInClass(
+                    rawMessage.substr(pending_.valueOffset, lineTerminator - pending_.valueOffset),
+                    FieldContent);
+            }
+            else
+            {
+                pending_.validValue = (scan.control >= lineTerminator);
+            }
+            parseOffset_ = lineTerminator + CRLF.length();
+
+            // Without folding, nothing that follows can change the header,
+            // so there's no need to wait for the next line.
+            if constexpr (!Profile::folding)
+            {
+                header = pending_;
+                return Result::Header;
+            }
+            pendingHeader_ = true;
+        }
+    }
+
+    template auto HeaderScanner::Next<ConfiguredProfile>(std::string_view rawMessage,
+                                                         ScannedHeader& header) -> Result;
+    template auto HeaderScanner::Next<HttpProfile>(std::string_view rawMessage,
+                                                   ScannedHeader& header) -> Result;
+    template auto HeaderScanner::Next<SipProfile>(std::string_view rawMessage,
+                                                  ScannedHeader& header) -> Result;
+    template auto HeaderScanner::Next<EmailProfile>(std::string_view rawMessage,
+                                                    ScannedHeader& header) -> Result;
+
+    size_t HeaderScanner::GetOffset() const { return parseOffset_; }
+
+    size_t HeaderScanner::GetScannedLength() const { return scannedLength_; }
+
+    void HeaderScanner::Reset()
+    {
+        parseOffset_ = 0;
+        scannedLength_ = 0;
+        scanOffset_ = 0;
+        lineScanned_ = false;
+        pendingHeader_ = false;
+        headerCount_ = 0;
+        continuationLines_ = 0;
+    }
+
+    std::string_view HeaderScanner::GetName(std::string_view rawMessage,
+                                            const ScannedHeader& header)
+    {
+        return rawMessage.substr(header.nameOffset, header.nameLength);
+    }
+
+    std::string_view HeaderScanner::GetValue(std::string_view rawMessage,
+                                             const ScannedHeader& header)
+    {
+        return StripMarginWhitespace(
+            rawMessage.substr(header.valueOffset, header.valueEnd - header.valueOffset));
+    }
+
+    void HeaderScanner::UnfoldValue(std::string_view rawMessage, const ScannedHeader& header,
+                                    std::string& value)
+    {
+        UnfoldValueInto(rawMessage, header, value);
+    }
+
+    void HeaderScanner::UnfoldValue(std::string_view rawMessage, const ScannedHeader& header,
+                                    std::pmr::string& value)
+    {
+        UnfoldValueInto(rawMessage, header, value);
+    }
+
+    std::string_view HeaderScanner::StripMarginWhitespace(std::string_view s)
+    {
+        const auto marginLeft = s.find_first_not_of(WSP);
+        const auto marginRight = s.find_last_not_of(WSP);
+        if (marginLeft == std::string_view::npos)
+        {
+            return {};
+        }
+        else
+        {
+            return s.substr(marginLeft, marginRight - marginLeft + 1);
+        }
+    }
+}  // namespace MessageHeaders
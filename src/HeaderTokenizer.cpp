@@ -0,0 +1,73 @@
+/**
+ * @file HeaderTokenizer.cpp
+ *
+ * This module contains the implementation of the MessageHeaders::HeaderTokenizer class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <MessageHeaders/HeaderScanner.hpp>
+#include <MessageHeaders/HeaderTokenizer.hpp>
+
+namespace MessageHeaders
+{
+    HeaderTokenizer::HeaderTokenizer(std::string_view value, bool trimWhitespace,
+                                     bool quotedStrings, char delimiter) :
+        value_(value),
+        trimWhitespace_(trimWhitespace),
+        quotedStrings_(quotedStrings),
+        delimiter_(delimiter)
+    {
+    }
+
+    bool HeaderTokenizer::Next(std::string_view& token)
+    {
+        while (offset_ < value_.length())
+        {
+            const auto tokenStart = offset_;
+            bool quoted = false;
+            bool escaped = false;
+            for (; offset_ < value_.length(); ++offset_)
+            {
+                const auto c = value_[offset_];
+                if (escaped)
+                {
+                    escaped = false;
+                }
+                else if (quoted)
+                {
+                    if (c == '\\')
+                    {
+                        escaped = true;
+                    }
+                    else if (c == '"')
+                    {
+                        quoted = false;
+                    }
+                }
+                else if (c == delimiter_)
+                {
+                    break;
+                }
+                else if ((c == '"') && quotedStrings_)
+                {
+                    quoted = true;
+                }
+            }
+            token = value_.substr(tokenStart, offset_ - tokenStart);
+            if (offset_ < value_.length())
+            {
+                ++offset_;
+            }
+            if (trimWhitespace_)
+            {
+                token = HeaderScanner::StripMarginWhitespace(token);
+            }
+            if (!token.empty())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}  // namespace MessageHeaders
@@ -0,0 +1,86 @@
+/**
+ * @file Instrumentation.cpp
+ *
+ * This module contains the implementation of the MessageHeaders::Instrumentation class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <MessageHeaders/Instrumentation.hpp>
+
+#include "Counters.hpp"
+
+namespace MessageHeaders
+{
+#ifdef MESSAGE_HEADERS_INSTRUMENTATION
+    namespace Counters
+    {
+        Counter messagesParsed;
+        Counter headersParsed;
+        Counter foldedHeadersParsed;
+        Counter incompleteParses;
+        Counter bytesRescanned;
+        Counter parseErrors;
+        Counter lineLimitErrors;
+        Counter limitErrors;
+        Counter lookupHits;
+        Counter lookupMisses;
+        Counter rawHeadersGenerated;
+        Counter rawBytesGenerated;
+        Counter headerLinesFolded;
+    }  // namespace Counters
+
+    namespace
+    {
+        /**
+         * These are all the counters, along with where their values
+         * go in a snapshot.
+         */
+        const struct
+        {
+            Counters::Counter* counter;
+            uint64_t Instrumentation::Snapshot::*field;
+        } AllCounters[] = {
+            {&Counters::messagesParsed, &Instrumentation::Snapshot::messagesParsed},
+            {&Counters::headersParsed, &Instrumentation::Snapshot::headersParsed},
+            {&Counters::foldedHeadersParsed, &Instrumentation::Snapshot::foldedHeadersParsed},
+            {&Counters::incompleteParses, &Instrumentation::Snapshot::incompleteParses},
+            {&Counters::bytesRescanned, &Instrumentation::Snapshot::bytesRescanned},
+            {&Counters::parseErrors, &Instrumentation::Snapshot::parseErrors},
+            {&Counters::lineLimitErrors, &Instrumentation::Snapshot::lineLimitErrors},
+            {&Counters::limitErrors, &Instrumentation::Snapshot::limitErrors},
+            {&Counters::lookupHits, &Instrumentation::Snapshot::lookupHits},
+            {&Counters::lookupMisses, &Instrumentation::Snapshot::lookupMisses},
+            {&Counters::rawHeadersGenerated, &Instrumentation::Snapshot::rawHeadersGenerated},
+            {&Counters::rawBytesGenerated, &Instrumentation::Snapshot::rawBytesGenerated},
+            {&Counters::headerLinesFolded, &Instrumentation::Snapshot::headerLinesFolded},
+        };
+    }  // namespace
+
+    bool Instrumentation::IsEnabled() { return true; }
+
+    auto Instrumentation::GetSnapshot() -> Snapshot
+    {
+        Snapshot snapshot;
+        for (const auto& entry : AllCounters)
+        {
+            snapshot.*entry.field = entry.counter->value.load(std::memory_order_relaxed);
+        }
+        return snapshot;
+    }
+
+    void Instrumentation::Reset()
+    {
+        for (const auto& entry : AllCounters)
+        {
+            entry.counter->value.store(0, std::memory_order_relaxed);
+        }
+    }
+#else
+    bool Instrumentation::IsEnabled() { return false; }
+
+    auto Instrumentation::GetSnapshot() -> Snapshot { return Snapshot(); }
+
+    void Instrumentation::Reset() {}
+#endif /* MESSAGE_HEADERS_INSTRUMENTATION */
+}  // namespace MessageHeaders
@@ -0,0 +1,160 @@
+/**
+ * @file MappedFile.cpp
+ *
+ * This module contains the implementation of the MessageHeaders::MappedFile class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stddef.h>
+#include <MessageHeaders/MappedFile.hpp>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace MessageHeaders
+{
+    /**
+     * This contains the private properties of a MappedFile instance.
+     */
+    struct MappedFile::Impl
+    {
+        /**
+         * This points to the first character of the file mapped,
+         * or is nullptr if no file is mapped or the file is empty.
+         */
+        const char* data = nullptr;
+
+        /**
+         * This is the number of characters in the file mapped.
+         */
+        size_t size = 0;
+
+        /**
+         * This indicates whether or not a file is mapped.
+         */
+        bool open = false;
+
+        /**
+         * This is the destructor of the structure.
+         */
+        ~Impl() noexcept { Unmap(); }
+
+        /**
+         * This function maps the file at the given path into memory.
+         *
+         * @param[in] path
+         *      This is the path of the file to map.
+         *
+         * @return
+         *      An indication of whether or not the file was
+         *      mapped successfully is returned.
+         */
+        bool Map(const std::string& path)
+        {
+#ifdef _WIN32
+            const auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                          OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                return false;
+            }
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(file, &fileSize))
+            {
+                (void)CloseHandle(file);
+                return false;
+            }
+            size = (size_t)fileSize.QuadPart;
+            if (size > 0)
+            {
+                const auto mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+                if (mapping != NULL)
+                {
+                    data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                    (void)CloseHandle(mapping);
+                }
+            }
+            (void)CloseHandle(file);
+#else
+            const auto file = ::open(path.c_str(), O_RDONLY);
+            if (file < 0)
+            {
+                return false;
+            }
+            struct stat fileStatus;
+            if (fstat(file, &fileStatus) != 0)
+            {
+                (void)::close(file);
+                return false;
+            }
+            size = (size_t)fileStatus.st_size;
+            if (size > 0)
+            {
+                const auto mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+                if (mapping != MAP_FAILED)
+                {
+                    data = (const char*)mapping;
+                    // The file is expected to be parsed from one end to
+                    // the other, so read ahead aggressively.
+                    (void)madvise(mapping, size, MADV_SEQUENTIAL);
+                }
+            }
+            (void)::close(file);
+#endif
+            if ((size > 0) && (data == nullptr))
+            {
+                size = 0;
+                return false;
+            }
+            open = true;
+            return true;
+        }
+
+        /**
+         * This function unmaps the file mapped, if any.
+         */
+        void Unmap()
+        {
+            if (data != nullptr)
+            {
+#ifdef _WIN32
+                (void)UnmapViewOfFile(data);
+#else
+                (void)munmap((void*)data, size);
+#endif
+            }
+            data = nullptr;
+            size = 0;
+            open = false;
+        }
+    };
+
+    MappedFile::~MappedFile() noexcept = default;
+    MappedFile::MappedFile(MappedFile&&) noexcept = default;
+    MappedFile& MappedFile::operator=(MappedFile&&) noexcept = default;
+
+    MappedFile::MappedFile() : impl_(new Impl()) {}
+
+    bool MappedFile::Open(const std::string& path)
+    {
+        impl_->Unmap();
+        return impl_->Map(path);
+    }
+
+    void MappedFile::Close() { impl_->Unmap(); }
+
+    bool MappedFile::IsOpen() const { return impl_->open; }
+
+    std::string_view MappedFile::GetContents() const
+    {
+        return std::string_view(impl_->data, impl_->size);
+    }
+}  // namespace MessageHeaders
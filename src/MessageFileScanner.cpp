@@ -0,0 +1,325 @@
+/**
+ * @file MessageFileScanner.cpp
+ *
+ * This module contains the implementation of the MessageHeaders::MessageFileScanner class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <MessageHeaders/HeaderBlockCursor.hpp>
+#include <MessageHeaders/MessageFileScanner.hpp>
+#include <algorithm>
+#include <memory_resource>
+#include <string>
+#include <thread>
+
+namespace
+{
+    /**
+     * This is the line terminator expected by the header parser.
+     */
+    constexpr std::string_view CRLF = "\r\n";
+
+    /**
+     * This is how each message begins in an mbox file.
+     */
+    constexpr std::string_view MboxSeparator = "From ";
+
+    /**
+     * This function finds the first message of an mbox file which
+     * begins at or after the given offset.
+     *
+     * @param[in] contents
+     *      These are the contents of the file.
+     *
+     * @param[in] from
+     *      This is the offset from which to look for a message.
+     *
+     * @return
+     *      The offset where the message begins is returned, or the length
+     *      of the contents if there isn't any message left.
+     */
+    size_t FindMboxMessage(std::string_view contents, size_t from)
+    {
+        for (auto offset = contents.find(MboxSeparator, from); offset != std::string_view::npos;
+             offset = contents.find(MboxSeparator, offset + 1))
+        {
+            // The separator only begins a message at the beginning of
+            // the file, or at the beginning of a line after a blank line.
+            if (offset == 0)
+            {
+                return offset;
+            }
+            if ((offset < 2) || (contents[offset - 1] != '\n'))
+            {
+                continue;
+            }
+            if ((contents[offset - 2] == '\n')
+                || ((offset >= 3) && (contents[offset - 2] == '\r')
+                    && (contents[offset - 3] == '\n')))
+            {
+                return offset;
+            }
+        }
+        return contents.length();
+    }
+
+    /**
+     * This function parses the number in the given header value.
+     *
+     * @param[in] value
+     *      This is the header value to parse.
+     *
+     * @param[out] number
+     *      This is where to store the number.
+     *
+     * @return
+     *      An indication of whether or not the header value
+     *      is a valid number is returned.
+     */
+    bool ParseLength(std::string_view value, size_t& number)
+    {
+        number = 0;
+        if (value.empty())
+        {
+            return false;
+        }
+        for (const auto c : value)
+        {
+            if ((c < '0') || (c > '9'))
+            {
+                return false;
+            }
+            const auto digit = (size_t)(c - '0');
+            if (number > (((size_t)-1) - digit) / 10)
+            {
+                return false;
+            }
+            number = number * 10 + digit;
+        }
+        return true;
+    }
+}  // namespace
+
+namespace MessageHeaders
+{
+    MessageFileScanner::MessageFileScanner(Framing framing, size_t threadCount) :
+        framing_(framing),
+        threadCount_((threadCount == 0) ? std::max(std::thread::hardware_concurrency(), 1u)
+                                        : threadCount)
+    {
+    }
+
+    auto MessageFileScanner::Index(std::string_view contents) const -> std::vector<Message>
+    {
+        typedef std::vector<std::vector<Message>> Parts;
+        Parts parts(threadCount_);
+        const auto partCount = VisitMessages(
+            contents,
+            [](void* context, size_t part, const Message& message, const MessageHeadersView&)
+            { (*static_cast<Parts*>(context))[part].push_back(message); },
+            &parts);
+        std::vector<Message> messages;
+        size_t messageCount = 0;
+        for (size_t i = 0; i < partCount; ++i)
+        {
+            messageCount += parts[i].size();
+        }
+        messages.reserve(messageCount);
+        for (size_t i = 0; i < partCount; ++i)
+        {
+            messages.insert(messages.end(), parts[i].begin(), parts[i].end());
+        }
+        return messages;
+    }
+
+    void MessageFileScanner::SetLineLimit(size_t lineLengthLimit)
+    {
+        lineLengthLimit_ = lineLengthLimit;
+    }
+
+    void MessageFileScanner::SetStrictness(Strictness strictness) { strictness_ = strictness; }
+
+    void MessageFileScanner::SetLimits(const Limits& limits) { limits_ = limits; }
+
+    size_t MessageFileScanner::VisitMessages(std::string_view contents, MessageVisitor visitor,
+                                             void* context) const
+    {
+        if (framing_ == Framing::ContentLength)
+        {
+            ScanContentLength(contents, visitor, context);
+            return 1;
+        }
+
+        // Split the file into parts of about the same size, each beginning
+        // where a message begins, dropping any parts which turn out to be
+        // empty because a single message spans several of them.
+        std::vector<size_t> partBegins;
+        partBegins.push_back(FindMboxMessage(contents, 0));
+        for (size_t i = 1; i < threadCount_; ++i)
+        {
+            const auto from = std::max(contents.length() / threadCount_ * i, partBegins.back() + 1);
+            if (from >= contents.length())
+            {
+                break;
+            }
+            const auto begin = FindMboxMessage(contents, from);
+            if (begin == contents.length())
+            {
+                break;
+            }
+            partBegins.push_back(begin);
+        }
+        partBegins.push_back(contents.length());
+        const auto partCount = partBegins.size() - 1;
+        std::vector<std::thread> workers;
+        workers.reserve(partCount - 1);
+        for (size_t i = 1; i < partCount; ++i)
+        {
+            workers.emplace_back(
+                [this, contents, &partBegins, i, visitor, context]
+                { ScanMbox(contents, partBegins[i], partBegins[i + 1], i, visitor, context); });
+        }
+        ScanMbox(contents, partBegins[0], partBegins[1], 0, visitor, context);
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        return partCount;
+    }
+
+    void MessageFileScanner::ScanMbox(std::string_view contents, size_t begin, size_t end,
+                                      size_t part, MessageVisitor visitor, void* context) const
+    {
+        // Each thread keeps the memory used for the headers of a message
+        // around for the next, rather than contending for the heap.
+        std::pmr::unsynchronized_pool_resource memory;
+        MessageHeadersView headers(&memory);
+        Configure(headers);
+        std::string normalizedHeaders;
+        for (auto offset = begin; offset < end;)
+        {
+            Message message;
+            message.offset = offset;
+            message.end = std::min(FindMboxMessage(contents, offset + 1), end);
+            const auto messageContents = contents.substr(offset, message.end - offset);
+            const auto separatorLineEnd = messageContents.find('\n');
+            message.headersOffset =
+                (separatorLineEnd == std::string_view::npos) ? message.end
+                                                             : offset + separatorLineEnd + 1;
+            message.bodyOffset = message.end;
+            const auto rawHeaders =
+                contents.substr(message.headersOffset, message.end - message.headersOffset);
+            headers.Clear();
+            size_t bodyOffset = 0;
+            if ((separatorLineEnd == std::string_view::npos) || (separatorLineEnd == 0)
+                || (messageContents[separatorLineEnd - 1] == '\r'))
+            {
+                message.state = headers.ParseRawMessage(rawHeaders, bodyOffset);
+                if (message.state == State::Complete)
+                {
+                    message.bodyOffset = message.headersOffset + bodyOffset;
+                }
+            }
+            else
+            {
+                // Copy only the header block, with CRLF line terminators.
+                auto headersEnd = rawHeaders.length();
+                if (!rawHeaders.empty() && (rawHeaders[0] == '\n'))
+                {
+                    headersEnd = 1;
+                }
+                else
+                {
+                    const auto blankLine = rawHeaders.find("\n\n");
+                    if (blankLine != std::string_view::npos)
+                    {
+                        headersEnd = blankLine + 2;
+                    }
+                }
+                normalizedHeaders.clear();
+                for (size_t i = 0; i < headersEnd; ++i)
+                {
+                    if ((rawHeaders[i] == '\n') && ((i == 0) || (rawHeaders[i - 1] != '\r')))
+                    {
+                        normalizedHeaders += CRLF;
+                    }
+                    else
+                    {
+                        normalizedHeaders += rawHeaders[i];
+                    }
+                }
+                message.state = headers.ParseRawMessage(normalizedHeaders, bodyOffset);
+                if (message.state == State::Complete)
+                {
+                    message.bodyOffset = message.headersOffset + headersEnd;
+                }
+            }
+            message.valid = headers.IsValid() && (message.state != State::Error);
+            visitor(context, part, message, headers);
+            offset = message.end;
+        }
+    }
+
+    void MessageFileScanner::ScanContentLength(std::string_view contents, MessageVisitor visitor,
+                                               void* context) const
+    {
+        std::pmr::unsynchronized_pool_resource memory;
+        MessageHeadersView headers(&memory);
+        Configure(headers);
+        HeaderBlockCursor cursor(contents);
+        for (;;)
+        {
+            while (cursor.GetRemaining().substr(0, CRLF.length()) == CRLF)
+            {
+                (void)cursor.Skip(CRLF.length());
+            }
+            if (cursor.GetRemaining().empty())
+            {
+                return;
+            }
+            Message message;
+            message.offset = cursor.GetOffset();
+            const auto startLineEnd = cursor.GetRemaining().find(CRLF);
+            if (startLineEnd == std::string_view::npos)
+            {
+                message.headersOffset = message.bodyOffset = message.end = contents.length();
+                visitor(context, 0, message, headers);
+                return;
+            }
+            (void)cursor.Skip(startLineEnd + CRLF.length());
+            message.headersOffset = cursor.GetOffset();
+            const auto block = cursor.Next(headers);
+            message.state = block.state;
+            message.valid = headers.IsValid() && (message.state != State::Error);
+            if (block.state != State::Complete)
+            {
+                message.bodyOffset = message.end = contents.length();
+                visitor(context, 0, message, headers);
+                return;
+            }
+            message.bodyOffset = block.bodyOffset;
+            auto contentLength = headers.GetHeaderValue("Content-Length");
+            if (!headers.HasHeader("Content-Length"))
+            {
+                contentLength = headers.GetHeaderValue("l");
+            }
+            size_t bodyLength = 0;
+            if (!contentLength.empty() && !ParseLength(contentLength, bodyLength))
+            {
+                message.valid = false;
+            }
+            bodyLength = std::min(bodyLength, contents.length() - message.bodyOffset);
+            (void)cursor.Skip(bodyLength);
+            message.end = cursor.GetOffset();
+            visitor(context, 0, message, headers);
+        }
+    }
+
+    void MessageFileScanner::Configure(MessageHeadersView& headers) const
+    {
+        headers.SetLineLimit(lineLengthLimit_);
+        headers.SetStrictness(strictness_);
+        headers.SetLimits(limits_);
+    }
+}  // namespace MessageHeaders
@@ -6,122 +6,420 @@
  * © 2024 by Hatem Nabli
  */
 
+#include <string.h>
+#include <MessageHeaders/HeaderScanner.hpp>
 #include <MessageHeaders/MessageHeaders.hpp>
+#include <MessageHeaders/ParserProfiles.hpp>
 #include <StringUtils/StringUtils.hpp>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Counters.hpp"
 
 namespace
 {
     /**
-     * These are the characters that are considered whitespace and
-     * should be stripped off by the StripMarginWhitespace() function.
-     *
-     * The name of "WSP" was chosen to match the symbol name from
-     * RFC 2822 (https://tools/ieft.org/html/rfc2822) which refers
-     * to this specific character set.
+     * This is the required line terminator for internet message header lines.
      */
-    const std::string WSP = " \t";
+    const std::string CRLF = "\r\n";
 
     /**
-     * This is the required line terminator for internet message header lines.
+     * This is returned when looking up a header that isn't
+     * in the message.
      */
-    const std::string CRLF = "\r\n";
+    constexpr size_t NotFound = (size_t)-1;
+
+    /**
+     * This is the smallest number of headers for which looking them up
+     * by name goes through the index rather than checking each header
+     * in turn.
+     */
+    constexpr size_t IndexThreshold = 8;
+
+    /**
+     * This is the smallest number of characters no longer belonging
+     * to any header for which the buffer of header names and values
+     * is ever rebuilt without them.
+     */
+    constexpr size_t CompactionThreshold = 256;
 
     /**
+     * This is the largest number of characters either buffer of header
+     * names and values may hold, since the offsets and lengths of names
+     * and values within them are kept in 32 bits, to keep headers small.
+     */
+    constexpr size_t MaxStorageSize = std::numeric_limits<uint32_t>::max();
+
+    /**
+     * This function compares two header names, given along with their
+     * case-insensitive hashes and well-known header identifiers, which
+     * settle the comparison whenever either name is well-known.
+     *
+     * @param[in] lhsId
+     *      This is the well-known header identifier of the first name.
      *
+     * @param[in] lhsHash
+     *      This is the case-insensitive hash of the first name.
+     *
+     * @param[in] lhs
+     *      This is the first header name to compare.
+     *
+     * @param[in] rhsId
+     *      This is the well-known header identifier of the second name.
+     *
+     * @param[in] rhsHash
+     *      This is the case-insensitive hash of the second name.
+     *
+     * @param[in] rhs
+     *      This is the second header name to compare.
+     *
+     * @return
+     *      returns an indication of whether or not the header names
+     *      are equivalent (case-insensitive).
      */
-    std::string StripMarginWhitespace(const std::string& s)
+    bool NamesMatch(MessageHeaders::WellKnownHeader lhsId, uint32_t lhsHash, std::string_view lhs,
+                    MessageHeaders::WellKnownHeader rhsId, uint32_t rhsHash, std::string_view rhs)
     {
-        const auto marginLeft = s.find_first_not_of(WSP);
-        const auto marginRight = s.find_last_not_of(WSP);
-        if (marginLeft == std::string::npos)
+        if ((lhsId != MessageHeaders::WellKnownHeader::Unknown) ||
+            (rhsId != MessageHeaders::WellKnownHeader::Unknown))
         {
-            return "";
+            return (lhsId == rhsId);
         }
-        else
+        return (lhsHash == rhsHash) &&
+               MessageHeaders::MessageHeaders::HeaderName::Equivalent(lhs, rhs);
+    }
+
+    /**
+     * This is the separator placed between the name and value of
+     * each header line generated.
+     */
+    constexpr std::string_view NameValueSeparator = ": ";
+
+    /**
+     * This receives the raw headers generated, only counting
+     * their characters, to find out how many there will be.
+     */
+    struct SizeSink
+    {
+        /**
+         * This is the number of characters received so far.
+         */
+        size_t size = 0;
+
+        /**
+         * This method receives the next part of the raw headers.
+         *
+         * @param[in] part
+         *      This is the next part of the raw headers.
+         */
+        void Append(std::string_view part) { size += part.length(); }
+    };
+
+    /**
+     * This receives the raw headers generated, copying them into a
+     * buffer known to be large enough to hold them.
+     */
+    struct BufferSink
+    {
+        /**
+         * This points to where the next character received is copied.
+         */
+        char* next;
+
+        /**
+         * This method receives the next part of the raw headers.
+         *
+         * @param[in] part
+         *      This is the next part of the raw headers.
+         */
+        void Append(std::string_view part)
         {
-            return s.substr(marginLeft, marginRight - marginLeft + 1);
+            if (!part.empty())
+            {
+                (void)memcpy(next, part.data(), part.length());
+                next += part.length();
+            }
         }
-    }
+    };
+
+    /**
+     * This is the string placed at the beginning of each line after
+     * the first, when a header line is folded.
+     */
+    constexpr std::string_view Continuator = " ";
+
+    /**
+     * This receives the raw headers generated, storing a view of each
+     * part, so that they can be gathered up later without first being
+     * copied into a single string.
+     */
+    struct SpanSink
+    {
+        /**
+         * This is where to store the views of the parts received.
+         */
+        std::vector<std::string_view>& spans;
+
+        /**
+         * This method receives the next part of the raw headers.
+         *
+         * @param[in] part
+         *      This is the next part of the raw headers.
+         */
+        void Append(std::string_view part)
+        {
+            if (!part.empty())
+            {
+                spans.push_back(part);
+            }
+        }
+    };
+
+    /**
+     * This represents a single header line to generate, made up of
+     * the header name, the separator, the header value, and the line
+     * terminator, without copying any of them into a single string.
+     */
+    struct HeaderLine
+    {
+        /**
+         * These are the parts of the line, in order.
+         */
+        std::string_view fragments[4];
+
+        /**
+         * This is the total number of characters in the line.
+         */
+        size_t length;
+
+        /**
+         * This constructs the line for the header with the given
+         * name and value.
+         *
+         * @param[in] name
+         *      This is the name of the header.
+         *
+         * @param[in] value
+         *      This is the value of the header.
+         */
+        HeaderLine(std::string_view name, std::string_view value) :
+            fragments{name, NameValueSeparator, value, CRLF},
+            length(name.length() + NameValueSeparator.length() + value.length() + CRLF.length())
+        {
+        }
+
+        /**
+         * This method returns the character at the given offset
+         * into the line.
+         *
+         * @param[in] offset
+         *      This is the offset of the character to return.
+         *
+         * @return
+         *      The character at the given offset into the line is returned.
+         */
+        char At(size_t offset) const
+        {
+            for (const auto& fragment : fragments)
+            {
+                if (offset < fragment.length())
+                {
+                    return fragment[offset];
+                }
+                offset -= fragment.length();
+            }
+            return '\0';
+        }
+
+        /**
+         * This method passes the whole line to the given sink,
+         * one fragment at a time.
+         *
+         * @param[in] sink
+         *      This is where to pass the line.
+         */
+        template <typename Sink> void Emit(Sink& sink) const
+        {
+            for (const auto& fragment : fragments)
+            {
+                sink.Append(fragment);
+            }
+        }
+
+        /**
+         * This method passes the given part of the line to the given sink,
+         * one fragment at a time.
+         *
+         * @param[in] begin
+         *      This is the offset of the first character of the part.
+         *
+         * @param[in] end
+         *      This is the offset just past the last character of the part.
+         *
+         * @param[in] sink
+         *      This is where to pass the part of the line.
+         */
+        template <typename Sink> void Emit(size_t begin, size_t end, Sink& sink) const
+        {
+            size_t fragmentOffset = 0;
+            for (const auto& fragment : fragments)
+            {
+                const auto fragmentEnd = fragmentOffset + fragment.length();
+                if ((begin < fragmentEnd) && (end > fragmentOffset))
+                {
+                    const auto first = std::max(begin, fragmentOffset) - fragmentOffset;
+                    const auto last = std::min(end, fragmentEnd) - fragmentOffset;
+                    sink.Append(fragment.substr(first, last - first));
+                }
+                fragmentOffset = fragmentEnd;
+            }
+        }
+    };
 
     /**
-     * This is the type of function that is used as the strategy to
-     * determine where to break a long line into two smaller lines.
+     * This function finds where to break the given header line into
+     * lines no longer than the given limit, calling the given function
+     * with the range of each part found.  A part is broken at the last
+     * whitespace that fits, except for the first whitespace in the line,
+     * normally the one right after the header name.  The whitespace at
+     * the break is replaced by the continuator when the part that
+     * follows is generated.
      *
-     * @param[in] s
-     *      This is the string which we are considering breaking.
+     * @param[in] line
+     *      This is the header line to fold.
      *
-     * @param[in] startOffset
-     *      This is the offset into the given string of the beginning of the part
-     *      that is under consideration for breaking.
+     * @param[in] limit
+     *      This is the maximum number of characters allowed per line,
+     *      including the line terminator.
      *
-     * @param[out] breakOffset
-     *      When the string is broken into two parts, this is the offset
-     *      in the original string marking the end of the first part.
+     * @param[in] onPart
+     *      This is the function to call with the offsets of the
+     *      beginning and end of each part found.
      *
-     * @param[out] nextOffset
-     *      When the string is broken into two parts, this is the offset
-     *      in the original string marking the beginning of the second part.
      * @return
-     *      returns an indication of whether or not the string can be broken.
+     *      An indication of whether or not the line could be folded
+     *      is returned.
      */
-    typedef std::function<bool(const std::string& s, size_t startOffset, size_t& breakOffset,
-                               size_t& nextOffset)>
-        StringBreakingStrategy;
+    template <typename PartVisitor>
+    bool FindFoldBreaks(const HeaderLine& line, size_t limit, PartVisitor onPart)
+    {
+        const auto isWhitespace = [](char c) { return (c == ' ') || (c == '\t'); };
+        size_t firstWhitespace = line.length;
+        if (line.length > limit)
+        {
+            firstWhitespace = 0;
+            while ((firstWhitespace < line.length) && !isWhitespace(line.At(firstWhitespace)))
+            {
+                ++firstWhitespace;
+            }
+        }
+        size_t partStart = 0;
+        while (partStart < line.length)
+        {
+            size_t breakOffset = line.length;
+            if (line.length - partStart > limit)
+            {
+                // Leave room for the line terminator, and for the
+                // continuator on every line after the first.
+                const size_t reservedCharacters = ((partStart == 0) ? 2 : 3);
+                breakOffset = partStart;
+                if (limit > reservedCharacters)
+                {
+                    for (auto candidate = partStart + limit - reservedCharacters;
+                         candidate > partStart; --candidate)
+                    {
+                        if ((candidate != firstWhitespace) && isWhitespace(line.At(candidate)))
+                        {
+                            breakOffset = candidate;
+                            break;
+                        }
+                    }
+                }
+                if (breakOffset == partStart)
+                {
+                    return false;
+                }
+            }
+            onPart(partStart, breakOffset);
+            partStart = breakOffset + 1;
+        }
+        return true;
+    }
 
     /**
-     * This method breaks up the given input line into multiple output lines,
-     * as needed, tp ensure that no output line is longer than the given
-     * line limit, including line terminators.
+     * This function passes the given header line to the given sink,
+     * folded as needed to keep each line no longer than the given limit.
+     * If the line can't be folded, nothing is passed to the sink.
      *
      * @param[in] line
-     *      This is the line to fold if necessary.
-     * @param[in] terminator
-     *      This is the character sequence that separates lines.
-     * @param[in] continuator
-     *      This is the string to preprend to each output
-     *      line after the first.
+     *      This is the header line to generate.
+     *
      * @param[in] limit
-     *      This is the maximum number of characters allowed par line,
+     *      This is the maximum number of characters allowed per line,
      *      including the line terminator.
-     * @param[in] lineFoldingStrategy
-     *      This is the function to call that will determine
-     *      where (if anywhere) to break up the input line.
-     * @return
-     *      The output lines are returned.
      *
-     * @retval
-     *      This is returned if the line could not be folded into
-     *      multiple lines.
+     * @param[in] sink
+     *      This is where to pass the folded header line.
      */
-    std::vector<std::string> SplitLine(const std::string& inputLline, const std::string& terminator,
-                                       const std::string& continuator,
-                                       StringBreakingStrategy lineFoldingStrategy)
+    template <typename Sink> void EmitFoldedHeaderLine(const HeaderLine& line, size_t limit,
+                                                       Sink& sink)
     {
-        std::vector<std::string> output;
-        size_t breakOffset = 0;
-        size_t currentLineStart = 0;
-        while (currentLineStart < inputLline.length())
+        if (line.length <= limit)
         {
-            size_t nextLineStart;
-            if (!lineFoldingStrategy(inputLline, currentLineStart, breakOffset, nextLineStart))
-            {
-                return {};
-            }
-            std::string part;
-            if (currentLineStart != 0)
+            line.Emit(sink);
+            return;
+        }
+        if (!FindFoldBreaks(line, limit, [](size_t, size_t) {}))
+        {
+            return;
+        }
+        if constexpr (!std::is_same_v<Sink, SizeSink>)
+        {
+            MESSAGE_HEADERS_COUNT(headerLinesFolded, 1);
+        }
+        (void)FindFoldBreaks(line, limit, [&line, &sink](size_t partStart, size_t breakOffset) {
+            if (partStart != 0)
             {
-                part = continuator;
+                sink.Append(Continuator);
             }
-            part += inputLline.substr(currentLineStart, breakOffset - currentLineStart);
-            if ((part.length() < terminator.length()) ||
-                (part.substr(part.length() - terminator.length()) != terminator))
+            line.Emit(partStart, breakOffset, sink);
+            if ((breakOffset - partStart < CRLF.length()) ||
+                (line.At(breakOffset - 2) != '\r') || (line.At(breakOffset - 1) != '\n'))
             {
-                part += terminator;
+                sink.Append(CRLF);
             }
-            output.push_back(part);
-            currentLineStart = breakOffset + 1;
+        });
+    }
+
+    /**
+     * This function checks whether or not the given header was found
+     * on a line exactly as it would be generated, with a single space
+     * after the colon, no other margin whitespace, and no folding.
+     *
+     * @param[in] rawMessage
+     *      This is the raw message in which the header was found.
+     *
+     * @param[in] header
+     *      This describes where the header is in the raw message.
+     *
+     * @return
+     *      An indication of whether or not the line of the header
+     *      is as it would be generated is returned.
+     */
+    bool IsGeneratedLine(std::string_view rawMessage,
+                         const MessageHeaders::HeaderScanner::ScannedHeader& header)
+    {
+        const auto isWhitespace = [](char c) { return (c == ' ') || (c == '\t'); };
+        if (header.folded || (header.nameOffset + header.nameLength + 1 != header.valueOffset)
+            || (header.valueEnd == header.valueOffset) || (rawMessage[header.valueOffset] != ' '))
+        {
+            return false;
         }
-        return output;
+        return (header.valueEnd - header.valueOffset == 1)
+               || (!isWhitespace(rawMessage[header.valueOffset + 1])
+                   && !isWhitespace(rawMessage[header.valueEnd - 1]));
     }
 }  // namespace
 
@@ -138,104 +436,1329 @@ namespace MessageHeaders
 
     void PrintTo(const MessageHeaders::HeaderName& name, std::ostream* os) { *os << name; }
 
-    MessageHeaders::HeaderName::HeaderName(const std::string& s) : name_(s) {}
+    MessageHeaders::HeaderName::HeaderName() : hash_(Hash({})), id_(WellKnownHeader::Unknown) {}
+
+    MessageHeaders::HeaderName::HeaderName(const std::string& s) :
+        name_(s),
+        hash_(Hash(s)),
+        id_(FindWellKnownHeader(s, hash_))
+    {
+    }
+
+    MessageHeaders::HeaderName::HeaderName(std::string&& s) :
+        name_(std::move(s)),
+        hash_(Hash(name_)),
+        id_(FindWellKnownHeader(name_, hash_))
+    {
+    }
+
+    MessageHeaders::HeaderName::HeaderName(std::string_view s) :
+        name_(s),
+        hash_(Hash(s)),
+        id_(FindWellKnownHeader(s, hash_))
+    {
+    }
 
     MessageHeaders::HeaderName& MessageHeaders::HeaderName::operator=(const std::string& s)
     {
         name_ = s;
+        hash_ = Hash(s);
+        id_ = FindWellKnownHeader(s, hash_);
         return *this;
     }
 
     bool MessageHeaders::HeaderName::operator==(const HeaderName& rhs) const
     {
-        if (name_.length() != rhs.name_.length())
+        return NamesMatch(id_, hash_, name_, rhs.id_, rhs.hash_, rhs.name_);
+    }
+
+    bool MessageHeaders::HeaderName::Equivalent(std::string_view lhs, std::string_view rhs)
+    {
+        if (lhs.length() != rhs.length())
         {
             return false;
         };
-        for (size_t i = 0; i < name_.length(); ++i)
+        for (size_t i = 0; i < lhs.length(); ++i)
+        {
+            if ((tolower(lhs[i])) != (tolower(rhs[i])))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint32_t MessageHeaders::HeaderName::GetHash() const { return hash_; }
+
+    uint32_t MessageHeaders::HeaderName::Hash(std::string_view name)
+    {
+        return HashHeaderName(name);
+    }
+
+    WellKnownHeader MessageHeaders::HeaderName::GetId() const { return id_; }
+
+    // cast operator
+    MessageHeaders::HeaderName::operator const std::string&() const { return name_; }
+    /**
+     * This contains the private properties of Uri instance.
+     */
+
+    MessageHeaders::Header::Header(const HeaderName& newName, const HeaderValue& newValue) :
+        name(newName), value(newValue)
+    {
+    }
+
+    MessageHeaders::Header::Header(HeaderName&& newName, HeaderValue&& newValue) noexcept :
+        name(std::move(newName)), value(std::move(newValue))
+    {
+    }
+
+    struct MessageHeaders::Impl
+    {
+        /**
+         * This is how a single header of the internet message is stored.
+         * Rather than holding strings of its own, it refers to where its
+         * name and value are kept, which is either the buffer of names and
+         * values set or parsed, or the copy of the raw header block it was
+         * parsed from, so that all the headers are packed together and can
+         * be walked without chasing pointers.
+         */
+        struct Record
+        {
+            /**
+             * This is the offset of the name of the header.
+             */
+            uint32_t nameOffset = 0;
+
+            /**
+             * This is the number of characters in the name of the header.
+             */
+            uint32_t nameLength = 0;
+
+            /**
+             * This is the offset of the value of the header.  If the value
+             * is lazy, this is the offset of the first character after
+             * the colon, and the value is still to be unfolded and stripped.
+             */
+            uint32_t valueOffset = 0;
+
+            /**
+             * This is the number of characters in the value of the header.
+             * If the value is lazy, this is the number of characters from
+             * the colon to the line terminator of the last line of the header.
+             */
+            uint32_t valueLength = 0;
+
+            /**
+             * This is the case-insensitive hash of the header name.
+             */
+            uint32_t nameHash = 0;
+
+            /**
+             * This is the identifier of the header name, if it's one
+             * of the well-known header names.
+             */
+            WellKnownHeader nameId = WellKnownHeader::Unknown;
+
+            /**
+             * This indicates whether or not the name is kept in the copy
+             * of the raw header block, rather than the buffer of names
+             * and values.
+             */
+            bool nameInRawHeaders = false;
+
+            /**
+             * This indicates whether or not the value is kept in the copy
+             * of the raw header block, rather than the buffer of names
+             * and values.
+             */
+            bool valueInRawHeaders = false;
+
+            /**
+             * This indicates whether or not the value has yet to be
+             * unfolded and stripped.
+             */
+            bool lazy = false;
+
+            /**
+             * This indicates whether or not the raw value continues
+             * on one or more folded lines.
+             */
+            bool rawValueFolded = false;
+
+            /**
+             * This indicates whether or not the whole line of the header,
+             * from its name to its line terminator, is kept in one piece,
+             * exactly as it's generated, so that it can be copied as it is.
+             */
+            bool rawLine = false;
+        };
+
+        /**
+         * This is a single slot of the index used to look up headers
+         * by name.  Positions are stored plus one, so that zero can
+         * mark an empty slot.
+         */
+        struct IndexSlot
+        {
+            /**
+             * This is one more than the position of the first header
+             * with the name held by the slot, or zero if the slot is empty.
+             */
+            uint32_t first = 0;
+
+            /**
+             * This is one more than the position of the last header
+             * with the name held by the slot.
+             */
+            uint32_t last = 0;
+        };
+
+        /**
+         * This holds the headers of the internet message, along with the
+         * index used to look them up.  Clones of the headers share it,
+         * and it's only copied once one of them is modified.  While it's
+         * shared, it's never modified, not even by const methods, since
+         * cloning first does any work that they could put off.
+         */
+        struct Storage
         {
-            if ((tolower(name_[i])) != (tolower(rhs.name_[i])))
+            /**
+             * These are the headers of the internet message.
+             */
+            std::pmr::vector<Record> headers;
+
+            /**
+             * This holds the names and values of the headers which aren't
+             * kept in the copies of the raw header blocks, one after another.
+             */
+            std::pmr::string strings;
+
+            /**
+             * This is the number of characters of strings which no longer
+             * belong to any header, because the headers were removed
+             * or given new values.
+             */
+            size_t unusedStrings = 0;
+
+            /**
+             * This is an open-addressing hash table, keyed by header name,
+             * which is built the first time it's needed to look up a header,
+             * and then kept up to date as headers are added.  Its size is
+             * always a power of two.
+             */
+            std::pmr::vector<IndexSlot> indexSlots;
+
+            /**
+             * This holds, for each header, one more than the position of the
+             * next header with the same name, or zero if there isn't one.
+             */
+            std::pmr::vector<uint32_t> nextWithSameName;
+
+            /**
+             * This indicates whether or not the index reflects the
+             * current headers of the internet message.
+             */
+            bool indexValid = false;
+
+            /**
+             * This indicates whether or not any of the headers might
+             * still have a lazy value.
+             */
+            bool hasLazyValues = false;
+
+            /**
+             * This holds copies of the header blocks parsed with lazy
+             * values, in which the names and values of those headers
+             * are kept.  Lazy values are unfolded in place, which never
+             * makes them longer.
+             */
+            std::pmr::string rawHeaders;
+
+            /**
+             * This is the number of characters in the generated lines of the
+             * headers, not counting those whose lazy values haven't been
+             * unfolded yet, nor any folding.
+             */
+            size_t linesLength = 0;
+
+            /**
+             * This is the number of headers whose lines aren't counted
+             * in linesLength, since their lazy values haven't been
+             * unfolded yet.
+             */
+            size_t unmeasuredHeaders = 0;
+
+            /**
+             * This constructs empty storage.
+             *
+             * @param[in] resource
+             *      This is the memory resource from which to allocate
+             *      the headers.
+             */
+            explicit Storage(std::pmr::memory_resource* resource) :
+                headers(resource),
+                strings(resource),
+                indexSlots(resource),
+                nextWithSameName(resource),
+                rawHeaders(resource)
+            {
+            }
+
+            /**
+             * This constructs a copy of the given storage.
+             *
+             * @param[in] other
+             *      This is the storage to copy.
+             *
+             * @param[in] resource
+             *      This is the memory resource from which to allocate
+             *      the copy.
+             */
+            Storage(const Storage& other, std::pmr::memory_resource* resource) :
+                headers(other.headers, resource),
+                strings(other.strings, resource),
+                unusedStrings(other.unusedStrings),
+                indexSlots(other.indexSlots, resource),
+                nextWithSameName(other.nextWithSameName, resource),
+                indexValid(other.indexValid),
+                hasLazyValues(other.hasLazyValues),
+                rawHeaders(other.rawHeaders, resource),
+                linesLength(other.linesLength),
+                unmeasuredHeaders(other.unmeasuredHeaders)
+            {
+            }
+
+            /**
+             * This function removes all the headers, keeping the memory
+             * allocated for them.
+             */
+            void Clear()
+            {
+                headers.clear();
+                strings.clear();
+                unusedStrings = 0;
+                nextWithSameName.clear();
+                indexValid = false;
+                hasLazyValues = false;
+                rawHeaders.clear();
+                linesLength = 0;
+                unmeasuredHeaders = 0;
+            }
+
+            /**
+             * This function returns the name of the given header.
+             *
+             * @param[in] header
+             *      This is the header whose name to return.
+             *
+             * @return
+             *      The name of the header is returned.
+             */
+            std::string_view Name(const Record& header) const
+            {
+                const auto& buffer = header.nameInRawHeaders ? rawHeaders : strings;
+                return std::string_view(buffer.data() + header.nameOffset, header.nameLength);
+            }
+
+            /**
+             * This function returns the value of the given header,
+             * which must not be lazy.
+             *
+             * @param[in] header
+             *      This is the header whose value to return.
+             *
+             * @return
+             *      The value of the header is returned.
+             */
+            std::string_view StoredValue(const Record& header) const
+            {
+                const auto& buffer = header.valueInRawHeaders ? rawHeaders : strings;
+                return std::string_view(buffer.data() + header.valueOffset, header.valueLength);
+            }
+
+            /**
+             * This function returns the number of characters in the
+             * generated line of the given header, which must not be lazy
+             * unless its line is kept in one piece.
+             *
+             * @param[in] header
+             *      This is the header whose line length to return.
+             *
+             * @return
+             *      The number of characters in the line of the header,
+             *      including its line terminator, is returned.
+             */
+            static size_t LineLength(const Record& header)
+            {
+                if (header.lazy)
+                {
+                    // The value still begins with the space after the colon.
+                    return header.valueOffset + header.valueLength + CRLF.length()
+                           - header.nameOffset;
+                }
+                return header.nameLength + NameValueSeparator.length() + header.valueLength
+                       + CRLF.length();
+            }
+
+            /**
+             * This function returns the line of the given header,
+             * which must be kept in one piece.
+             *
+             * @param[in] header
+             *      This is the header whose line to return.
+             *
+             * @return
+             *      The line of the header, including its line terminator,
+             *      is returned.
+             */
+            std::string_view Line(const Record& header) const
+            {
+                const auto& buffer = header.nameInRawHeaders ? rawHeaders : strings;
+                return std::string_view(buffer.data() + header.nameOffset, LineLength(header));
+            }
+
+            /**
+             * This function counts the line of the given header, which has
+             * just been added or changed, towards the length of all lines.
+             *
+             * @param[in] header
+             *      This is the header whose line to count.
+             */
+            void CountLine(const Record& header)
+            {
+                if (header.lazy && !header.rawLine)
+                {
+                    ++unmeasuredHeaders;
+                }
+                else
+                {
+                    linesLength += LineLength(header);
+                }
+            }
+
+            /**
+             * This function stops counting the line of the given header,
+             * which is about to be removed or changed, towards the length
+             * of all lines.
+             *
+             * @param[in] header
+             *      This is the header whose line to stop counting.
+             */
+            void UncountLine(const Record& header)
+            {
+                if (header.lazy && !header.rawLine)
+                {
+                    --unmeasuredHeaders;
+                }
+                else
+                {
+                    linesLength -= LineLength(header);
+                }
+            }
+
+            /**
+             * This function checks if the given header has the given name.
+             *
+             * @param[in] header
+             *      This is the header to check.
+             *
+             * @param[in] headerName
+             *      This is the header name to compare with.
+             *
+             * @return
+             *      returns an indication of whether or not the header
+             *      has the given name (case-insensitive).
+             */
+            bool HasName(const Record& header, const HeaderName& headerName) const
+            {
+                return NamesMatch(header.nameId, header.nameHash, Name(header),
+                                  headerName.GetId(), headerName.GetHash(),
+                                  (const std::string&)headerName);
+            }
+
+            /**
+             * This function checks whether or not the given number of
+             * characters can be added to the buffer of names and values
+             * without the offsets and lengths of headers overflowing.
+             *
+             * @param[in] length
+             *      This is the number of characters to add.
+             *
+             * @return
+             *      An indication of whether or not the characters fit
+             *      is returned.
+             */
+            bool HasRoom(size_t length) const
+            {
+                return (length <= MaxStorageSize - strings.size());
+            }
+
+            /**
+             * This function makes sure the given number of characters can
+             * be added to the buffer of names and values, before anything
+             * is changed, failing the same way adding them to a string
+             * longer than it may grow would.
+             *
+             * @param[in] length
+             *      This is the number of characters to add.
+             */
+            void CheckRoom(size_t length) const
+            {
+                if (!HasRoom(length))
+                {
+                    throw std::length_error("MessageHeaders: header storage is full");
+                }
+            }
+
+            /**
+             * This function adds the given string at the end of the
+             * buffer of names and values.
+             *
+             * @param[in] s
+             *      This is the string to add.
+             *
+             * @return
+             *      The offset of the string in the buffer is returned.
+             */
+            uint32_t Keep(std::string_view s)
+            {
+                const auto offset = (uint32_t)strings.size();
+                strings.append(s);
+                return offset;
+            }
+
+            /**
+             * This function gives the given header the given value.
+             *
+             * @param[in,out] header
+             *      This is the header to change.
+             *
+             * @param[in] value
+             *      This is the new value of the header.
+             */
+            void SetValue(Record& header, std::string_view value)
+            {
+                const auto inPlace =
+                    !header.valueInRawHeaders && (value.length() <= header.valueLength);
+                const auto lineLength = header.nameLength + NameValueSeparator.length()
+                                        + value.length() + CRLF.length();
+                if (!inPlace)
+                {
+                    CheckRoom(lineLength);
+                }
+                UncountLine(header);
+                if (inPlace)
+                {
+                    // The new value fits where the old one was, but only
+                    // leaves the line in one piece if it's just as long.
+                    (void)value.copy(&strings[header.valueOffset], value.length());
+                    unusedStrings += header.valueLength - value.length();
+                    if (header.rawLine && (value.length() < header.valueLength))
+                    {
+                        unusedStrings += NameValueSeparator.length() + CRLF.length();
+                        header.rawLine = false;
+                    }
+                }
+                else
+                {
+                    // Keep the whole line again, so that it's still in one
+                    // piece.  Making room first leaves the name where it is
+                    // while it's copied, in case it's in the same buffer.
+                    ReleaseHeader(header);
+                    strings.reserve(strings.size() + lineLength);
+                    const auto& nameBuffer = header.nameInRawHeaders ? rawHeaders : strings;
+                    const auto nameOffset = header.nameOffset;
+                    header.nameOffset = (uint32_t)strings.size();
+                    strings.append(nameBuffer.data() + nameOffset, header.nameLength);
+                    header.nameInRawHeaders = false;
+                    (void)Keep(NameValueSeparator);
+                    header.valueOffset = Keep(value);
+                    header.valueInRawHeaders = false;
+                    (void)Keep(CRLF);
+                    header.rawLine = true;
+                }
+                header.valueLength = (uint32_t)value.length();
+                header.lazy = false;
+                CountLine(header);
+            }
+
+            /**
+             * This function notes that the characters of a header name
+             * or value no longer belong to any header.
+             *
+             * @param[in] inRawHeaders
+             *      This indicates whether or not the characters are kept
+             *      in the copy of the raw header block, which isn't reused.
+             *
+             * @param[in] length
+             *      This is the number of characters released.
+             */
+            void Release(bool inRawHeaders, size_t length)
+            {
+                if (!inRawHeaders)
+                {
+                    unusedStrings += length;
+                }
+            }
+
+            /**
+             * This function notes that the characters of the name and
+             * value of the given header no longer belong to it.
+             *
+             * @param[in] header
+             *      This is the header whose characters are released.
+             */
+            void ReleaseHeader(const Record& header)
+            {
+                if (header.rawLine)
+                {
+                    Release(header.nameInRawHeaders, LineLength(header));
+                }
+                else
+                {
+                    Release(header.nameInRawHeaders, header.nameLength);
+                    Release(header.valueInRawHeaders, header.valueLength);
+                }
+            }
+
+            /**
+             * This function removes, from the given position onwards, the
+             * headers for which the given predicate holds, moving each header
+             * kept straight to where it ends up.
+             *
+             * @param[in] position
+             *      This is the position of the first header to consider.
+             *
+             * @param[in] remove
+             *      This is called with each header, and returns whether
+             *      or not to remove it.
+             */
+            template <typename Predicate> void RemoveWhere(size_t position, Predicate remove)
+            {
+                auto kept = position;
+                for (auto i = position; i < headers.size(); ++i)
+                {
+                    auto& header = headers[i];
+                    if (remove(header))
+                    {
+                        UncountLine(header);
+                        ReleaseHeader(header);
+                        continue;
+                    }
+                    if (kept != i)
+                    {
+                        headers[kept] = header;
+                    }
+                    ++kept;
+                }
+                headers.erase(headers.begin() + kept, headers.end());
+                indexValid = false;
+            }
+
+            /**
+             * This function rebuilds the buffer of names and values without
+             * the characters which no longer belong to any header, once
+             * they make up most of it.
+             */
+            void Compact()
+            {
+                if ((unusedStrings < CompactionThreshold) || (unusedStrings * 2 <= strings.size()))
+                {
+                    return;
+                }
+                std::pmr::string compacted(strings.get_allocator());
+                compacted.reserve(strings.size() - unusedStrings);
+                for (auto& header : headers)
+                {
+                    if (header.rawLine && !header.nameInRawHeaders)
+                    {
+                        const auto offset = (uint32_t)compacted.size();
+                        compacted.append(strings, header.nameOffset, LineLength(header));
+                        header.valueOffset = offset + (header.valueOffset - header.nameOffset);
+                        header.nameOffset = offset;
+                        continue;
+                    }
+                    if (!header.nameInRawHeaders)
+                    {
+                        const auto offset = (uint32_t)compacted.size();
+                        compacted.append(strings, header.nameOffset, header.nameLength);
+                        header.nameOffset = offset;
+                    }
+                    if (!header.valueInRawHeaders)
+                    {
+                        const auto offset = (uint32_t)compacted.size();
+                        compacted.append(strings, header.valueOffset, header.valueLength);
+                        header.valueOffset = offset;
+                    }
+                }
+                strings.swap(compacted);
+                unusedStrings = 0;
+            }
+        };
+
+        /**
+         * This is the memory resource from which the headers
+         * are allocated.
+         */
+        std::pmr::memory_resource* resource;
+
+        /**
+         * This holds the headers of the internet message, and may be
+         * shared with clones.
+         */
+        std::shared_ptr<Storage> storage;
+
+        /**
+         * This is the maximum number of characters, including
+         * the 2-characters CRLF line terminator, that should
+         * be allowed for a single header line.
+         */
+        size_t lineLengthLimit = 0;
+
+        /**
+         * this indicates whether or not zall validiy checks
+         * have passed for the headers
+         */
+        bool valid = true;
+
+        /**
+         * This is used to find the headers in raw messages,
+         * remembering where it left off when the raw message
+         * turns out to be incomplete.
+         */
+        HeaderScanner scanner;
+
+        /**
+         * This is the number of headers that were stored before the
+         * current incremental parse began.
+         */
+        size_t headersBeforeParse = 0;
+
+        /**
+         * This is used to hold each header value as it's unfolded,
+         * so that its capacity can be reused for the next one.
+         */
+        std::pmr::string unfoldedValue;
+
+        /**
+         * This is used to hold several header values as they're joined
+         * into one, so that its capacity can be reused for the next ones.
+         */
+        std::pmr::string joinedValue;
+
+        /**
+         * This indicates whether or not header values are left as they
+         * are in the raw message when parsing, and only unfolded and
+         * stripped the first time they're needed.
+         */
+        bool lazyValues = false;
+
+        /**
+         * This is the number of characters that were in the copies of
+         * the header blocks parsed before the current incremental parse
+         * began.
+         */
+        size_t rawHeadersBeforeParse = 0;
+
+        /**
+         * This is the constructor of the structure.
+         *
+         * @param[in] resource
+         *      This is the memory resource from which to allocate
+         *      the headers of the internet message.
+         */
+        explicit Impl(std::pmr::memory_resource* resource) :
+            resource(resource),
+            storage(std::allocate_shared<Storage>(
+                std::pmr::polymorphic_allocator<Storage>(resource), resource)),
+            unfoldedValue(resource),
+            joinedValue(resource)
+        {
+        }
+
+        /**
+         * This constructs a clone of the given private properties,
+         * sharing their storage.
+         *
+         * @param[in] other
+         *      These are the private properties to clone.
+         */
+        Impl(const Impl& other) :
+            resource(other.resource),
+            storage(other.storage),
+            lineLengthLimit(other.lineLengthLimit),
+            valid(other.valid),
+            scanner(other.scanner),
+            headersBeforeParse(other.headersBeforeParse),
+            unfoldedValue(resource),
+            joinedValue(resource),
+            lazyValues(other.lazyValues),
+            rawHeadersBeforeParse(other.rawHeadersBeforeParse)
+        {
+        }
+
+        /**
+         * This function makes sure the storage isn't shared with any
+         * clones, copying it if it is, so that it can be modified.
+         */
+        void Unshare()
+        {
+            if (storage.use_count() > 1)
+            {
+                storage = std::allocate_shared<Storage>(
+                    std::pmr::polymorphic_allocator<Storage>(resource), *storage, resource);
+            }
+        }
+
+        /**
+         * This function abandons the parse in progress, if any, dropping
+         * any headers that it stored, so that the next parse starts over.
+         */
+        void AbandonParse()
+        {
+            // Until the first line is consumed, nothing is stored, but
+            // the scanner still remembers the part of the line it scanned.
+            const auto consumed = scanner.GetOffset();
+            scanner.Reset();
+            if (consumed == 0)
+            {
+                return;
+            }
+            Unshare();
+            storage->RemoveWhere(headersBeforeParse, [](const Record&) { return true; });
+            storage->rawHeaders.resize(rawHeadersBeforeParse);
+        }
+
+        /**
+         * This function does all the work that const methods could put
+         * off until they're first called on the storage, taking every lazy
+         * header value and building the index if it's going to be used,
+         * so that the storage can then be shared without ever changing.
+         */
+        void Settle()
+        {
+            if (storage.use_count() > 1)
+            {
+                return;
+            }
+            if (storage->hasLazyValues)
+            {
+                for (size_t i = 0; i < storage->headers.size(); ++i)
+                {
+                    (void)Value(i);
+                }
+                storage->hasLazyValues = false;
+            }
+            if ((storage->headers.size() >= IndexThreshold) && !storage->indexValid)
+            {
+                BuildIndex();
+            }
+        }
+
+        /**
+         * This function adds the header at the given position
+         * to the index, which must have room for it.
+         *
+         * @param[in] position
+         *      This is the position of the header to add to the index.
+         */
+        void IndexHeader(size_t position)
+        {
+            const auto& header = storage->headers[position];
+            const auto mask = storage->indexSlots.size() - 1;
+            for (auto slotIndex = header.nameHash & mask;; slotIndex = (slotIndex + 1) & mask)
+            {
+                auto& slot = storage->indexSlots[slotIndex];
+                if (slot.first == 0)
+                {
+                    slot.first = slot.last = (uint32_t)(position + 1);
+                    return;
+                }
+                const auto& first = storage->headers[slot.first - 1];
+                if (NamesMatch(first.nameId, first.nameHash, storage->Name(first), header.nameId,
+                               header.nameHash, storage->Name(header)))
+                {
+                    storage->nextWithSameName[slot.last - 1] = (uint32_t)(position + 1);
+                    slot.last = (uint32_t)(position + 1);
+                    return;
+                }
+            }
+        }
+
+        /**
+         * This function builds the index from scratch, sized
+         * so that it's at most half full.
+         */
+        void BuildIndex()
+        {
+            size_t capacity = 16;
+            while (capacity < storage->headers.size() * 2)
+            {
+                capacity <<= 1;
+            }
+            storage->indexSlots.assign(capacity, IndexSlot());
+            storage->nextWithSameName.assign(storage->headers.size(), 0);
+            for (size_t i = 0; i < storage->headers.size(); ++i)
+            {
+                IndexHeader(i);
+            }
+            storage->indexValid = true;
+        }
+
+        /**
+         * This function returns a header with the given name,
+         * which has yet to be given a value.
+         *
+         * @param[in] name
+         *      This is the name of the header.
+         *
+         * @return
+         *      The header is returned.
+         */
+        static Record NewRecord(std::string_view name)
+        {
+            Record header;
+            header.nameLength = (uint32_t)name.length();
+            header.nameHash = HeaderName::Hash(name);
+            header.nameId = FindWellKnownHeader(name, header.nameHash);
+            return header;
+        }
+
+        /**
+         * This function adds the given header at the end of the headers,
+         * keeping the index up to date if it's been built.  The name
+         * of the header must already be stored.
+         *
+         * @param[in] header
+         *      This is the header to add.
+         */
+        void Append(const Record& header)
+        {
+            storage->headers.push_back(header);
+            storage->CountLine(header);
+            if (storage->indexValid)
+            {
+                if (storage->headers.size() * 2 > storage->indexSlots.size())
+                {
+                    BuildIndex();
+                }
+                else
+                {
+                    storage->nextWithSameName.push_back(0);
+                    IndexHeader(storage->headers.size() - 1);
+                }
+            }
+        }
+
+        /**
+         * This function adds a header at the end of the headers,
+         * storing its whole line in the buffer of names and values.
+         *
+         * @param[in] name
+         *      This is the name of the header to add.
+         *
+         * @param[in] value
+         *      This is the value of the header to add.
+         */
+        void Append(std::string_view name, std::string_view value)
+        {
+            storage->CheckRoom(name.length() + NameValueSeparator.length() + value.length()
+                               + CRLF.length());
+            auto header = NewRecord(name);
+            header.nameOffset = storage->Keep(name);
+            (void)storage->Keep(NameValueSeparator);
+            header.valueOffset = storage->Keep(value);
+            (void)storage->Keep(CRLF);
+            header.valueLength = (uint32_t)value.length();
+            header.rawLine = true;
+            Append(header);
+        }
+
+        /**
+         * This function checks whether or not the given header, scanned
+         * from the raw message being parsed, can be stored without the
+         * offsets and lengths of headers overflowing.
+         *
+         * @param[in] header
+         *      This is the header scanned.
+         *
+         * @param[in] name
+         *      This is the name under which the header would be stored.
+         *
+         * @return
+         *      An indication of whether or not the header fits is returned.
+         */
+        bool HasRoomFor(const HeaderScanner::ScannedHeader& header, std::string_view name) const
+        {
+            if (lazyValues)
+            {
+                return (header.valueEnd + CRLF.length() <= MaxStorageSize - rawHeadersBeforeParse)
+                       && storage->HasRoom(name.length());
+            }
+            return storage->HasRoom(name.length() + NameValueSeparator.length()
+                                    + (header.valueEnd - header.valueOffset) + CRLF.length());
+        }
+
+        /**
+         * This function ends the current parse, because the raw message
+         * can't be parsed any further.
+         *
+         * @return
+         *      The state to report for the parse is returned.
+         */
+        State FailParse()
+        {
+            valid = false;
+            scanner.Reset();
+            MESSAGE_HEADERS_COUNT(parseErrors, 1);
+            return State::Error;
+        }
+
+        /**
+         * This function copies the part of the given raw message consumed
+         * so far by the current incremental parse which hasn't already
+         * been copied, so that lazy header names and values can be taken
+         * from it once the raw message is gone.
+         *
+         * @param[in] rawMessage
+         *      This is the raw message being parsed.
+         *
+         * @param[in] consumed
+         *      This is the number of characters of the raw message
+         *      consumed so far.
+         */
+        void KeepRawHeaders(std::string_view rawMessage, size_t consumed)
+        {
+            const auto kept = storage->rawHeaders.size() - rawHeadersBeforeParse;
+            if (consumed > kept)
+            {
+                storage->rawHeaders.append(rawMessage.substr(kept, consumed - kept));
+            }
+        }
+
+        /**
+         * This function returns the value of the header at the given
+         * position, first unfolding and stripping it where it is in the
+         * copy of the raw header block it was parsed from, if it's lazy.
+         * Since this never moves any stored characters, values returned
+         * earlier remain valid.
+         *
+         * @param[in] position
+         *      This is the position of the header whose value to return.
+         *
+         * @return
+         *      The value of the header is returned.
+         */
+        std::string_view Value(size_t position)
+        {
+            auto& header = storage->headers[position];
+            if (header.lazy)
+            {
+                auto& rawHeaders = storage->rawHeaders;
+                HeaderScanner::ScannedHeader scanned;
+                scanned.valueOffset = header.valueOffset;
+                scanned.valueEnd = header.valueOffset + header.valueLength;
+                if (header.rawValueFolded)
+                {
+                    // Each fold becomes a single space, so the unfolded
+                    // value always fits where the raw value was.
+                    HeaderScanner::UnfoldValue(rawHeaders, scanned, unfoldedValue);
+                    (void)unfoldedValue.copy(&rawHeaders[header.valueOffset],
+                                             unfoldedValue.length());
+                    header.valueLength = (uint32_t)unfoldedValue.length();
+                }
+                else
+                {
+                    const auto value = HeaderScanner::GetValue(rawHeaders, scanned);
+                    if (!value.empty())
+                    {
+                        header.valueOffset = (uint32_t)(value.data() - rawHeaders.data());
+                    }
+                    header.valueLength = (uint32_t)value.length();
+                }
+                header.lazy = false;
+                if (!header.rawLine)
+                {
+                    --storage->unmeasuredHeaders;
+                    storage->CountLine(header);
+                }
+            }
+            return storage->StoredValue(header);
+        }
+
+        /**
+         * This is what a bulk edit leaves of all the headers
+         * with one of the names it changes.
+         */
+        struct EditOutcome
+        {
+            /**
+             * This is the name of the headers changed.
+             */
+            const HeaderName* name;
+
+            /**
+             * This is the value the headers are set to, or nullptr
+             * if they're removed.
+             */
+            const HeaderValue* value = nullptr;
+
+            /**
+             * This indicates whether or not a header with the name was
+             * removed, or was never there, before it was last set, so that
+             * it goes at the end of the headers rather than where it was.
+             */
+            bool appended = false;
+
+            /**
+             * This orders the headers that go at the end of the headers,
+             * which is the order in which they were set.
+             */
+            size_t appendOrder = 0;
+
+            /**
+             * This indicates whether or not the header set has already
+             * been kept where it was.
+             */
+            bool kept = false;
+        };
+
+        /**
+         * This function applies the given outcomes of a bulk edit,
+         * moving each header kept straight to where it ends up,
+         * and then adding the headers set at the end.
+         *
+         * @param[in,out] outcomes
+         *      These are the outcomes of the bulk edit, one for
+         *      each of the names it changes.
+         */
+        void ApplyEdits(std::vector<EditOutcome>& outcomes)
+        {
+            auto& stored = *storage;
+            const auto isRemoved = [&](Record& header)
+            {
+                auto outcome = outcomes.begin();
+                while ((outcome != outcomes.end()) && !stored.HasName(header, *outcome->name))
+                {
+                    ++outcome;
+                }
+                if (outcome == outcomes.end())
+                {
+                    return false;
+                }
+                if ((outcome->value == nullptr) || outcome->appended || outcome->kept)
+                {
+                    return true;
+                }
+                stored.SetValue(header, *outcome->value);
+                outcome->kept = true;
+                return false;
+            };
+            stored.RemoveWhere(0, isRemoved);
+            std::sort(outcomes.begin(), outcomes.end(),
+                      [](const EditOutcome& lhs, const EditOutcome& rhs)
+                      { return lhs.appendOrder < rhs.appendOrder; });
+            for (const auto& outcome : outcomes)
+            {
+                if ((outcome.value != nullptr) && outcome.appended)
+                {
+                    Append((const std::string&)*outcome.name, *outcome.value);
+                }
+            }
+            stored.Compact();
+        }
+
+        /**
+         * This function joins the given header values into one,
+         * separated by commas, storing it in joinedValue.
+         *
+         * @param[in] values
+         *      These are the header values to join.
+         */
+        void JoinValues(const std::vector<HeaderValue>& values)
+        {
+            size_t length = values.size() - 1;
+            for (const auto& value : values)
+            {
+                length += value.length();
+            }
+            joinedValue.clear();
+            joinedValue.reserve(length);
+            for (size_t i = 0; i < values.size(); ++i)
             {
-                return false;
+                if (i > 0)
+                {
+                    joinedValue += ',';
+                }
+                joinedValue += values[i];
             }
         }
-        return true;
-    }
-
-    auto MessageHeaders::HeaderName::begin() const { return name_.begin(); }
-
-    auto MessageHeaders::HeaderName::end() const { return name_.end(); }
-
-    // cast operator
-    MessageHeaders::HeaderName::operator const std::string&() const { return name_; }
-    /**
-     * This contains the private properties of Uri instance.
-     */
-
-    MessageHeaders::Header::Header(const HeaderName& newName, const HeaderValue& newValue) :
-        name(newName), value(newValue)
-    {
-    }
 
-    struct MessageHeaders::Impl
-    {
         /**
-         * These are the headers of the internet message.
-         */
-        Headers headers;
-        /**
-         * This is the maximum number of characters, including
-         * the 2-characters CRLF line terminator, that should
-         * be allowed for a single header line.
+         * This function returns the position of the first header
+         * with the given name.
+         *
+         * @param[in] name
+         *      This is the name of the header to find.
+         *
+         * @return
+         *      The position of the first header with the given name
+         *      is returned, or NotFound if there isn't one.
          */
-        size_t lineLengthLimit = 0;
+        size_t FindFirst(const HeaderName& name)
+        {
+            if (storage->headers.size() < IndexThreshold)
+            {
+                for (size_t i = 0; i < storage->headers.size(); ++i)
+                {
+                    if (storage->HasName(storage->headers[i], name))
+                    {
+                        return i;
+                    }
+                }
+                return NotFound;
+            }
+            if (!storage->indexValid)
+            {
+                BuildIndex();
+            }
+            const auto mask = storage->indexSlots.size() - 1;
+            for (auto slotIndex = name.GetHash() & mask;; slotIndex = (slotIndex + 1) & mask)
+            {
+                const auto& slot = storage->indexSlots[slotIndex];
+                if (slot.first == 0)
+                {
+                    return NotFound;
+                }
+                if (storage->HasName(storage->headers[slot.first - 1], name))
+                {
+                    return slot.first - 1;
+                }
+            }
+        }
 
         /**
-         * this indicates whether or not zall validiy checks
-         * have passed for the headers
+         * This function returns the position of the first header with
+         * the given name, on behalf of a method looking up headers,
+         * counting whether or not one is found.
+         *
+         * @param[in] name
+         *      This is the name of the header to find.
+         *
+         * @return
+         *      The position of the first header with the given name
+         *      is returned, or NotFound if there isn't one.
          */
-        bool valid = true;
+        size_t Lookup(const HeaderName& name)
+        {
+            const auto position = FindFirst(name);
+            if (position == NotFound)
+            {
+                MESSAGE_HEADERS_COUNT(lookupMisses, 1);
+            }
+            else
+            {
+                MESSAGE_HEADERS_COUNT(lookupHits, 1);
+            }
+            return position;
+        }
 
         /**
-         * This function returns a string splitting strategy
-         * function object which can be used once to foald a
-         * header line.
+         * This function returns the position of the next header
+         * with the given name, after the one at the given position.
+         *
+         * @param[in] name
+         *      This is the name of the header to find.
+         *
+         * @param[in] position
+         *      This is the position of a header with the given name.
          *
          * @return
-         *      A string splitting strategy function object
-         *      which can be used once to fold a header line
-         *      is returned.
+         *      The position of the next header with the given name
+         *      is returned, or NotFound if there isn't one.
          */
-        StringBreakingStrategy MakeHeaderLineFoldingStrategy()
+        size_t FindNext(const HeaderName& name, size_t position)
         {
-            auto firstPart = std::make_shared<bool>(true);
-            return [this, firstPart](const std::string& s, size_t startOffset, size_t& breakOffset,
-                                     size_t& nextOffset) {
-                if (s.length() - startOffset <= lineLengthLimit)
+            if (storage->indexValid)
+            {
+                const auto next = storage->nextWithSameName[position];
+                return (next == 0) ? NotFound : next - 1;
+            }
+            for (size_t i = position + 1; i < storage->headers.size(); ++i)
+            {
+                if (storage->HasName(storage->headers[i], name))
                 {
-                    breakOffset = nextOffset = s.length();
-                    return true;
+                    return i;
                 }
-                breakOffset = startOffset;
-                const auto reservedCharacters = 2 + (*firstPart ? 0 : 1);
-                for (size_t i = startOffset;
-                     i <= startOffset + lineLengthLimit - reservedCharacters; ++i)
+            }
+            return NotFound;
+        }
+
+        /**
+         * This function generates the raw headers, passing them on
+         * to the given sink one part at a time.
+         *
+         * @param[in] sink
+         *      This is where to pass the raw headers generated.
+         */
+        template <typename Sink> void EmitRawHeaders(Sink& sink)
+        {
+            // Lines kept in one piece, one after another, are passed on
+            // together, which for headers parsed and left alone is
+            // usually the whole header block.
+            std::string_view lines;
+            for (size_t i = 0; i < storage->headers.size(); ++i)
+            {
+                const auto& header = storage->headers[i];
+                if (header.rawLine)
                 {
-                    if ((s[i] == ' ') || (s[i] == '\t'))
+                    const auto line = storage->Line(header);
+                    if ((lineLengthLimit == 0) || (line.length() <= lineLengthLimit))
                     {
-                        if (*firstPart)
+                        if (lines.data() + lines.length() == line.data())
                         {
-                            *firstPart = false;
+                            lines = std::string_view(lines.data(), lines.length() + line.length());
                         }
                         else
                         {
-                            breakOffset = i;
+                            sink.Append(lines);
+                            lines = line;
                         }
+                        continue;
                     }
                 }
-                nextOffset = breakOffset + 1;
-                return (breakOffset != startOffset);
-            };
+                sink.Append(lines);
+                lines = {};
+                const auto value = Value(i);
+                const HeaderLine line(storage->Name(storage->headers[i]), value);
+                if (lineLengthLimit > 0)
+                {
+                    EmitFoldedHeaderLine(line, lineLengthLimit, sink);
+                }
+                else
+                {
+                    line.Emit(sink);
+                }
+            }
+            sink.Append(lines);
+            sink.Append(CRLF);
+        }
+
+        /**
+         * This function unfolds every lazy header value whose line
+         * isn't yet counted towards the length of all lines.
+         */
+        void MeasureLines()
+        {
+            for (size_t i = 0; (storage->unmeasuredHeaders > 0) && (i < storage->headers.size());
+                 ++i)
+            {
+                if (storage->headers[i].lazy)
+                {
+                    (void)Value(i);
+                }
+            }
         }
     };
 
@@ -244,159 +1767,186 @@ namespace MessageHeaders
     MessageHeaders::MessageHeaders(MessageHeaders&&) = default;
     MessageHeaders& MessageHeaders::operator=(MessageHeaders&&) = default;
 
-    MessageHeaders::MessageHeaders() : impl_(new Impl) {}
+    MessageHeaders::MessageHeaders() : impl_(new Impl(std::pmr::get_default_resource())) {}
+
+    MessageHeaders::MessageHeaders(std::pmr::memory_resource* resource) : impl_(new Impl(resource))
+    {
+    }
+
+    MessageHeaders::MessageHeaders(std::unique_ptr<Impl>&& impl) : impl_(std::move(impl)) {}
+
+    MessageHeaders MessageHeaders::Clone() const
+    {
+        impl_->Settle();
+        return MessageHeaders(std::unique_ptr<Impl>(new Impl(*impl_)));
+    }
+
+    auto MessageHeaders::ParseRawMessage(std::string_view rawMessage, size_t& bodyOffset) -> State
+    {
+        return ParseRawMessage<ConfiguredProfile>(rawMessage, bodyOffset);
+    }
 
-    auto MessageHeaders::ParseRawMessage(const std::string& rawMessage, size_t& bodyOffset) -> State
+    template <typename Profile>
+    auto MessageHeaders::ParseRawMessage(std::string_view rawMessage, size_t& bodyOffset) -> State
     {
-        bodyOffset = 0;
-        size_t offset = 0;
-        while (offset < rawMessage.length())
+        // If the raw message is shorter than what we already scanned, it
+        // can't be a continuation of the interrupted parse, so start over,
+        // dropping any headers that the interrupted parse stored.
+        if (rawMessage.length() < impl_->scanner.GetScannedLength())
+        {
+            impl_->AbandonParse();
+        }
+        impl_->Unshare();
+        auto& storage = *impl_->storage;
+        if (impl_->scanner.GetScannedLength() == 0)
+        {
+            impl_->headersBeforeParse = storage.headers.size();
+            impl_->rawHeadersBeforeParse = storage.rawHeaders.size();
+        }
+        impl_->scanner.SetLineLimit(impl_->lineLengthLimit);
+        HeaderScanner::ScannedHeader header;
+        for (;;)
         {
-            auto lineTerminator = rawMessage.find(CRLF, offset);
-            if (lineTerminator == std::string::npos)
+            switch (impl_->scanner.Next<Profile>(rawMessage, header))
+            {
+            case HeaderScanner::Result::Header:
             {
-                if (impl_->lineLengthLimit > 0)
+                if (!header.validName || !header.validValue)
                 {
-                    const auto unterminatedLineLength = rawMessage.length() - offset;
-                    if (unterminatedLineLength + 2 > impl_->lineLengthLimit)
+                    impl_->valid = false;
+                }
+                MESSAGE_HEADERS_COUNT(headersParsed, 1);
+                if (header.folded)
+                {
+                    MESSAGE_HEADERS_COUNT(foldedHeadersParsed, 1);
+                }
+                auto name = HeaderScanner::GetName(rawMessage, header);
+                bool nameExpanded = false;
+                if constexpr (Profile::compactNames)
+                {
+                    const auto id = FindCompactHeader(name);
+                    if (id != WellKnownHeader::Unknown)
                     {
-                        impl_->valid = false;
-                        return State::Error;
+                        name = GetWellKnownHeaderName(id);
+                        nameExpanded = true;
                     }
                 }
-                break;
-            }
-
-            if (impl_->lineLengthLimit > 0)
-            {
-                if (lineTerminator - offset + CRLF.length() > impl_->lineLengthLimit)
+                if (!impl_->HasRoomFor(header, name))
                 {
-                    impl_->valid = false;
-                    return State::Error;
+                    MESSAGE_HEADERS_COUNT(limitErrors, 1);
+                    return impl_->FailParse();
+                }
+                if (impl_->lazyValues)
+                {
+                    // Both the name and the value are left in the copy of
+                    // the raw header block, which must hold the header,
+                    // line terminator included, before it's added, so that
+                    // it can be indexed, and its line copied as it is.
+                    impl_->KeepRawHeaders(rawMessage, header.valueEnd + CRLF.length());
+                    auto record = Impl::NewRecord(name);
+                    if (nameExpanded)
+                    {
+                        record.nameOffset = storage.Keep(name);
+                    }
+                    else
+                    {
+                        record.nameOffset =
+                            (uint32_t)(impl_->rawHeadersBeforeParse + header.nameOffset);
+                        record.nameInRawHeaders = true;
+                    }
+                    record.valueOffset =
+                        (uint32_t)(impl_->rawHeadersBeforeParse + header.valueOffset);
+                    record.valueLength = (uint32_t)(header.valueEnd - header.valueOffset);
+                    record.valueInRawHeaders = true;
+                    record.lazy = true;
+                    record.rawValueFolded = header.folded;
+                    record.rawLine = !nameExpanded && IsGeneratedLine(rawMessage, header);
+                    impl_->Append(record);
+                    storage.hasLazyValues = true;
+                }
+                else if (header.folded)
+                {
+                    HeaderScanner::UnfoldValue(rawMessage, header, impl_->unfoldedValue);
+                    impl_->Append(name, impl_->unfoldedValue);
+                }
+                else
+                {
+                    impl_->Append(name, HeaderScanner::GetValue(rawMessage, header));
                 }
             }
-
-            if (lineTerminator == offset)
+            break;
+            case HeaderScanner::Result::End:
             {
-                offset += CRLF.length();
-                break;
+                bodyOffset = impl_->scanner.GetOffset();
+                impl_->scanner.Reset();
+                MESSAGE_HEADERS_COUNT(messagesParsed, 1);
+                return State::Complete;
             }
-
-            auto nameValueDelimiter = rawMessage.find(':', offset);
-            if (nameValueDelimiter == std::string::npos)
+            case HeaderScanner::Result::Incomplete:
             {
-                impl_->valid = false;
-                return State::Error;
+                bodyOffset = impl_->scanner.GetOffset();
+                MESSAGE_HEADERS_COUNT(incompleteParses, 1);
+                return State::Incomplete;
             }
-            HeaderName name;
-            HeaderValue value;
-            name = rawMessage.substr(offset, nameValueDelimiter - offset);
-            for (auto c : name)
+            case HeaderScanner::Result::Error:
+            default:
             {
-                if ((c < 33) || (c > 126))
-                {
-                    impl_->valid = false;
-                }
+                return impl_->FailParse();
             }
-            value = StripMarginWhitespace(
-                rawMessage.substr(nameValueDelimiter + 1, lineTerminator - nameValueDelimiter - 1));
-            // Look ahead in the raw message and perform
-            // line unfolding if we see any lines that begin with whitespace.
-            offset = lineTerminator + CRLF.length();
-            for (;;)
-            {
-                // Find where the next line begins.
-                const auto nextLineStart = lineTerminator + CRLF.length();
-                // Find where the next line ends.
-                auto nextLineTerminator = rawMessage.find(CRLF, nextLineStart);
-                if (nextLineTerminator == std::string::npos)
-                {
-                    bodyOffset = offset;
-                    return State::Incomplete;
-                    ;
-                }
-                auto nextLineLength = nextLineTerminator - nextLineStart;
-                // If the next line begins with whitespace, unfold the line
-                // - Append a single whitespace to the header value.
-                // - Remove leading whitespace from the next line.
-                // - Concatenate the rest of the next line to the header value.
-                // - Move to the line following the next line.
-                if ((nextLineLength > 2) &&
-                    (WSP.find(rawMessage[nextLineStart]) != std::string::npos))
-                {
-                    value += ' ';
-                    const auto firstNonWhiteSpaceInNextLine =
-                        rawMessage.find_first_not_of(WSP, nextLineStart);
-                    nextLineLength -= (firstNonWhiteSpaceInNextLine - nextLineStart);
-                    value += rawMessage.substr(firstNonWhiteSpaceInNextLine, nextLineLength);
-                    offset = nextLineTerminator + 2;
-                    lineTerminator = nextLineTerminator;
-                }
-                else
-                {
-                    break;
-                }
             }
-            // Remove any whitespace that might be at te beginning
-            // or end of the header value, and then store the header.
-            value = StripMarginWhitespace(value);
-            impl_->headers.push_back({name, value});
-        }
-        bodyOffset = offset;
-        if (offset == 0)
-        {
-            return State::Incomplete;
         }
-        return State::Complete;
     }
 
-    auto MessageHeaders::ParseRawMessage(const std::string& rawMessageString) -> State
+    template auto MessageHeaders::ParseRawMessage<ConfiguredProfile>(std::string_view rawMessage,
+                                                                     size_t& bodyOffset) -> State;
+    template auto MessageHeaders::ParseRawMessage<HttpProfile>(std::string_view rawMessage,
+                                                               size_t& bodyOffset) -> State;
+    template auto MessageHeaders::ParseRawMessage<SipProfile>(std::string_view rawMessage,
+                                                              size_t& bodyOffset) -> State;
+    template auto MessageHeaders::ParseRawMessage<EmailProfile>(std::string_view rawMessage,
+                                                                size_t& bodyOffset) -> State;
+
+    auto MessageHeaders::ParseRawMessage(std::string_view rawMessageString) -> State
     {
         size_t bodyOffset;
         return ParseRawMessage(rawMessageString, bodyOffset);
     }
 
-    auto MessageHeaders::GetAll() const -> Headers { return impl_->headers; }
-
-    bool MessageHeaders::HasHeader(const HeaderName& name) const
+    auto MessageHeaders::GetAll() const -> Headers
     {
-        for (const auto& header : impl_->headers)
+        Headers headers;
+        headers.reserve(impl_->storage->headers.size());
+        for (size_t i = 0; i < impl_->storage->headers.size(); ++i)
         {
-            if (header.name == name)
-            {
-                return true;
-            }
+            const auto value = impl_->Value(i);
+            headers.emplace_back(HeaderName(impl_->storage->Name(impl_->storage->headers[i])),
+                                 HeaderValue(value));
         }
-        return false;
+        return headers;
+    }
+
+    bool MessageHeaders::HasHeader(const HeaderName& name) const
+    {
+        return (impl_->Lookup(name) != NotFound);
     }
 
-    void MessageHeaders::SetHeader(const HeaderName& name, const HeaderValue& value)
+    void MessageHeaders::SetHeader(const HeaderName& name, std::string_view value)
     {
-        bool haveSetValues = false;
-        for (auto header = impl_->headers.begin(); header != impl_->headers.end();)
+        impl_->Unshare();
+        auto& storage = *impl_->storage;
+        const auto position = impl_->FindFirst(name);
+        if (position == NotFound)
         {
-            if (header->name == name)
-            {
-                if (haveSetValues)
-                {
-                    header = impl_->headers.erase(header);
-                }
-                else
-                {
-                    header->value = value;
-                    ++header;
-                    haveSetValues = true;
-                }
-            }
-            else
-            {
-                ++header;
-            }
+            impl_->Append((const std::string&)name, value);
+            return;
         }
-        if (!haveSetValues)
+        storage.SetValue(storage.headers[position], value);
+        if (impl_->FindNext(name, position) != NotFound)
         {
-            impl_->headers.emplace_back(name, value);
+            storage.RemoveWhere(position + 1, [&](const Impl::Record& header)
+                                { return storage.HasName(header, name); });
         }
+        storage.Compact();
     }
 
     void MessageHeaders::SetHeader(const HeaderName& name, const std::vector<HeaderValue>& values,
@@ -408,21 +1958,8 @@ namespace MessageHeaders
         }
         if (oneLine)
         {
-            bool isFirstValue = true;
-            std::string compositeValue;
-            for (const auto& value : values)
-            {
-                if (isFirstValue)
-                {
-                    isFirstValue = false;
-                }
-                else
-                {
-                    compositeValue += ',';
-                }
-                compositeValue += value;
-            }
-            SetHeader(name, compositeValue);
+            impl_->JoinValues(values);
+            SetHeader(name, impl_->joinedValue);
         }
         else
         {
@@ -442,9 +1979,10 @@ namespace MessageHeaders
         }
     }
 
-    void MessageHeaders::AddHeader(const HeaderName& name, const HeaderValue& value)
+    void MessageHeaders::AddHeader(const HeaderName& name, std::string_view value)
     {
-        impl_->headers.emplace_back(name, value);
+        impl_->Unshare();
+        impl_->Append((const std::string&)name, value);
     }
 
     void MessageHeaders::AddHeader(const HeaderName& name, const std::vector<HeaderValue>& values,
@@ -456,25 +1994,11 @@ namespace MessageHeaders
         }
         if (oneLine)
         {
-            bool isFirstValue = true;
-            std::string compositeValue;
-            for (const auto& value : values)
-            {
-                if (isFirstValue)
-                {
-                    isFirstValue = false;
-                }
-                else
-                {
-                    compositeValue += ',';
-                }
-                compositeValue += value;
-            }
-            AddHeader(name, compositeValue);
+            impl_->JoinValues(values);
+            AddHeader(name, impl_->joinedValue);
         }
         else
         {
-            bool isFirstValue = true;
             for (const auto& value : values)
             {
                 AddHeader(name, value);
@@ -483,40 +2007,119 @@ namespace MessageHeaders
     }
     void MessageHeaders::RemoveHeader(const HeaderName& headerName)
     {
-        for (auto header = impl_->headers.begin(); header != impl_->headers.end();)
+        const auto position = impl_->FindFirst(headerName);
+        if (position == NotFound)
+        {
+            return;
+        }
+        impl_->Unshare();
+        auto& storage = *impl_->storage;
+        storage.RemoveWhere(position, [&](const Impl::Record& header)
+                            { return storage.HasName(header, headerName); });
+        storage.Compact();
+    }
+
+    void MessageHeaders::RemoveHeaders(const std::vector<HeaderName>& headerNames)
+    {
+        std::vector<Impl::EditOutcome> outcomes;
+        outcomes.reserve(headerNames.size());
+        for (const auto& headerName : headerNames)
+        {
+            outcomes.push_back({&headerName});
+        }
+        impl_->Unshare();
+        impl_->ApplyEdits(outcomes);
+    }
+
+    void MessageHeaders::EditHeaders(const std::vector<HeaderEdit>& edits)
+    {
+        std::vector<Impl::EditOutcome> outcomes;
+        for (size_t i = 0; i < edits.size(); ++i)
         {
-            if (header->name == headerName)
+            const auto& edit = edits[i];
+            auto outcome = outcomes.begin();
+            while ((outcome != outcomes.end()) && !(*outcome->name == edit.name))
+            {
+                ++outcome;
+            }
+            if (outcome == outcomes.end())
             {
-                header = impl_->headers.erase(header);
+                outcomes.push_back({&edit.name});
+                outcome = outcomes.end() - 1;
+                outcome->appended = (impl_->FindFirst(edit.name) == NotFound);
+                outcome->appendOrder = i;
+            }
+            if (edit.action == HeaderEdit::Action::Set)
+            {
+                outcome->value = &edit.value;
+                if (outcome->appendOrder == edits.size())
+                {
+                    outcome->appendOrder = i;
+                }
             }
             else
             {
-                ++header;
+                // Once removed, the header can only come back at the end,
+                // in the order in which it's next set.
+                outcome->value = nullptr;
+                outcome->appended = true;
+                outcome->appendOrder = edits.size();
             }
         }
+        impl_->Unshare();
+        impl_->ApplyEdits(outcomes);
+    }
+
+    void MessageHeaders::Reserve(size_t headerCount)
+    {
+        impl_->Unshare();
+        auto& storage = *impl_->storage;
+        storage.headers.reserve(headerCount);
+        if (storage.indexValid)
+        {
+            storage.nextWithSameName.reserve(headerCount);
+        }
+    }
+
+    void MessageHeaders::Clear()
+    {
+        // Storage shared with clones is left to them, rather than
+        // copied only to be cleared.
+        if (impl_->storage.use_count() > 1)
+        {
+            impl_->storage = std::allocate_shared<Impl::Storage>(
+                std::pmr::polymorphic_allocator<Impl::Storage>(impl_->resource), impl_->resource);
+        }
+        else
+        {
+            impl_->storage->Clear();
+        }
+        impl_->valid = true;
+        impl_->scanner.Reset();
+        impl_->headersBeforeParse = 0;
+        impl_->rawHeadersBeforeParse = 0;
     }
+
+    void MessageHeaders::AbandonParse() { impl_->AbandonParse(); }
+
     auto MessageHeaders::GetHeaderValue(const HeaderName& headerName) const -> HeaderValue
     {
-        for (const auto& header : impl_->headers)
+        const auto position = impl_->Lookup(headerName);
+        if (position == NotFound)
         {
-            if (header.name == headerName)
-            {
-                return header.value;
-            }
+            return "";
         }
-        return "";
+        return HeaderValue(impl_->Value(position));
     }
 
     auto MessageHeaders::GetHeaderMultiValues(const HeaderName& headerName) const
         -> std::vector<HeaderValue>
     {
         std::vector<HeaderValue> headerValues;
-        for (const auto& header : impl_->headers)
+        for (auto position = impl_->Lookup(headerName); position != NotFound;
+             position = impl_->FindNext(headerName, position))
         {
-            if (header.name == headerName)
-            {
-                headerValues.push_back(header.value);
-            }
+            headerValues.emplace_back(impl_->Value(position));
         }
         return headerValues;
     }
@@ -525,39 +2128,87 @@ namespace MessageHeaders
         -> std::vector<HeaderValue>
     {
         std::vector<HeaderValue> headerTokens;
-        for (const auto& header : impl_->headers)
+        for (auto position = impl_->Lookup(headerName); position != NotFound;
+             position = impl_->FindNext(headerName, position))
         {
-            if (header.name == headerName)
-            {
-                auto tokens = StringUtils::Split(header.value, ",");
-                headerTokens.insert(headerTokens.end(), tokens.begin(), tokens.end());
-            }
+            auto tokens = StringUtils::Split(HeaderValue(impl_->Value(position)), ",");
+            headerTokens.insert(headerTokens.end(), tokens.begin(), tokens.end());
         }
         return headerTokens;
     }
 
+    void MessageHeaders::VisitHeaderValues(const HeaderName& headerName, ValueVisitor visitor,
+                                           void* context) const
+    {
+        for (auto position = impl_->Lookup(headerName); position != NotFound;
+             position = impl_->FindNext(headerName, position))
+        {
+            visitor(context, impl_->Value(position));
+        }
+    }
+
+    void MessageHeaders::VisitHeaders(HeaderVisitor visitor, void* context) const
+    {
+        for (size_t i = 0; i < impl_->storage->headers.size(); ++i)
+        {
+            const auto value = impl_->Value(i);
+            visitor(context, impl_->storage->Name(impl_->storage->headers[i]), value);
+        }
+    }
+
     std::string MessageHeaders::GenerateRawHeaders() const
     {
-        std::ostringstream rawMessage;
-        for (const auto& header : impl_->headers)
+        std::string rawMessage;
+        AppendRawHeaders(rawMessage);
+        return rawMessage;
+    }
+
+    void MessageHeaders::GenerateRawHeaderSpans(std::vector<std::string_view>& spans) const
+    {
+        const auto firstSpan = spans.size();
+        SpanSink sink{spans};
+        impl_->EmitRawHeaders(sink);
+        MESSAGE_HEADERS_COUNT(rawHeadersGenerated, 1);
+        for (size_t i = firstSpan; i < spans.size(); ++i)
         {
-            std::ostringstream lineBuffer;
-            lineBuffer << header.name << ": " << header.value << CRLF;
-            if (impl_->lineLengthLimit > 0)
-            {
-                for (const auto& part :
-                     SplitLine(lineBuffer.str(), CRLF, " ", impl_->MakeHeaderLineFoldingStrategy()))
-                {
-                    rawMessage << part;
-                }
-            }
-            else
-            {
-                rawMessage << lineBuffer.str();
-            }
+            MESSAGE_HEADERS_COUNT(rawBytesGenerated, spans[i].length());
+        }
+    }
+
+    size_t MessageHeaders::GetRawSize() const
+    {
+        if (impl_->lineLengthLimit > 0)
+        {
+            SizeSink sink;
+            impl_->EmitRawHeaders(sink);
+            return sink.size;
+        }
+        impl_->MeasureLines();
+        return impl_->storage->linesLength + CRLF.length();
+    }
+
+    size_t MessageHeaders::GenerateRawHeaders(char* buffer, size_t bufferSize) const
+    {
+        const auto rawSize = GetRawSize();
+        if (rawSize <= bufferSize)
+        {
+            BufferSink sink{buffer};
+            impl_->EmitRawHeaders(sink);
+            MESSAGE_HEADERS_COUNT(rawHeadersGenerated, 1);
+            MESSAGE_HEADERS_COUNT(rawBytesGenerated, rawSize);
         }
-        rawMessage << CRLF;
-        return rawMessage.str();
+        return rawSize;
+    }
+
+    void MessageHeaders::AppendRawHeaders(std::string& output) const
+    {
+        const auto originalSize = output.size();
+        const auto rawSize = GetRawSize();
+        output.resize(originalSize + rawSize);
+        BufferSink sink{&output[originalSize]};
+        impl_->EmitRawHeaders(sink);
+        MESSAGE_HEADERS_COUNT(rawHeadersGenerated, 1);
+        MESSAGE_HEADERS_COUNT(rawBytesGenerated, rawSize);
     }
 
     void MessageHeaders::SetLineLimit(size_t lineLengthLimit)
@@ -565,6 +2216,15 @@ namespace MessageHeaders
         impl_->lineLengthLimit = lineLengthLimit;
     }
 
+    void MessageHeaders::SetLazyValues(bool lazyValues) { impl_->lazyValues = lazyValues; }
+
+    void MessageHeaders::SetStrictness(Strictness strictness)
+    {
+        impl_->scanner.SetStrictness(strictness);
+    }
+
+    void MessageHeaders::SetLimits(const Limits& limits) { impl_->scanner.SetLimits(limits); }
+
     bool MessageHeaders::IsValid() const { return impl_->valid; }
 
     void PrintTo(const MessageHeaders::State& state, std::ostream* os)
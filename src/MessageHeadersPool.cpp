@@ -0,0 +1,86 @@
+/**
+ * @file MessageHeadersPool.cpp
+ *
+ * This module contains the implementation of the MessageHeaders::MessageHeadersPool class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <MessageHeaders/MessageHeadersPool.hpp>
+#include <utility>
+#include <vector>
+
+namespace MessageHeaders
+{
+    /**
+     * This contains the private properties of a MessageHeadersPool instance.
+     */
+    struct MessageHeadersPool::Impl
+    {
+        /**
+         * These are the objects kept which aren't in use.
+         */
+        std::vector<MessageHeaders> idle;
+
+        /**
+         * This is the largest number of objects kept while they're not in use.
+         */
+        size_t maxIdle;
+
+        /**
+         * This is the memory resource from which the objects constructed
+         * by the pool allocate their headers.
+         */
+        std::pmr::memory_resource* resource;
+
+        /**
+         * This is the constructor of the structure.
+         *
+         * @param[in] maxIdle
+         *      This is the largest number of objects kept while
+         *      they're not in use.
+         *
+         * @param[in] resource
+         *      This is the memory resource from which the objects
+         *      constructed by the pool allocate their headers.
+         */
+        Impl(size_t maxIdle, std::pmr::memory_resource* resource) :
+            maxIdle(maxIdle),
+            resource(resource)
+        {
+            // Make room for every object that may be kept up front,
+            // so that giving one back never allocates.
+            idle.reserve(maxIdle);
+        }
+    };
+
+    MessageHeadersPool::~MessageHeadersPool() noexcept = default;
+
+    MessageHeadersPool::MessageHeadersPool(size_t maxIdle, std::pmr::memory_resource* resource) :
+        impl_(new Impl(maxIdle, resource))
+    {
+    }
+
+    MessageHeaders MessageHeadersPool::Acquire()
+    {
+        if (impl_->idle.empty())
+        {
+            return MessageHeaders(impl_->resource);
+        }
+        auto headers = std::move(impl_->idle.back());
+        impl_->idle.pop_back();
+        return headers;
+    }
+
+    void MessageHeadersPool::Release(MessageHeaders headers)
+    {
+        if (impl_->idle.size() >= impl_->maxIdle)
+        {
+            return;
+        }
+        headers.Clear();
+        impl_->idle.push_back(std::move(headers));
+    }
+
+    size_t MessageHeadersPool::GetIdleCount() const { return impl_->idle.size(); }
+}  // namespace MessageHeaders
@@ -0,0 +1,164 @@
+/**
+ * @file MessageHeadersView.cpp
+ *
+ * This module contains the implementation of the MessageHeaders::MessageHeadersView class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <MessageHeaders/MessageHeadersView.hpp>
+
+namespace MessageHeaders
+{
+    MessageHeadersView::MessageHeadersView(std::pmr::memory_resource* resource) :
+        records_(resource),
+        unfoldedValues_(resource)
+    {
+    }
+
+    auto MessageHeadersView::ParseRawMessage(std::string_view rawMessage, size_t& bodyOffset)
+        -> State
+    {
+        // If the raw message is shorter than what we already scanned, it
+        // can't be a continuation of the interrupted parse, so start over.
+        // Starting a new parse drops the headers of any message parsed
+        // before, since they refer to a raw message no longer kept, but
+        // a parse still waiting for the end of its first line goes on.
+        if ((rawMessage.length() < scanner_.GetScannedLength())
+            || (scanner_.GetScannedLength() == 0))
+        {
+            Clear();
+        }
+        rawMessage_ = rawMessage;
+        HeaderScanner::ScannedHeader header;
+        for (;;)
+        {
+            switch (scanner_.Next(rawMessage, header))
+            {
+            case HeaderScanner::Result::Header:
+            {
+                if (!header.validName || !header.validValue)
+                {
+                    valid_ = false;
+                }
+                Record record;
+                record.nameOffset = header.nameOffset;
+                record.nameLength = header.nameLength;
+                if (header.folded)
+                {
+                    unfoldedValues_.emplace_back();
+                    HeaderScanner::UnfoldValue(rawMessage, header, unfoldedValues_.back());
+                    record.valueOffset = unfoldedValues_.size() - 1;
+                    record.valueLength = unfoldedValues_.back().length();
+                    record.unfolded = true;
+                }
+                else
+                {
+                    const auto value = HeaderScanner::GetValue(rawMessage, header);
+                    record.valueOffset = header.valueOffset;
+                    if (!value.empty())
+                    {
+                        record.valueOffset = (size_t)(value.data() - rawMessage.data());
+                    }
+                    record.valueLength = value.length();
+                    record.unfolded = false;
+                }
+                records_.push_back(record);
+            }
+            break;
+            case HeaderScanner::Result::End:
+            {
+                bodyOffset = scanner_.GetOffset();
+                scanner_.Reset();
+                return State::Complete;
+            }
+            case HeaderScanner::Result::Incomplete:
+            {
+                bodyOffset = scanner_.GetOffset();
+                return State::Incomplete;
+            }
+            case HeaderScanner::Result::Error:
+            default:
+            {
+                valid_ = false;
+                scanner_.Reset();
+                return State::Error;
+            }
+            }
+        }
+    }
+
+    auto MessageHeadersView::ParseRawMessage(std::string_view rawMessage) -> State
+    {
+        size_t bodyOffset;
+        return ParseRawMessage(rawMessage, bodyOffset);
+    }
+
+    size_t MessageHeadersView::GetHeaderCount() const { return records_.size(); }
+
+    auto MessageHeadersView::GetHeader(size_t index) const -> HeaderView
+    {
+        const auto& record = records_[index];
+        HeaderView header;
+        header.name = rawMessage_.substr(record.nameOffset, record.nameLength);
+        if (record.unfolded)
+        {
+            header.value = unfoldedValues_[record.valueOffset];
+        }
+        else
+        {
+            header.value = rawMessage_.substr(record.valueOffset, record.valueLength);
+        }
+        return header;
+    }
+
+    bool MessageHeadersView::HasHeader(std::string_view headerName) const
+    {
+        for (const auto& record : records_)
+        {
+            const auto name = rawMessage_.substr(record.nameOffset, record.nameLength);
+            if (MessageHeaders::HeaderName::Equivalent(name, headerName))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string_view MessageHeadersView::GetHeaderValue(std::string_view headerName) const
+    {
+        for (size_t i = 0; i < records_.size(); ++i)
+        {
+            const auto& record = records_[i];
+            const auto name = rawMessage_.substr(record.nameOffset, record.nameLength);
+            if (MessageHeaders::HeaderName::Equivalent(name, headerName))
+            {
+                return GetHeader(i).value;
+            }
+        }
+        return {};
+    }
+
+    void MessageHeadersView::SetLineLimit(size_t lineLengthLimit)
+    {
+        scanner_.SetLineLimit(lineLengthLimit);
+    }
+
+    void MessageHeadersView::SetStrictness(Strictness strictness)
+    {
+        scanner_.SetStrictness(strictness);
+    }
+
+    void MessageHeadersView::SetLimits(const Limits& limits) { scanner_.SetLimits(limits); }
+
+    bool MessageHeadersView::IsValid() const { return valid_; }
+
+    void MessageHeadersView::Clear()
+    {
+        rawMessage_ = {};
+        records_.clear();
+        unfoldedValues_.clear();
+        scanner_.Reset();
+        valid_ = true;
+    }
+}  // namespace MessageHeaders
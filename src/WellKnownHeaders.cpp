@@ -0,0 +1,261 @@
+/**
+ * @file WellKnownHeaders.cpp
+ *
+ * This module contains the implementation of the functions used
+ * to recognize the MessageHeaders::WellKnownHeader identifiers.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <array>
+#include <MessageHeaders/MessageHeaders.hpp>
+#include <MessageHeaders/WellKnownHeaders.hpp>
+
+namespace
+{
+    /**
+     * These are the usual spellings of the well-known header names,
+     * in the same order as their identifiers.
+     */
+    constexpr std::array<std::string_view,
+                         1 + (size_t)MessageHeaders::WellKnownHeader::XForwardedProto>
+        WellKnownHeaderNames{
+            "",
+            "Accept",
+            "Accept-Charset",
+            "Accept-Encoding",
+            "Accept-Language",
+            "Accept-Ranges",
+            "Age",
+            "Alert-Info",
+            "Allow",
+            "Allow-Events",
+            "Authentication-Info",
+            "Authorization",
+            "Bcc",
+            "Cache-Control",
+            "Call-ID",
+            "Call-Info",
+            "Cc",
+            "Comments",
+            "Connection",
+            "Contact",
+            "Content-Disposition",
+            "Content-Encoding",
+            "Content-Language",
+            "Content-Length",
+            "Content-Location",
+            "Content-Range",
+            "Content-Transfer-Encoding",
+            "Content-Type",
+            "Cookie",
+            "CSeq",
+            "Date",
+            "Delivered-To",
+            "DKIM-Signature",
+            "Error-Info",
+            "ETag",
+            "Event",
+            "Expect",
+            "Expires",
+            "Forwarded",
+            "From",
+            "Host",
+            "If-Match",
+            "If-Modified-Since",
+            "If-None-Match",
+            "If-Range",
+            "If-Unmodified-Since",
+            "In-Reply-To",
+            "Keep-Alive",
+            "Keywords",
+            "Last-Modified",
+            "Location",
+            "Max-Forwards",
+            "Message-ID",
+            "MIME-Version",
+            "Min-Expires",
+            "Organization",
+            "Origin",
+            "Pragma",
+            "Priority",
+            "Proxy-Authenticate",
+            "Proxy-Authorization",
+            "Proxy-Require",
+            "Range",
+            "Received",
+            "Record-Route",
+            "Referer",
+            "References",
+            "Reply-To",
+            "Require",
+            "Resent-Date",
+            "Resent-From",
+            "Resent-Message-ID",
+            "Resent-To",
+            "Retry-After",
+            "Return-Path",
+            "Route",
+            "Sender",
+            "Server",
+            "Set-Cookie",
+            "Subject",
+            "Subscription-State",
+            "Supported",
+            "TE",
+            "Timestamp",
+            "To",
+            "Trailer",
+            "Transfer-Encoding",
+            "Unsupported",
+            "Upgrade",
+            "User-Agent",
+            "Vary",
+            "Via",
+            "Warning",
+            "WWW-Authenticate",
+            "X-Forwarded-For",
+            "X-Forwarded-Proto",
+        };
+
+    /**
+     * These are the parameters of the perfect hash function used to
+     * recognize well-known header names.  The multiplier was chosen so
+     * that no two well-known header names land in the same slot, which
+     * is verified below when the table is built.
+     */
+    constexpr uint32_t PerfectHashMultiplier = 59175;
+    constexpr size_t PerfectHashBits = 9;
+
+    /**
+     * This function returns the slot of the perfect hash table
+     * for the header name with the given hash.
+     *
+     * @param[in] hash
+     *      This is the hash of the header name.
+     *
+     * @return
+     *      The slot for the header name is returned.
+     */
+    constexpr size_t PerfectHashSlot(uint32_t hash)
+    {
+        return (uint32_t)(hash * PerfectHashMultiplier) >> (32 - PerfectHashBits);
+    }
+
+    /**
+     * This is the perfect hash table used to recognize
+     * well-known header names.
+     */
+    struct PerfectHashTable
+    {
+        /**
+         * This holds, for each slot, the identifier of the well-known
+         * header name landing in it, or zero if there isn't one.
+         */
+        uint8_t slots[1 << PerfectHashBits] = {};
+
+        /**
+         * This indicates whether or not every well-known header name
+         * landed in a slot of its own.
+         */
+        bool collisionFree = true;
+    };
+
+    /**
+     * This function builds the perfect hash table used to
+     * recognize well-known header names.
+     *
+     * @return
+     *      The perfect hash table is returned.
+     */
+    constexpr PerfectHashTable MakePerfectHashTable()
+    {
+        PerfectHashTable table;
+        for (size_t id = 1; id < WellKnownHeaderNames.size(); ++id)
+        {
+            const auto hash = MessageHeaders::HashHeaderName(WellKnownHeaderNames[id]);
+            const auto slot = PerfectHashSlot(hash);
+            if (table.slots[slot] != 0)
+            {
+                table.collisionFree = false;
+            }
+            table.slots[slot] = (uint8_t)id;
+        }
+        return table;
+    }
+
+    constexpr PerfectHashTable WellKnownHeaderTable = MakePerfectHashTable();
+    static_assert(WellKnownHeaderTable.collisionFree,
+                  "PerfectHashMultiplier must be changed for the new set of header names");
+
+    /**
+     * This function builds the table giving, for each lower-case letter,
+     * the identifier of the header name for which it's the compact form
+     * in SIP (RFC 3261 section 7.3.3, RFC 3265 section 7.2), if any.
+     *
+     * @return
+     *      The table of compact forms is returned.
+     */
+    constexpr std::array<MessageHeaders::WellKnownHeader, 26> MakeCompactForms()
+    {
+        std::array<MessageHeaders::WellKnownHeader, 26> compactForms{};
+        compactForms['c' - 'a'] = MessageHeaders::WellKnownHeader::ContentType;
+        compactForms['e' - 'a'] = MessageHeaders::WellKnownHeader::ContentEncoding;
+        compactForms['f' - 'a'] = MessageHeaders::WellKnownHeader::From;
+        compactForms['i' - 'a'] = MessageHeaders::WellKnownHeader::CallId;
+        compactForms['k' - 'a'] = MessageHeaders::WellKnownHeader::Supported;
+        compactForms['l' - 'a'] = MessageHeaders::WellKnownHeader::ContentLength;
+        compactForms['m' - 'a'] = MessageHeaders::WellKnownHeader::Contact;
+        compactForms['o' - 'a'] = MessageHeaders::WellKnownHeader::Event;
+        compactForms['s' - 'a'] = MessageHeaders::WellKnownHeader::Subject;
+        compactForms['t' - 'a'] = MessageHeaders::WellKnownHeader::To;
+        compactForms['u' - 'a'] = MessageHeaders::WellKnownHeader::AllowEvents;
+        compactForms['v' - 'a'] = MessageHeaders::WellKnownHeader::Via;
+        return compactForms;
+    }
+
+    /**
+     * This is the table of compact forms of SIP header names.
+     */
+    constexpr auto CompactForms = MakeCompactForms();
+}  // namespace
+
+namespace MessageHeaders
+{
+    WellKnownHeader FindWellKnownHeader(std::string_view name, uint32_t hash)
+    {
+        const auto id = WellKnownHeaderTable.slots[PerfectHashSlot(hash)];
+        if ((id != 0) && MessageHeaders::HeaderName::Equivalent(WellKnownHeaderNames[id], name))
+        {
+            return (WellKnownHeader)id;
+        }
+        return WellKnownHeader::Unknown;
+    }
+
+    WellKnownHeader FindCompactHeader(std::string_view name)
+    {
+        if (name.length() != 1)
+        {
+            return WellKnownHeader::Unknown;
+        }
+        auto c = name[0];
+        if ((c >= 'A') && (c <= 'Z'))
+        {
+            c += 'a' - 'A';
+        }
+        if ((c < 'a') || (c > 'z'))
+        {
+            return WellKnownHeader::Unknown;
+        }
+        return CompactForms[c - 'a'];
+    }
+
+    std::string_view GetWellKnownHeaderName(WellKnownHeader id)
+    {
+        if ((size_t)id < WellKnownHeaderNames.size())
+        {
+            return WellKnownHeaderNames[(size_t)id];
+        }
+        return {};
+    }
+}  // namespace MessageHeaders
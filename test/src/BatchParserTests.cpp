@@ -0,0 +1,128 @@
+/**
+ * @file BatchParserTests.cpp
+ *
+ * This module contains unit Tests of the MessageHeaders::BatchParser class
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <gtest/gtest.h>
+#include <MessageHeaders/BatchParser.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    /**
+     * This function builds a batch of raw messages of very different
+     * sizes, some of which are incomplete or bad.
+     *
+     * @return
+     *      The raw messages built are returned.
+     */
+    std::vector<std::string> MakeRawMessages()
+    {
+        std::vector<std::string> rawMessages;
+        for (size_t i = 0; i < 500; ++i)
+        {
+            std::string rawMessage;
+            const auto headerCount = ((i % 97) == 0) ? 400 : (i % 5);
+            for (size_t j = 0; j < headerCount; ++j)
+            {
+                rawMessage += "X-Header-" + std::to_string(j) + ": " + std::to_string(i) + "\r\n";
+            }
+            if ((i % 11) == 0)
+            {
+                rawMessage += "Bad header line\r\n";
+            }
+            if ((i % 13) != 0)
+            {
+                rawMessage += "\r\nbody " + std::to_string(i);
+            }
+            rawMessages.push_back(rawMessage);
+        }
+        return rawMessages;
+    }
+}  // namespace
+
+TEST(BatchParserTests, ResultsMatchParsingEachMessageAlone)
+{
+    const auto rawMessages = MakeRawMessages();
+    for (size_t threadCount = 1; threadCount <= 4; ++threadCount)
+    {
+        MessageHeaders::BatchParser parser(threadCount);
+        ASSERT_EQ(threadCount, parser.GetThreadCount());
+        const auto results = parser.Parse(rawMessages);
+        ASSERT_EQ(rawMessages.size(), results.size());
+        for (size_t i = 0; i < rawMessages.size(); ++i)
+        {
+            MessageHeaders::MessageHeaders expectedHeaders;
+            size_t expectedBodyOffset = 0;
+            const auto expectedState =
+                expectedHeaders.ParseRawMessage(rawMessages[i], expectedBodyOffset);
+            ASSERT_EQ(expectedState, results[i].state) << i;
+            ASSERT_EQ(expectedHeaders.GenerateRawHeaders(), results[i].headers.GenerateRawHeaders())
+                << i;
+            if (expectedState != MessageHeaders::MessageHeaders::State::Error)
+            {
+                ASSERT_EQ(expectedBodyOffset, results[i].bodyOffset) << i;
+            }
+        }
+    }
+}
+
+TEST(BatchParserTests, ParseSeveralBatchesWithSameThreads)
+{
+    MessageHeaders::BatchParser parser(3);
+    ASSERT_TRUE(parser.Parse((const std::string*)nullptr, 0).empty());
+    for (size_t batch = 0; batch < 20; ++batch)
+    {
+        std::vector<std::string> rawMessages;
+        for (size_t i = 0; i < batch; ++i)
+        {
+            rawMessages.push_back("Batch: " + std::to_string(batch) + "\r\nMessage: " +
+                                  std::to_string(i) + "\r\n\r\n");
+        }
+        const auto results = parser.Parse(rawMessages);
+        ASSERT_EQ(batch, results.size());
+        for (size_t i = 0; i < batch; ++i)
+        {
+            ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete, results[i].state);
+            ASSERT_EQ(rawMessages[i].length(), results[i].bodyOffset);
+            ASSERT_EQ(std::to_string(i), results[i].headers.GetHeaderValue("Message"));
+        }
+    }
+}
+
+TEST(BatchParserTests, ParseViewsOfRawMessages)
+{
+    std::string buffer;
+    std::vector<size_t> ends;
+    for (size_t i = 0; i < 50; ++i)
+    {
+        buffer += "Message: " + std::to_string(i) + "\r\n\r\nbody";
+        ends.push_back(buffer.length());
+    }
+    std::vector<std::string_view> rawMessages;
+    for (size_t i = 0; i < ends.size(); ++i)
+    {
+        const auto begin = (i == 0) ? 0 : ends[i - 1];
+        rawMessages.push_back(std::string_view(buffer).substr(begin, ends[i] - begin));
+    }
+    MessageHeaders::BatchParser parser(3);
+    const auto results = parser.Parse(rawMessages.data(), rawMessages.size());
+    ASSERT_EQ(rawMessages.size(), results.size());
+    for (size_t i = 0; i < rawMessages.size(); ++i)
+    {
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete, results[i].state);
+        ASSERT_EQ(rawMessages[i].length() - 4, results[i].bodyOffset);
+        ASSERT_EQ(std::to_string(i), results[i].headers.GetHeaderValue("Message"));
+    }
+}
+
+TEST(BatchParserTests, DefaultThreadCountUsesHardware)
+{
+    MessageHeaders::BatchParser parser;
+    ASSERT_GE(parser.GetThreadCount(), 1);
+}
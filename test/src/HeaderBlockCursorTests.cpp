@@ -0,0 +1,100 @@
+/**
+ * @file HeaderBlockCursorTests.cpp
+ *
+ * This module contains unit Tests of the MessageHeaders::HeaderBlockCursor class
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stdlib.h>
+#include <gtest/gtest.h>
+#include <MessageHeaders/HeaderBlockCursor.hpp>
+#include <string>
+#include <vector>
+
+TEST(HeaderBlockCursorTests, DrainPipelinedMessages)
+{
+    const std::string buffer =
+        "Host: www.example.com\r\n"
+        "Content-Length: 5\r\n"
+        "\r\n"
+        "Hello"
+        "Host: www.example.com\r\n"
+        "\r\n"
+        "Host: www.example.org\r\n"
+        "Content-Length: 3\r\n"
+        "\r\n"
+        "Bye";
+    MessageHeaders::HeaderBlockCursor cursor(buffer);
+    MessageHeaders::MessageHeadersView headers;
+    std::vector<std::string> hosts;
+    std::vector<std::string> bodies;
+    while (cursor.GetOffset() < buffer.length())
+    {
+        const auto block = cursor.Next(headers);
+        ASSERT_EQ(MessageHeaders::HeaderBlockCursor::State::Complete, block.state);
+        ASSERT_EQ(buffer.data() + block.bodyOffset - block.rawHeaders.length(),
+                  block.rawHeaders.data());
+        ASSERT_EQ(block.bodyOffset, cursor.GetOffset());
+        hosts.emplace_back(headers.GetHeaderValue("Host"));
+        ASSERT_EQ(buffer.data() + block.bodyOffset - block.rawHeaders.length() + 6,
+                  headers.GetHeaderValue("Host").data());
+        const auto bodyLength =
+            (size_t)atoi(std::string(headers.GetHeaderValue("Content-Length")).c_str());
+        bodies.emplace_back(cursor.GetRemaining().substr(0, bodyLength));
+        ASSERT_TRUE(cursor.Skip(bodyLength));
+    }
+    ASSERT_EQ((std::vector<std::string>{"www.example.com", "www.example.com", "www.example.org"}),
+              hosts);
+    ASSERT_EQ((std::vector<std::string>{"Hello", "", "Bye"}), bodies);
+    ASSERT_FALSE(cursor.Skip(1));
+}
+
+TEST(HeaderBlockCursorTests, IncompleteHeaderBlockResumesWhenMoreArrives)
+{
+    const std::string messages =
+        "To: Bob\r\n"
+        "\r\n"
+        "Via: SIP/2.0/TCP pc33.atlanta.com\r\n"
+        "  ;branch=z9hG4bK776asdhds\r\n"
+        "To: Alice\r\n"
+        "\r\n";
+    std::string received;
+    MessageHeaders::HeaderBlockCursor cursor;
+    MessageHeaders::MessageHeadersView headers;
+    std::vector<std::string> recipients;
+    for (auto c : messages)
+    {
+        received += c;
+        received.shrink_to_fit();
+        cursor.SetBuffer(received);
+        const auto block = cursor.Next(headers);
+        if (block.state == MessageHeaders::HeaderBlockCursor::State::Complete)
+        {
+            recipients.emplace_back(headers.GetHeaderValue("To"));
+        }
+        else
+        {
+            ASSERT_EQ(MessageHeaders::HeaderBlockCursor::State::Incomplete, block.state);
+            ASSERT_EQ(cursor.GetRemaining(), block.rawHeaders);
+        }
+    }
+    ASSERT_EQ((std::vector<std::string>{"Bob", "Alice"}), recipients);
+    ASSERT_EQ("SIP/2.0/TCP pc33.atlanta.com ;branch=z9hG4bK776asdhds",
+              headers.GetHeaderValue("Via"));
+    ASSERT_EQ("Alice", headers.GetHeaderValue("To"));
+    ASSERT_EQ(messages.length(), cursor.GetOffset());
+}
+
+TEST(HeaderBlockCursorTests, BadHeaderBlockStopsCursor)
+{
+    const std::string buffer =
+        "Not a header\r\n"
+        "\r\n";
+    MessageHeaders::HeaderBlockCursor cursor(buffer);
+    MessageHeaders::MessageHeadersView headers;
+    const auto block = cursor.Next(headers);
+    ASSERT_EQ(MessageHeaders::HeaderBlockCursor::State::Error, block.state);
+    ASSERT_EQ(0, cursor.GetOffset());
+    ASSERT_EQ(buffer, block.rawHeaders);
+}
@@ -0,0 +1,132 @@
+/**
+ * @file HeaderEventParserTests.cpp
+ *
+ * This module contains unit Tests of the MessageHeaders::HeaderEventParser class
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <gtest/gtest.h>
+#include <MessageHeaders/HeaderEventParser.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    /**
+     * This is the type used to collect the headers handed over by the parser.
+     */
+    typedef std::vector<std::pair<std::string, std::string>> Events;
+}  // namespace
+
+TEST(HeaderEventParserTests, HeadersHandedOverInOrder)
+{
+    const std::string rawMessage = "User-Agent: curl/7.16.3 libcurl/7.16.3\r\n"
+                                   "Subject: This is a test\r\n"
+                                   "  of folding\r\n"
+                                   "Host:  www.example.com \r\n"
+                                   "\r\n"
+                                   "Hello, World!\r\n";
+    MessageHeaders::HeaderEventParser parser;
+    Events events;
+    size_t bodyOffset = 0;
+    ASSERT_EQ(MessageHeaders::HeaderEventParser::State::Complete,
+              parser.ParseRawMessage(rawMessage, bodyOffset,
+                                     [&](std::string_view name, std::string_view value)
+                                     { events.emplace_back(name, value); }));
+    ASSERT_EQ((Events{{"User-Agent", "curl/7.16.3 libcurl/7.16.3"},
+                      {"Subject", "This is a test of folding"},
+                      {"Host", "www.example.com"}}),
+              events);
+    ASSERT_EQ(rawMessage.find("Hello"), bodyOffset);
+    ASSERT_TRUE(parser.IsValid());
+}
+
+TEST(HeaderEventParserTests, HeadersMatchMessageHeaders)
+{
+    const std::string rawMessage = "From: alice@example.com\r\n"
+                                   "Received: from a by b;\r\n"
+                                   "\tTue, 1 Oct 2024 10:00:00 +0000\r\n"
+                                   "Received: from c by d\r\n"
+                                   "X-Empty:\r\n"
+                                   "\r\n";
+    MessageHeaders::MessageHeaders headers;
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete, headers.ParseRawMessage(rawMessage));
+    Events expected;
+    headers.ForEachHeader([&](std::string_view name, std::string_view value)
+                          { expected.emplace_back(name, value); });
+    MessageHeaders::HeaderEventParser parser;
+    Events events;
+    ASSERT_EQ(MessageHeaders::HeaderEventParser::State::Complete,
+              parser.ParseRawMessage(rawMessage,
+                                     [&](std::string_view name, std::string_view value)
+                                     { events.emplace_back(name, value); }));
+    ASSERT_EQ(expected, events);
+}
+
+TEST(HeaderEventParserTests, EachHeaderHandedOverOnceAcrossIncrementalParse)
+{
+    const std::string rawMessage = "From: alice@example.com\r\n"
+                                   "Subject: first line\r\n"
+                                   "  second line\r\n"
+                                   "To: bob@example.com\r\n"
+                                   "\r\n";
+    MessageHeaders::HeaderEventParser parser;
+    Events events;
+    const auto handler = [&](std::string_view name, std::string_view value)
+    { events.emplace_back(name, value); };
+    size_t bodyOffset = 0;
+    MessageHeaders::HeaderEventParser::State state;
+    for (size_t length = 1; length <= rawMessage.length(); ++length)
+    {
+        state = parser.ParseRawMessage(rawMessage.substr(0, length), bodyOffset, handler);
+        if (length < rawMessage.length())
+        {
+            ASSERT_EQ(MessageHeaders::HeaderEventParser::State::Incomplete, state);
+        }
+    }
+    ASSERT_EQ(MessageHeaders::HeaderEventParser::State::Complete, state);
+    ASSERT_EQ(rawMessage.length(), bodyOffset);
+    ASSERT_EQ((Events{{"From", "alice@example.com"},
+                      {"Subject", "first line second line"},
+                      {"To", "bob@example.com"}}),
+              events);
+}
+
+TEST(HeaderEventParserTests, RestartsOnMessageShorterThanFirstLineScanned)
+{
+    MessageHeaders::HeaderEventParser parser;
+    Events events;
+    const auto handler = [&](std::string_view name, std::string_view value)
+    { events.emplace_back(name, value); };
+    size_t bodyOffset = 0;
+    ASSERT_EQ(MessageHeaders::HeaderEventParser::State::Incomplete,
+              parser.ParseRawMessage("X-Long-Name-Here: val", bodyOffset, handler));
+    ASSERT_EQ(MessageHeaders::HeaderEventParser::State::Complete,
+              parser.ParseRawMessage("To: Bob\r\n\r\n", bodyOffset, handler));
+    ASSERT_EQ((Events{{"To", "Bob"}}), events);
+}
+
+TEST(HeaderEventParserTests, InvalidAndBadHeaders)
+{
+    MessageHeaders::HeaderEventParser parser;
+    size_t headerCount = 0;
+    const auto handler = [&](std::string_view, std::string_view) { ++headerCount; };
+    ASSERT_EQ(MessageHeaders::HeaderEventParser::State::Complete,
+              parser.ParseRawMessage("X-Bad: a\x01z\r\n\r\n", handler));
+    ASSERT_EQ(1, headerCount);
+    ASSERT_FALSE(parser.IsValid());
+    parser.Clear();
+    ASSERT_TRUE(parser.IsValid());
+    ASSERT_EQ(MessageHeaders::HeaderEventParser::State::Error,
+              parser.ParseRawMessage("From: alice@example.com\r\n"
+                                     "Bad header line\r\n"
+                                     "\r\n",
+                                     handler));
+    ASSERT_FALSE(parser.IsValid());
+    parser.Clear();
+    parser.SetLineLimit(16);
+    ASSERT_EQ(MessageHeaders::HeaderEventParser::State::Error,
+              parser.ParseRawMessage("Host: www.example.com\r\n\r\n", handler));
+}
@@ -0,0 +1,202 @@
+/**
+ * @file HeaderParseDriverTests.cpp
+ *
+ * This module contains unit Tests of the MessageHeaders::HeaderParseDriver class
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stddef.h>
+#include <gtest/gtest.h>
+#include <MessageHeaders/HeaderParseDriver.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && (__cpp_impl_coroutine >= 201902L)
+#include <coroutine>
+
+namespace
+{
+    /**
+     * This is the simplest kind of coroutine, which runs as soon as it's
+     * called, and cleans up after itself when it's done.
+     */
+    struct DetachedTask
+    {
+        struct promise_type
+        {
+            DetachedTask get_return_object() { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    /**
+     * This coroutine waits for the header blocks of the given number of
+     * messages, one after the other, recording the outcome of each.
+     */
+    DetachedTask AwaitHeaders(MessageHeaders::HeaderParseDriver& driver, size_t messageCount,
+                              std::vector<MessageHeaders::HeaderParseDriver::Outcome>& outcomes)
+    {
+        for (size_t i = 0; i < messageCount; ++i)
+        {
+            outcomes.push_back(co_await driver.Parse());
+            driver.Reset();
+        }
+    }
+}  // namespace
+#endif
+
+TEST(HeaderParseDriverTests, ReceiveInPieces)
+{
+    const std::string rawMessage =
+        "Host: www.example.com\r\n"
+        "Content-Type: text/plain\r\n"
+        "\r\n"
+        "Hello";
+    MessageHeaders::MessageHeaders headers;
+    MessageHeaders::HeaderParseDriver driver(headers);
+    size_t received = 0;
+    for (const size_t pieceLength : {7, 20, 1, 10})
+    {
+        ASSERT_FALSE(driver.IsDone());
+        received += pieceLength;
+        const auto outcome = driver.Receive(std::string_view(rawMessage.data(), received));
+        ASSERT_EQ(MessageHeaders::HeaderParseDriver::State::Incomplete, outcome.state);
+        ASSERT_LE(outcome.bodyOffset, received);
+    }
+    const auto outcome = driver.Receive(rawMessage);
+    ASSERT_TRUE(driver.IsDone());
+    ASSERT_EQ(MessageHeaders::HeaderParseDriver::State::Complete, outcome.state);
+    ASSERT_EQ(rawMessage.find("Hello"), outcome.bodyOffset);
+    ASSERT_EQ("www.example.com", headers.GetHeaderValue("Host"));
+    ASSERT_EQ("text/plain", headers.GetHeaderValue("Content-Type"));
+    ASSERT_EQ(MessageHeaders::HeaderParseDriver::State::Complete,
+              driver.Receive("Bad header\r\n\r\n").state);
+}
+
+TEST(HeaderParseDriverTests, BufferMayMoveBetweenPieces)
+{
+    const std::string rawMessage =
+        "Host: www.example.com\r\n"
+        "Subject: This is a test\r\n"
+        "\r\n";
+    MessageHeaders::MessageHeaders headers;
+    headers.SetLazyValues(true);
+    MessageHeaders::HeaderParseDriver driver(headers);
+    std::string buffer;
+    for (const auto c : rawMessage)
+    {
+        // Hand over a copy each time, spoiling the one handed over before.
+        auto moved = buffer + c;
+        buffer.assign(buffer.length(), 'X');
+        (void)driver.Receive(moved);
+        buffer.swap(moved);
+    }
+    ASSERT_EQ(MessageHeaders::HeaderParseDriver::State::Complete, driver.GetOutcome().state);
+    ASSERT_EQ("www.example.com", headers.GetHeaderValue("Host"));
+    ASSERT_EQ("This is a test", headers.GetHeaderValue("Subject"));
+}
+
+TEST(HeaderParseDriverTests, CloseBeforeComplete)
+{
+    MessageHeaders::MessageHeaders headers;
+    MessageHeaders::HeaderParseDriver driver(headers);
+    ASSERT_EQ(MessageHeaders::HeaderParseDriver::State::Incomplete,
+              driver.Receive("Alpha: 1\r\nBeta: 22").state);
+    driver.Close();
+    ASSERT_TRUE(driver.IsDone());
+    ASSERT_EQ(MessageHeaders::HeaderParseDriver::State::Error, driver.GetOutcome().state);
+    ASSERT_TRUE(headers.GetAll().empty());
+    driver.Reset();
+    ASSERT_FALSE(driver.IsDone());
+    const std::string secondMessage =
+        "Gamma: 333\r\n"
+        "Delta: 4444\r\n"
+        "\r\n";
+    const auto outcome = driver.Receive(secondMessage);
+    ASSERT_EQ(MessageHeaders::HeaderParseDriver::State::Complete, outcome.state);
+    ASSERT_EQ(secondMessage.length(), outcome.bodyOffset);
+    driver.Close();
+    ASSERT_EQ(MessageHeaders::HeaderParseDriver::State::Complete, driver.GetOutcome().state);
+    const auto parsedHeaders = headers.GetAll();
+    ASSERT_EQ(2, parsedHeaders.size());
+    ASSERT_EQ("Gamma", parsedHeaders[0].name);
+    ASSERT_EQ("333", parsedHeaders[0].value);
+    ASSERT_EQ("Delta", parsedHeaders[1].name);
+    ASSERT_EQ("4444", parsedHeaders[1].value);
+}
+
+TEST(HeaderParseDriverTests, ResetAbandonsIncompleteParse)
+{
+    MessageHeaders::MessageHeaders headers;
+    MessageHeaders::HeaderParseDriver driver(headers);
+    ASSERT_EQ(MessageHeaders::HeaderParseDriver::State::Incomplete,
+              driver.Receive("Alpha: 1\r\nBeta: 22").state);
+    driver.Reset();
+    ASSERT_EQ(MessageHeaders::HeaderParseDriver::State::Complete,
+              driver.Receive("Gamma: 333\r\n\r\n").state);
+    const auto parsedHeaders = headers.GetAll();
+    ASSERT_EQ(1, parsedHeaders.size());
+    ASSERT_EQ("Gamma", parsedHeaders[0].name);
+    ASSERT_EQ("333", parsedHeaders[0].value);
+}
+
+TEST(HeaderParseDriverTests, ResetBeforeFirstLineComplete)
+{
+    MessageHeaders::MessageHeaders headers;
+    MessageHeaders::HeaderParseDriver driver(headers);
+    ASSERT_EQ(MessageHeaders::HeaderParseDriver::State::Incomplete, driver.Receive("Cont").state);
+    driver.Close();
+    driver.Reset();
+    ASSERT_EQ(MessageHeaders::HeaderParseDriver::State::Complete,
+              driver.Receive("Content-Type: text/plain\r\n\r\n").state);
+    const auto parsedHeaders = headers.GetAll();
+    ASSERT_EQ(1, parsedHeaders.size());
+    ASSERT_EQ("Content-Type", parsedHeaders[0].name);
+    ASSERT_EQ("text/plain", parsedHeaders[0].value);
+}
+
+#if defined(__cpp_impl_coroutine) && (__cpp_impl_coroutine >= 201902L)
+TEST(HeaderParseDriverTests, CoroutineResumedWhenHeadersComplete)
+{
+    const std::string firstMessage =
+        "Host: www.example.com\r\n"
+        "\r\n";
+    const std::string secondMessage =
+        "Host: www.example.org\r\n"
+        "\r\n";
+    MessageHeaders::MessageHeaders headers;
+    MessageHeaders::HeaderParseDriver driver(headers);
+    std::vector<MessageHeaders::HeaderParseDriver::Outcome> outcomes;
+    AwaitHeaders(driver, 2, outcomes);
+    ASSERT_TRUE(outcomes.empty());
+    (void)driver.Receive(std::string_view(firstMessage.data(), 10));
+    ASSERT_TRUE(outcomes.empty());
+    (void)driver.Receive(firstMessage);
+    ASSERT_EQ(1, outcomes.size());
+    ASSERT_EQ(MessageHeaders::HeaderParseDriver::State::Complete, outcomes[0].state);
+    ASSERT_EQ(firstMessage.length(), outcomes[0].bodyOffset);
+    ASSERT_EQ("www.example.com", headers.GetHeaderValue("Host"));
+    headers.Clear();
+    (void)driver.Receive(std::string_view(secondMessage.data(), 5));
+    ASSERT_EQ(1, outcomes.size());
+    driver.Close();
+    ASSERT_EQ(2, outcomes.size());
+    ASSERT_EQ(MessageHeaders::HeaderParseDriver::State::Error, outcomes[1].state);
+}
+
+TEST(HeaderParseDriverTests, CoroutineNotSuspendedWhenAlreadyDone)
+{
+    MessageHeaders::MessageHeaders headers;
+    MessageHeaders::HeaderParseDriver driver(headers);
+    (void)driver.Receive("Host: www.example.com\r\n\r\n");
+    std::vector<MessageHeaders::HeaderParseDriver::Outcome> outcomes;
+    AwaitHeaders(driver, 1, outcomes);
+    ASSERT_EQ(1, outcomes.size());
+    ASSERT_EQ(MessageHeaders::HeaderParseDriver::State::Complete, outcomes[0].state);
+}
+#endif
@@ -0,0 +1,214 @@
+/**
+ * @file HeaderScannerTests.cpp
+ *
+ * This module contains unit Tests of the MessageHeaders::HeaderScanner class
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <gtest/gtest.h>
+#include <MessageHeaders/HeaderScanner.hpp>
+#include <MessageHeaders/ParserProfiles.hpp>
+#include <string>
+
+TEST(HeaderScannerTests, LinesOfEveryLengthAcrossBlockBoundaries)
+{
+    for (size_t valueLength = 0; valueLength < 70; ++valueLength)
+    {
+        std::string value(valueLength, 'x');
+        for (size_t i = 0; i < valueLength; i += 7)
+        {
+            value[i] = ((i % 2) == 0) ? '\r' : ':';
+        }
+        const std::string rawMessage = "Name: " + value + "\r\nTo: Bob\r\n\r\n";
+        MessageHeaders::HeaderScanner scanner;
+        MessageHeaders::HeaderScanner::ScannedHeader header;
+        ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Header, scanner.Next(rawMessage, header))
+            << valueLength;
+        ASSERT_EQ("Name", MessageHeaders::HeaderScanner::GetName(rawMessage, header));
+        ASSERT_EQ(6 + valueLength, header.valueEnd) << valueLength;
+        ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Header, scanner.Next(rawMessage, header))
+            << valueLength;
+        ASSERT_EQ("To", MessageHeaders::HeaderScanner::GetName(rawMessage, header));
+        ASSERT_EQ("Bob", MessageHeaders::HeaderScanner::GetValue(rawMessage, header));
+        ASSERT_EQ(MessageHeaders::HeaderScanner::Result::End, scanner.Next(rawMessage, header))
+            << valueLength;
+        ASSERT_EQ(rawMessage.length(), scanner.GetOffset());
+    }
+}
+
+TEST(HeaderScannerTests, ColonOnLaterLineDoesNotCount)
+{
+    const std::string rawMessage =
+        "This line has no colon at all, and is longer than a block\r\n"
+        "To: Bob\r\n"
+        "\r\n";
+    MessageHeaders::HeaderScanner scanner;
+    MessageHeaders::HeaderScanner::ScannedHeader header;
+    ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Error, scanner.Next(rawMessage, header));
+}
+
+TEST(HeaderScannerTests, LineTerminatorSplitBetweenCalls)
+{
+    const std::string rawMessage =
+        "Subject: a subject line long enough to span several blocks\r\n"
+        "\r\n";
+    for (size_t split = 1; split < rawMessage.length(); ++split)
+    {
+        MessageHeaders::HeaderScanner scanner;
+        MessageHeaders::HeaderScanner::ScannedHeader header;
+        auto result = scanner.Next(rawMessage.substr(0, split), header);
+        if (result == MessageHeaders::HeaderScanner::Result::Incomplete)
+        {
+            result = scanner.Next(rawMessage, header);
+        }
+        ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Header, result) << split;
+        ASSERT_EQ("Subject", MessageHeaders::HeaderScanner::GetName(rawMessage, header));
+        ASSERT_EQ("a subject line long enough to span several blocks",
+                  MessageHeaders::HeaderScanner::GetValue(rawMessage, header));
+        ASSERT_EQ(MessageHeaders::HeaderScanner::Result::End, scanner.Next(rawMessage, header))
+            << split;
+    }
+}
+
+TEST(HeaderScannerTests, ScannedLengthKeptBeforeFirstLineComplete)
+{
+    MessageHeaders::HeaderScanner scanner;
+    MessageHeaders::HeaderScanner::ScannedHeader header;
+    ASSERT_EQ(0, scanner.GetScannedLength());
+    ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Incomplete, scanner.Next("X-Lo", header));
+    ASSERT_EQ(0, scanner.GetOffset());
+    ASSERT_EQ(4, scanner.GetScannedLength());
+    scanner.Reset();
+    ASSERT_EQ(0, scanner.GetScannedLength());
+    const std::string rawMessage = "X-Long-Name-Here: value\r\n\r\n";
+    ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Header, scanner.Next(rawMessage, header));
+    ASSERT_EQ("X-Long-Name-Here", MessageHeaders::HeaderScanner::GetName(rawMessage, header));
+    ASSERT_EQ("value", MessageHeaders::HeaderScanner::GetValue(rawMessage, header));
+}
+
+TEST(HeaderScannerTests, BlockSizeLimitAtEveryBoundary)
+{
+    const std::string rawMessage =
+        "Subject: a subject line long enough to span several blocks\r\n"
+        "To: Bob\r\n"
+        "\r\n"
+        "body";
+    const auto blockSize = rawMessage.length() - 4;
+    for (size_t limit = 1; limit <= blockSize + 1; ++limit)
+    {
+        MessageHeaders::HeaderScanner scanner;
+        MessageHeaders::HeaderScanner::Limits limits;
+        limits.blockSize = limit;
+        scanner.SetLimits(limits);
+        MessageHeaders::HeaderScanner::ScannedHeader header;
+        auto result = MessageHeaders::HeaderScanner::Result::Header;
+        while (result == MessageHeaders::HeaderScanner::Result::Header)
+        {
+            result = scanner.Next(rawMessage, header);
+        }
+        if (limit < blockSize)
+        {
+            ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Error, result) << limit;
+        }
+        else
+        {
+            ASSERT_EQ(MessageHeaders::HeaderScanner::Result::End, result) << limit;
+        }
+    }
+}
+
+TEST(HeaderScannerTests, UnterminatedLineRejectedOnceOverLimit)
+{
+    const std::string rawMessage = "Subject: " + std::string(100000, 'x');
+    MessageHeaders::HeaderScanner scanner;
+    scanner.SetLineLimit(1000);
+    MessageHeaders::HeaderScanner::ScannedHeader header;
+    ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Incomplete,
+              scanner.Next(std::string_view(rawMessage).substr(0, 500), header));
+    ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Error, scanner.Next(rawMessage, header));
+    MessageHeaders::HeaderScanner blockScanner;
+    MessageHeaders::HeaderScanner::Limits limits;
+    limits.blockSize = 1000;
+    blockScanner.SetLimits(limits);
+    ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Error, blockScanner.Next(rawMessage, header));
+}
+
+TEST(HeaderScannerTests, HttpProfileHandsOverHeaderWithoutWaitingForNextLine)
+{
+    const std::string rawMessage = "Host: www.example.com\r\n";
+    MessageHeaders::HeaderScanner scanner;
+    MessageHeaders::HeaderScanner::ScannedHeader header;
+    ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Header,
+              scanner.Next<MessageHeaders::HttpProfile>(rawMessage, header));
+    ASSERT_EQ("Host", MessageHeaders::HeaderScanner::GetName(rawMessage, header));
+    ASSERT_EQ("www.example.com", MessageHeaders::HeaderScanner::GetValue(rawMessage, header));
+    ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Incomplete,
+              scanner.Next<MessageHeaders::HttpProfile>(rawMessage, header));
+    MessageHeaders::HeaderScanner configuredScanner;
+    ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Incomplete,
+              configuredScanner.Next(rawMessage, header));
+}
+
+TEST(HeaderScannerTests, HttpProfileRejectsFoldedLine)
+{
+    const std::string rawMessage =
+        "Host: www.example.com\r\n"
+        "X-Folded: one\r\n"
+        " two\r\n"
+        "\r\n";
+    MessageHeaders::HeaderScanner scanner;
+    MessageHeaders::HeaderScanner::ScannedHeader header;
+    ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Header,
+              scanner.Next<MessageHeaders::HttpProfile>(rawMessage, header));
+    ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Header,
+              scanner.Next<MessageHeaders::HttpProfile>(rawMessage, header));
+    ASSERT_EQ("X-Folded", MessageHeaders::HeaderScanner::GetName(rawMessage, header));
+    ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Error,
+              scanner.Next<MessageHeaders::HttpProfile>(rawMessage, header));
+}
+
+TEST(HeaderScannerTests, ProfileStrictnessOverridesConfiguredStrictness)
+{
+    const std::string rawMessage =
+        "X[Bad]: value\r\n"
+        "\r\n";
+    MessageHeaders::HeaderScanner scanner;
+    MessageHeaders::HeaderScanner::ScannedHeader header;
+    scanner.SetStrictness(MessageHeaders::HeaderScanner::Strictness::Http);
+    ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Header,
+              scanner.Next<MessageHeaders::EmailProfile>(rawMessage, header));
+    ASSERT_TRUE(header.validName);
+    MessageHeaders::HeaderScanner httpScanner;
+    ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Header,
+              httpScanner.Next<MessageHeaders::HttpProfile>(rawMessage, header));
+    ASSERT_FALSE(header.validName);
+}
+
+TEST(HeaderScannerTests, LimitsReachedExactlyWithLineTerminatorSplit)
+{
+    const std::string rawMessage =
+        "A: b\r\n"
+        "\r\n";
+    for (size_t split = 1; split < rawMessage.length(); ++split)
+    {
+        MessageHeaders::HeaderScanner scanner;
+        MessageHeaders::HeaderScanner::Limits limits;
+        limits.blockSize = rawMessage.length();
+        scanner.SetLimits(limits);
+        scanner.SetLineLimit(6);
+        MessageHeaders::HeaderScanner::ScannedHeader header;
+        auto result = MessageHeaders::HeaderScanner::Result::Header;
+        while (result == MessageHeaders::HeaderScanner::Result::Header)
+        {
+            result = scanner.Next(std::string_view(rawMessage).substr(0, split), header);
+        }
+        ASSERT_EQ(MessageHeaders::HeaderScanner::Result::Incomplete, result) << split;
+        result = MessageHeaders::HeaderScanner::Result::Header;
+        while (result == MessageHeaders::HeaderScanner::Result::Header)
+        {
+            result = scanner.Next(rawMessage, header);
+        }
+        ASSERT_EQ(MessageHeaders::HeaderScanner::Result::End, result) << split;
+    }
+}
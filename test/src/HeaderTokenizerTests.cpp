@@ -0,0 +1,89 @@
+/**
+ * @file HeaderTokenizerTests.cpp
+ *
+ * This module contains unit Tests of the MessageHeaders::HeaderTokenizer class
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <gtest/gtest.h>
+#include <MessageHeaders/HeaderTokenizer.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    /**
+     * This function collects all the tokens found by the given tokenizer.
+     *
+     * @param[in,out] tokenizer
+     *      This is the tokenizer to drain.
+     *
+     * @return
+     *      The tokens found are returned.
+     */
+    std::vector<std::string_view> Tokens(MessageHeaders::HeaderTokenizer& tokenizer)
+    {
+        std::vector<std::string_view> tokens;
+        std::string_view token;
+        while (tokenizer.Next(token))
+        {
+            tokens.push_back(token);
+        }
+        return tokens;
+    }
+}  // namespace
+
+TEST(HeaderTokenizerTests, SplitAndTrimTokens)
+{
+    const std::string value = " gzip,deflate , br\t";
+    MessageHeaders::HeaderTokenizer tokenizer(value);
+    const auto tokens = Tokens(tokenizer);
+    ASSERT_EQ((std::vector<std::string_view>{"gzip", "deflate", "br"}), tokens);
+    for (const auto& token : tokens)
+    {
+        ASSERT_GE(token.data(), value.data());
+        ASSERT_LE(token.data() + token.length(), value.data() + value.length());
+    }
+}
+
+TEST(HeaderTokenizerTests, KeepWhitespaceWhenNotTrimming)
+{
+    MessageHeaders::HeaderTokenizer tokenizer(" a, b ", false);
+    ASSERT_EQ((std::vector<std::string_view>{" a", " b "}), Tokens(tokenizer));
+}
+
+TEST(HeaderTokenizerTests, SkipEmptyElements)
+{
+    MessageHeaders::HeaderTokenizer tokenizer(",a,, ,b,");
+    ASSERT_EQ((std::vector<std::string_view>{"a", "b"}), Tokens(tokenizer));
+    MessageHeaders::HeaderTokenizer emptyTokenizer("");
+    ASSERT_TRUE(Tokens(emptyTokenizer).empty());
+}
+
+TEST(HeaderTokenizerTests, DelimitersInsideQuotedStrings)
+{
+    const std::string value = "\"Smith, Bob\" <sip:bob@example.com>, \"a \\\", b\" c, d";
+    MessageHeaders::HeaderTokenizer quotedTokenizer(value);
+    ASSERT_EQ((std::vector<std::string_view>{"\"Smith, Bob\" <sip:bob@example.com>",
+                                             "\"a \\\", b\" c", "d"}),
+              Tokens(quotedTokenizer));
+    MessageHeaders::HeaderTokenizer plainTokenizer(value, true, false);
+    ASSERT_EQ((std::vector<std::string_view>{"\"Smith", "Bob\" <sip:bob@example.com>",
+                                             "\"a \\\"", "b\" c", "d"}),
+              Tokens(plainTokenizer));
+}
+
+TEST(HeaderTokenizerTests, UnterminatedQuotedStringEndsAtEndOfValue)
+{
+    MessageHeaders::HeaderTokenizer tokenizer("a, \"b, c");
+    ASSERT_EQ((std::vector<std::string_view>{"a", "\"b, c"}), Tokens(tokenizer));
+}
+
+TEST(HeaderTokenizerTests, OtherDelimiter)
+{
+    MessageHeaders::HeaderTokenizer tokenizer("text/html; charset=utf-8 ;q=0.9", true, true, ';');
+    ASSERT_EQ((std::vector<std::string_view>{"text/html", "charset=utf-8", "q=0.9"}),
+              Tokens(tokenizer));
+}
@@ -0,0 +1,53 @@
+/**
+ * @file InstrumentationTests.cpp
+ *
+ * This module contains unit Tests of the MessageHeaders::Instrumentation class
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <gtest/gtest.h>
+#include <MessageHeaders/Instrumentation.hpp>
+#include <MessageHeaders/MessageHeaders.hpp>
+#include <string>
+
+TEST(InstrumentationTests, CountParsingLookupAndGeneration)
+{
+    MessageHeaders::Instrumentation::Reset();
+    MessageHeaders::MessageHeaders headers;
+    headers.SetLineLimit(30);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Incomplete,
+              headers.ParseRawMessage("Host: www.example.com\r\nSubject: Hel"));
+    ASSERT_EQ(
+        MessageHeaders::MessageHeaders::State::Complete,
+        headers.ParseRawMessage("Host: www.example.com\r\nSubject: Hello,\r\n World\r\n\r\n"));
+    ASSERT_TRUE(headers.HasHeader("Host"));
+    ASSERT_FALSE(headers.HasHeader("To"));
+    headers.SetHeader("To", "Bob <sip:bob@biloxi.com> ;tag=1928301774");
+    const auto rawHeaders = headers.GenerateRawHeaders();
+    MessageHeaders::MessageHeaders other;
+    other.SetLineLimit(30);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Error,
+              other.ParseRawMessage("X-Rather-Long-Header-Name: With a long value\r\n\r\n"));
+    const auto snapshot = MessageHeaders::Instrumentation::GetSnapshot();
+    if (!MessageHeaders::Instrumentation::IsEnabled())
+    {
+        ASSERT_EQ(0, snapshot.messagesParsed);
+        ASSERT_EQ(0, snapshot.lookupHits);
+        return;
+    }
+    ASSERT_EQ(1, snapshot.messagesParsed);
+    ASSERT_EQ(2, snapshot.headersParsed);
+    ASSERT_EQ(1, snapshot.foldedHeadersParsed);
+    ASSERT_EQ(1, snapshot.incompleteParses);
+    ASSERT_EQ(1, snapshot.bytesRescanned);
+    ASSERT_EQ(1, snapshot.parseErrors);
+    ASSERT_EQ(1, snapshot.lineLimitErrors);
+    ASSERT_EQ(1, snapshot.lookupHits);
+    ASSERT_EQ(1, snapshot.lookupMisses);
+    ASSERT_EQ(1, snapshot.rawHeadersGenerated);
+    ASSERT_EQ(rawHeaders.length(), snapshot.rawBytesGenerated);
+    ASSERT_EQ(1, snapshot.headerLinesFolded);
+    MessageHeaders::Instrumentation::Reset();
+    ASSERT_EQ(0, MessageHeaders::Instrumentation::GetSnapshot().messagesParsed);
+}
@@ -0,0 +1,76 @@
+/**
+ * @file MappedFileTests.cpp
+ *
+ * This module contains unit Tests of the MessageHeaders::MappedFile class
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stdio.h>
+#include <gtest/gtest.h>
+#include <MessageHeaders/MappedFile.hpp>
+#include <string>
+#include <utility>
+
+namespace
+{
+    /**
+     * This is the path of the file made by the tests.
+     */
+    const std::string TestFilePath = "MappedFileTests.txt";
+
+    /**
+     * This function replaces the file made by the tests
+     * with one holding the given contents.
+     *
+     * @param[in] contents
+     *      These are the contents to put in the file.
+     */
+    void MakeTestFile(const std::string& contents)
+    {
+        const auto file = fopen(TestFilePath.c_str(), "wb");
+        ASSERT_FALSE(file == NULL);
+        ASSERT_EQ(contents.length(), fwrite(contents.data(), 1, contents.length(), file));
+        (void)fclose(file);
+    }
+}  // namespace
+
+TEST(MappedFileTests, MapFileContents)
+{
+    const std::string contents =
+        "From: Joe Smith <joe@example.com>\r\n"
+        "Subject: Hello\r\n"
+        "\r\n"
+        "Hi there!\r\n";
+    MakeTestFile(contents);
+    MessageHeaders::MappedFile file;
+    ASSERT_FALSE(file.IsOpen());
+    ASSERT_TRUE(file.Open(TestFilePath));
+    ASSERT_TRUE(file.IsOpen());
+    ASSERT_EQ(contents, file.GetContents());
+    auto other = std::move(file);
+    ASSERT_EQ(contents, other.GetContents());
+    other.Close();
+    ASSERT_FALSE(other.IsOpen());
+    ASSERT_TRUE(other.GetContents().empty());
+    (void)remove(TestFilePath.c_str());
+}
+
+TEST(MappedFileTests, MapEmptyFile)
+{
+    MakeTestFile("");
+    MessageHeaders::MappedFile file;
+    ASSERT_TRUE(file.Open(TestFilePath));
+    ASSERT_TRUE(file.IsOpen());
+    ASSERT_TRUE(file.GetContents().empty());
+    (void)remove(TestFilePath.c_str());
+}
+
+TEST(MappedFileTests, MapMissingFile)
+{
+    (void)remove(TestFilePath.c_str());
+    MessageHeaders::MappedFile file;
+    ASSERT_FALSE(file.Open(TestFilePath));
+    ASSERT_FALSE(file.IsOpen());
+    ASSERT_TRUE(file.GetContents().empty());
+}
@@ -0,0 +1,186 @@
+/**
+ * @file MessageFileScannerTests.cpp
+ *
+ * This module contains unit Tests of the MessageHeaders::MessageFileScanner class
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stddef.h>
+#include <gtest/gtest.h>
+#include <MessageHeaders/MessageFileScanner.hpp>
+#include <atomic>
+#include <string>
+#include <vector>
+
+TEST(MessageFileScannerTests, IndexMboxWithCrLf)
+{
+    const std::string contents =
+        "From joe@example.com Mon Jan  1 00:00:00 2024\r\n"
+        "From: Joe Smith <joe@example.com>\r\n"
+        "Subject: Hello\r\n"
+        "\r\n"
+        "Hi there!\r\n"
+        "\r\n"
+        "From sue@example.com Mon Jan  1 00:01:00 2024\r\n"
+        "From: Sue Smith <sue@example.com>\r\n"
+        "Subject: Re: Hello\r\n"
+        "\r\n"
+        "I hear, hi!\r\n";
+    const MessageHeaders::MessageFileScanner scanner;
+    const auto messages = scanner.Index(contents);
+    ASSERT_EQ(2, messages.size());
+    const auto second = contents.find("From sue");
+    ASSERT_EQ(0, messages[0].offset);
+    ASSERT_EQ(contents.find("From: Joe"), messages[0].headersOffset);
+    ASSERT_EQ(contents.find("Hi there"), messages[0].bodyOffset);
+    ASSERT_EQ(second, messages[0].end);
+    ASSERT_EQ(MessageHeaders::MessageFileScanner::State::Complete, messages[0].state);
+    ASSERT_TRUE(messages[0].valid);
+    ASSERT_EQ(second, messages[1].offset);
+    ASSERT_EQ(contents.find("From: Sue"), messages[1].headersOffset);
+    ASSERT_EQ(contents.find("I hear"), messages[1].bodyOffset);
+    ASSERT_EQ(contents.length(), messages[1].end);
+    ASSERT_EQ(MessageHeaders::MessageFileScanner::State::Complete, messages[1].state);
+}
+
+TEST(MessageFileScannerTests, IndexMboxWithLf)
+{
+    const std::string contents =
+        "From joe@example.com Mon Jan  1 00:00:00 2024\n"
+        "From: Joe Smith <joe@example.com>\n"
+        "Subject: Hello\n"
+        "\n"
+        "Hi there!\n"
+        "\n"
+        "From sue@example.com Mon Jan  1 00:01:00 2024\n"
+        "From: Sue Smith <sue@example.com>\n"
+        "Subject: Re: Hello,\n"
+        " again\n"
+        "\n"
+        "Hi!\n";
+    const MessageHeaders::MessageFileScanner scanner;
+    std::vector<std::string> subjects;
+    std::vector<std::string> bodies;
+    scanner.ForEachMessage(
+        contents,
+        [&](const MessageHeaders::MessageFileScanner::Message& message,
+            const MessageHeaders::MessageHeadersView& headers)
+        {
+            ASSERT_EQ(MessageHeaders::MessageFileScanner::State::Complete, message.state);
+            subjects.emplace_back(headers.GetHeaderValue("Subject"));
+            bodies.push_back(contents.substr(message.bodyOffset,
+                                             message.end - message.bodyOffset));
+        });
+    ASSERT_EQ((std::vector<std::string>{"Hello", "Re: Hello, again"}), subjects);
+    ASSERT_EQ((std::vector<std::string>{"Hi there!\n\n", "Hi!\n"}), bodies);
+}
+
+TEST(MessageFileScannerTests, IndexIncompleteMbox)
+{
+    const std::string contents =
+        "From joe@example.com Mon Jan  1 00:00:00 2024\r\n"
+        "From: Joe Smith <joe@example.com>\r\n"
+        "Subject: Hel";
+    const MessageHeaders::MessageFileScanner scanner;
+    const auto messages = scanner.Index(contents);
+    ASSERT_EQ(1, messages.size());
+    ASSERT_EQ(MessageHeaders::MessageFileScanner::State::Incomplete, messages[0].state);
+    ASSERT_EQ(contents.length(), messages[0].bodyOffset);
+    ASSERT_EQ(contents.length(), messages[0].end);
+}
+
+TEST(MessageFileScannerTests, ParallelIndexMatchesSequential)
+{
+    std::string contents;
+    for (size_t i = 0; i < 500; ++i)
+    {
+        contents += "From joe@example.com Mon Jan  1 00:00:00 2024\r\n";
+        contents += "Message-ID: <" + std::to_string(i) + "@example.com>\r\n";
+        contents += "Subject: Hello\r\n";
+        contents += "\r\n";
+        contents += std::string(i % 37, 'x') + "\r\n";
+        contents += "\r\n";
+    }
+    const MessageHeaders::MessageFileScanner sequential;
+    const auto expected = sequential.Index(contents);
+    ASSERT_EQ(500, expected.size());
+    for (const size_t threadCount : {2, 3, 8, 1000})
+    {
+        const MessageHeaders::MessageFileScanner parallel(
+            MessageHeaders::MessageFileScanner::Framing::Mbox, threadCount);
+        const auto actual = parallel.Index(contents);
+        ASSERT_EQ(expected.size(), actual.size()) << threadCount;
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            ASSERT_EQ(expected[i].offset, actual[i].offset);
+            ASSERT_EQ(expected[i].headersOffset, actual[i].headersOffset);
+            ASSERT_EQ(expected[i].bodyOffset, actual[i].bodyOffset);
+            ASSERT_EQ(expected[i].end, actual[i].end);
+        }
+        std::atomic<size_t> messageCount(0);
+        parallel.ForEachMessage(contents,
+                                [&](const MessageHeaders::MessageFileScanner::Message&,
+                                    const MessageHeaders::MessageHeadersView& headers)
+                                {
+                                    if (headers.HasHeader("Message-ID"))
+                                    {
+                                        ++messageCount;
+                                    }
+                                });
+        ASSERT_EQ(500, messageCount);
+    }
+}
+
+TEST(MessageFileScannerTests, IndexSipTrace)
+{
+    const std::string contents =
+        "INVITE sip:bob@example.com SIP/2.0\r\n"
+        "Call-ID: a84b4c76e66710\r\n"
+        "Content-Length: 4\r\n"
+        "\r\n"
+        "v=0\n"
+        "\r\n"
+        "\r\n"
+        "SIP/2.0 180 Ringing\r\n"
+        "i: a84b4c76e66710\r\n"
+        "l: 0\r\n"
+        "\r\n"
+        "ACK sip:bob@example.com SIP/2.0\r\n"
+        "Call-ID: a84b4c76e66710\r\n"
+        "\r\n";
+    const MessageHeaders::MessageFileScanner scanner(
+        MessageHeaders::MessageFileScanner::Framing::ContentLength);
+    scanner.ForEachMessage(contents,
+                           [&](const MessageHeaders::MessageFileScanner::Message& message,
+                               const MessageHeaders::MessageHeadersView&)
+                           { ASSERT_TRUE(message.valid); });
+    const auto messages = scanner.Index(contents);
+    ASSERT_EQ(3, messages.size());
+    ASSERT_EQ(0, messages[0].offset);
+    ASSERT_EQ(contents.find("v=0"), messages[0].bodyOffset);
+    ASSERT_EQ(contents.find("v=0") + 4, messages[0].end);
+    ASSERT_EQ(contents.find("SIP/2.0 180"), messages[1].offset);
+    ASSERT_EQ(contents.find("ACK"), messages[1].end);
+    ASSERT_EQ(messages[1].end, messages[1].bodyOffset);
+    ASSERT_EQ(contents.find("ACK"), messages[2].offset);
+    ASSERT_EQ(contents.length(), messages[2].end);
+}
+
+TEST(MessageFileScannerTests, IndexTruncatedSipTrace)
+{
+    const std::string contents =
+        "INVITE sip:bob@example.com SIP/2.0\r\n"
+        "Content-Length: 100\r\n"
+        "\r\n"
+        "v=0\r\n"
+        "MESSAGE sip:bob@example.com SIP/2.0\r\n"
+        "Content-Length: x\r\n"
+        "\r\n";
+    const MessageHeaders::MessageFileScanner scanner(
+        MessageHeaders::MessageFileScanner::Framing::ContentLength);
+    const auto messages = scanner.Index(contents);
+    ASSERT_EQ(1, messages.size());
+    ASSERT_EQ(contents.length(), messages[0].end);
+    ASSERT_TRUE(messages[0].valid);
+}
@@ -0,0 +1,132 @@
+/**
+ * @file MessageHeadersPoolTests.cpp
+ *
+ * This module contains unit Tests of the MessageHeaders::MessageHeadersPool class
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <gtest/gtest.h>
+#include <MessageHeaders/MessageHeadersPool.hpp>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /**
+     * This is a memory resource which counts the allocations made from it.
+     */
+    struct CountingMemoryResource : public std::pmr::memory_resource
+    {
+        size_t allocations = 0;
+        size_t deallocations = 0;
+
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override
+        {
+            ++deallocations;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+}  // namespace
+
+TEST(MessageHeadersPoolTests, ReleasedHeadersHandedOutAgainEmpty)
+{
+    MessageHeaders::MessageHeadersPool pool;
+    ASSERT_EQ(0, pool.GetIdleCount());
+    auto headers = pool.Acquire();
+    headers.SetLazyValues(true);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              headers.ParseRawMessage("From: alice@example.com\r\n"
+                                      "Subject: first line\r\n"
+                                      "  second line\r\n"
+                                      "\r\n"));
+    pool.Release(std::move(headers));
+    ASSERT_EQ(1, pool.GetIdleCount());
+    auto reused = pool.Acquire();
+    ASSERT_EQ(0, pool.GetIdleCount());
+    ASSERT_TRUE(reused.GetAll().empty());
+    ASSERT_TRUE(reused.IsValid());
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              reused.ParseRawMessage("To: bob@example.com\r\n\r\n"));
+    ASSERT_EQ("bob@example.com", reused.GetHeaderValue("To"));
+}
+
+TEST(MessageHeadersPoolTests, IdleObjectsLimited)
+{
+    MessageHeaders::MessageHeadersPool pool(2);
+    std::vector<MessageHeaders::MessageHeaders> inUse;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        inUse.push_back(pool.Acquire());
+    }
+    for (auto& headers : inUse)
+    {
+        pool.Release(std::move(headers));
+    }
+    ASSERT_EQ(2, pool.GetIdleCount());
+}
+
+TEST(MessageHeadersPoolTests, HeadersBeyondIdleLimitDestroyed)
+{
+    CountingMemoryResource resource;
+    MessageHeaders::MessageHeadersPool pool(1, &resource);
+    auto kept = pool.Acquire();
+    auto extra = pool.Acquire();
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              extra.ParseRawMessage("X-Header: a value long enough not to fit "
+                                    "into a short string buffer\r\n\r\n"));
+    pool.Release(std::move(kept));
+    const auto deallocationsBeforeRelease = resource.deallocations;
+    pool.Release(std::move(extra));
+    ASSERT_EQ(1, pool.GetIdleCount());
+    ASSERT_GT(resource.deallocations, deallocationsBeforeRelease);
+}
+
+TEST(MessageHeadersPoolTests, SteadyStateParsingDoesNotAllocate)
+{
+    std::string rawMessage;
+    for (size_t i = 0; i < 20; ++i)
+    {
+        rawMessage += "X-Header-" + std::to_string(i) + ": a value long enough not to fit "
+                      "into a short string buffer\r\n";
+    }
+    rawMessage += "\r\n";
+    CountingMemoryResource resource;
+    MessageHeaders::MessageHeadersPool pool(4, &resource);
+    const auto parseMessages = [&]
+    {
+        std::vector<MessageHeaders::MessageHeaders> inUse;
+        inUse.reserve(4);
+        for (size_t i = 0; i < 4; ++i)
+        {
+            inUse.push_back(pool.Acquire());
+            ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                      inUse.back().ParseRawMessage(rawMessage));
+            ASSERT_EQ("a value long enough not to fit into a short string buffer",
+                      inUse.back().GetHeaderValue("X-Header-7"));
+        }
+        for (auto& headers : inUse)
+        {
+            pool.Release(std::move(headers));
+        }
+    };
+    parseMessages();
+    const auto allocationsAfterWarmUp = resource.allocations;
+    for (size_t i = 0; i < 10; ++i)
+    {
+        parseMessages();
+    }
+    ASSERT_EQ(allocationsAfterWarmUp, resource.allocations);
+}
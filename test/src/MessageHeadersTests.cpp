@@ -8,9 +8,42 @@
 
 #include <gtest/gtest.h>
 #include <MessageHeaders/MessageHeaders.hpp>
+#include <iterator>
+#include <memory_resource>
 #include <string>
 #include <vector>
 
+namespace
+{
+    /**
+     * This is a memory resource which counts how many allocations
+     * are made from it, passing them on to the default resource.
+     */
+    struct CountingMemoryResource : public std::pmr::memory_resource
+    {
+        size_t allocations = 0;
+        size_t bytesInUse = 0;
+
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            ++allocations;
+            bytesInUse += bytes;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override
+        {
+            bytesInUse -= bytes;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+}  // namespace
+
 TEST(MessageHeadersTests, PlaceHolder_Test)
 {
     MessageHeaders::MessageHeaders headers;
@@ -564,3 +597,1125 @@ TEST(MessageHeadersTests, GetValueOfPresentHeader)
     ASSERT_TRUE(headers.IsValid());
     ASSERT_EQ("www.example.com", headers.GetHeaderValue("Host"));
 }
+
+TEST(MessageHeadersTests, IncrementalParseResumesWhereItLeftOff)
+{
+    const std::string rawMessage =
+        ("User-Agent: curl/7.16.3 libcurl/7.163 OpenSSL/0.9.7l zlib/1.2.3\r\n"
+         "Host: www.example.com\r\n"
+         "Subject: This\r\n"
+         " is a test\r\n"
+         "Accept-Language: en, mi\r\n"
+         "\r\n"
+         "Hello!");
+    const size_t headersLength = rawMessage.length() - 6;
+    MessageHeaders::MessageHeaders headers;
+    std::string buffer;
+    size_t bodyOffset = 0;
+    size_t previouslyConsumed = 0;
+    for (size_t i = 0; i < rawMessage.length(); ++i)
+    {
+        buffer += rawMessage[i];
+        const auto state = headers.ParseRawMessage(buffer, bodyOffset);
+        if (buffer.length() < headersLength)
+        {
+            ASSERT_EQ(MessageHeaders::MessageHeaders::State::Incomplete, state) << i;
+            ASSERT_LE(previouslyConsumed, bodyOffset) << i;
+            ASSERT_LE(bodyOffset, buffer.length()) << i;
+            previouslyConsumed = bodyOffset;
+        }
+        else
+        {
+            ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete, state) << i;
+            ASSERT_EQ(headersLength, bodyOffset) << i;
+            break;
+        }
+    }
+    ASSERT_TRUE(headers.IsValid());
+    const auto headersCollection = headers.GetAll();
+    ASSERT_EQ(4, headersCollection.size());
+    ASSERT_EQ("www.example.com", headers.GetHeaderValue("Host"));
+    ASSERT_EQ("This is a test", headers.GetHeaderValue("Subject"));
+    ASSERT_EQ("en, mi", headers.GetHeaderValue("Accept-Language"));
+}
+
+TEST(MessageHeadersTests, IncrementalParseDoesNotDuplicateHeaders)
+{
+    MessageHeaders::MessageHeaders headers;
+    size_t bodyOffset;
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Incomplete,
+              headers.ParseRawMessage("Host: www.example.com\r\nVia: a\r\n", bodyOffset));
+    ASSERT_EQ(31, bodyOffset);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              headers.ParseRawMessage("Host: www.example.com\r\nVia: a\r\n\r\n", bodyOffset));
+    ASSERT_EQ(33, bodyOffset);
+    ASSERT_EQ((std::vector<MessageHeaders::MessageHeaders::HeaderValue>{"www.example.com"}),
+              headers.GetHeaderMultiValues("Host"));
+    ASSERT_EQ((std::vector<MessageHeaders::MessageHeaders::HeaderValue>{"a"}),
+              headers.GetHeaderMultiValues("Via"));
+}
+
+TEST(MessageHeadersTests, IncrementalParseRestartsOnShorterMessage)
+{
+    MessageHeaders::MessageHeaders headers;
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Incomplete,
+              headers.ParseRawMessage("Host: www.example.com\r\nVia: a\r\n"));
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              headers.ParseRawMessage("To: Bob\r\n\r\n"));
+    ASSERT_EQ(1, headers.GetAll().size());
+    ASSERT_EQ("Bob", headers.GetHeaderValue("To"));
+    ASSERT_FALSE(headers.HasHeader("Host"));
+}
+
+TEST(MessageHeadersTests, IncrementalParseRestartsOnMessageShorterThanFirstLineScanned)
+{
+    MessageHeaders::MessageHeaders headers;
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Incomplete,
+              headers.ParseRawMessage("X-Long-Name-Here: val"));
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              headers.ParseRawMessage("To: Bob\r\n\r\n"));
+    ASSERT_EQ(1, headers.GetAll().size());
+    ASSERT_EQ("Bob", headers.GetHeaderValue("To"));
+}
+
+TEST(MessageHeadersTests, HeadersAllocatedFromGivenMemoryResource)
+{
+    CountingMemoryResource resource;
+    {
+        MessageHeaders::MessageHeaders headers(&resource);
+        const std::string rawMessage =
+            "User-Agent: curl/7.16.3 libcurl/7.163 OpenSSL/0.9.7l zlib/1.2.3\r\n"
+            "X-Really-Long-Header-Name: www.example.com/with/a/long/path\r\n"
+            "\r\n";
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                  headers.ParseRawMessage(rawMessage));
+        ASSERT_LT(0, resource.allocations);
+        const auto allocationsAfterParse = resource.allocations;
+        headers.AddHeader("X-Another-Really-Long-Header-Name", "with an even longer value");
+        ASSERT_LT(allocationsAfterParse, resource.allocations);
+        ASSERT_EQ("www.example.com/with/a/long/path",
+                  headers.GetHeaderValue("X-Really-Long-Header-Name"));
+        ASSERT_EQ("with an even longer value",
+                  headers.GetHeaderValue("X-Another-Really-Long-Header-Name"));
+    }
+    ASSERT_EQ(0, resource.bytesInUse);
+}
+
+TEST(MessageHeadersTests, HeadersAllocatedFromArena)
+{
+    alignas(std::max_align_t) char buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+                                              std::pmr::null_memory_resource());
+    MessageHeaders::MessageHeaders headers(&arena);
+    const std::string rawMessage =
+        "User-Agent: curl/7.16.3 libcurl/7.163 OpenSSL/0.9.7l zlib/1.2.3\r\n"
+        "Subject: This\r\n"
+        " is a test of a folded header value\r\n"
+        "\r\n";
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              headers.ParseRawMessage(rawMessage));
+    ASSERT_EQ("This is a test of a folded header value", headers.GetHeaderValue("Subject"));
+}
+
+TEST(MessageHeadersTests, LookupsInMessageWithManyHeaders)
+{
+    MessageHeaders::MessageHeaders headers;
+    std::string rawMessage;
+    for (size_t i = 0; i < 40; ++i)
+    {
+        rawMessage += "X-Header-" + std::to_string(i) + ": value " + std::to_string(i) + "\r\n";
+        if (i % 10 == 0)
+        {
+            rawMessage += "Via: hop " + std::to_string(i / 10) + "\r\n";
+        }
+    }
+    rawMessage += "\r\n";
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete, headers.ParseRawMessage(rawMessage));
+    for (size_t i = 0; i < 40; ++i)
+    {
+        ASSERT_TRUE(headers.HasHeader("x-header-" + std::to_string(i))) << i;
+        ASSERT_EQ("value " + std::to_string(i),
+                  headers.GetHeaderValue("X-HEADER-" + std::to_string(i)))
+            << i;
+    }
+    ASSERT_FALSE(headers.HasHeader("X-Header-40"));
+    ASSERT_EQ((std::vector<MessageHeaders::MessageHeaders::HeaderValue>{"hop 0", "hop 1", "hop 2",
+                                                                          "hop 3"}),
+              headers.GetHeaderMultiValues("via"));
+    headers.AddHeader("VIA", "hop 4");
+    headers.AddHeader("X-Header-40", "value 40");
+    ASSERT_EQ("value 40", headers.GetHeaderValue("X-Header-40"));
+    ASSERT_EQ((std::vector<MessageHeaders::MessageHeaders::HeaderValue>{"hop 0", "hop 1", "hop 2",
+                                                                          "hop 3", "hop 4"}),
+              headers.GetHeaderMultiValues("Via"));
+    headers.RemoveHeader("X-Header-5");
+    ASSERT_FALSE(headers.HasHeader("X-Header-5"));
+    ASSERT_EQ("value 6", headers.GetHeaderValue("X-Header-6"));
+    headers.SetHeader("Via", "only hop");
+    ASSERT_EQ((std::vector<MessageHeaders::MessageHeaders::HeaderValue>{"only hop"}),
+              headers.GetHeaderMultiValues("Via"));
+    ASSERT_EQ("value 39", headers.GetHeaderValue("X-Header-39"));
+    const auto headersCollection = headers.GetAll();
+    ASSERT_EQ(41, headersCollection.size());
+    ASSERT_EQ("X-Header-0", headersCollection[0].name);
+    ASSERT_EQ("Via", headersCollection[1].name);
+    ASSERT_EQ("only hop", headersCollection[1].value);
+    ASSERT_EQ("X-Header-40", headersCollection[40].name);
+}
+
+TEST(MessageHeadersTests, HeaderNameHashIsCaseInsensitive)
+{
+    const MessageHeaders::MessageHeaders::HeaderName name("Content-Type");
+    ASSERT_EQ(name.GetHash(), MessageHeaders::MessageHeaders::HeaderName("content-type").GetHash());
+    ASSERT_EQ(name.GetHash(), MessageHeaders::MessageHeaders::HeaderName("CONTENT-TYPE").GetHash());
+    ASSERT_NE(name.GetHash(),
+              MessageHeaders::MessageHeaders::HeaderName("Content-Length").GetHash());
+    MessageHeaders::MessageHeaders::HeaderName assigned;
+    assigned = std::string("content-TYPE");
+    ASSERT_EQ(name, assigned);
+}
+
+TEST(MessageHeadersTests, WellKnownHeaderNamesCarryIdentifiers)
+{
+    ASSERT_EQ(MessageHeaders::WellKnownHeader::ContentLength,
+              MessageHeaders::MessageHeaders::HeaderName("content-length").GetId());
+    ASSERT_EQ(MessageHeaders::WellKnownHeader::CallId,
+              MessageHeaders::MessageHeaders::HeaderName("CALL-ID").GetId());
+    ASSERT_EQ(MessageHeaders::WellKnownHeader::Via,
+              MessageHeaders::MessageHeaders::HeaderName(std::string("Via")).GetId());
+    ASSERT_EQ(MessageHeaders::WellKnownHeader::Unknown,
+              MessageHeaders::MessageHeaders::HeaderName("X-Poggers").GetId());
+    ASSERT_EQ(MessageHeaders::WellKnownHeader::Unknown,
+              MessageHeaders::MessageHeaders::HeaderName("Content-Lengths").GetId());
+    ASSERT_EQ(MessageHeaders::WellKnownHeader::Unknown,
+              MessageHeaders::MessageHeaders::HeaderName().GetId());
+    for (auto id = (size_t)MessageHeaders::WellKnownHeader::Accept;
+         id <= (size_t)MessageHeaders::WellKnownHeader::XForwardedProto; ++id)
+    {
+        const auto wellKnownName =
+            MessageHeaders::GetWellKnownHeaderName((MessageHeaders::WellKnownHeader)id);
+        const MessageHeaders::MessageHeaders::HeaderName name((std::string(wellKnownName)));
+        ASSERT_EQ(id, (size_t)name.GetId()) << (std::string)name;
+    }
+    ASSERT_EQ("", MessageHeaders::GetWellKnownHeaderName(MessageHeaders::WellKnownHeader::Unknown));
+}
+
+TEST(MessageHeadersTests, WellKnownAndUnknownHeaderNamesCompare)
+{
+    using HeaderName = MessageHeaders::MessageHeaders::HeaderName;
+    ASSERT_EQ(HeaderName("CSeq"), HeaderName("cseq"));
+    ASSERT_FALSE(HeaderName("CSeq") == HeaderName("Call-ID"));
+    ASSERT_FALSE(HeaderName("CSeq") == HeaderName("X-CSeq"));
+    ASSERT_EQ(HeaderName("X-Poggers"), HeaderName("x-poggers"));
+    MessageHeaders::MessageHeaders headers;
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              headers.ParseRawMessage("cseq: 314159 INVITE\r\nX-Poggers: yes\r\n\r\n"));
+    ASSERT_EQ("314159 INVITE", headers.GetHeaderValue("CSeq"));
+    ASSERT_EQ("yes", headers.GetHeaderValue("X-POGGERS"));
+    ASSERT_FALSE(headers.HasHeader("Call-ID"));
+}
+
+TEST(MessageHeadersTests, ControlCharacterInHeaderValueIsInvalid)
+{
+    const std::vector<std::string> badValues{
+        "This has a \x01 in it",
+        "This has a lone \r carriage return",
+        "This has a lone \n line feed",
+        "This value is longer than a block and has a DEL \x7f character",
+    };
+    for (const auto& badValue : badValues)
+    {
+        MessageHeaders::MessageHeaders headers;
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                  headers.ParseRawMessage("Subject: " + badValue + "\r\nTo: Bob\r\n\r\n"));
+        ASSERT_FALSE(headers.IsValid()) << badValue;
+        ASSERT_EQ("Bob", headers.GetHeaderValue("To"));
+    }
+    MessageHeaders::MessageHeaders headers;
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              headers.ParseRawMessage("Subject: tab\tand caf\xc3\xa9\r\n"
+                                      " and \x02 on a folded line\r\n"
+                                      "\r\n"));
+    ASSERT_FALSE(headers.IsValid());
+    headers = MessageHeaders::MessageHeaders();
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              headers.ParseRawMessage("Subject: tab\tand caf\xc3\xa9\r\n\r\n"));
+    ASSERT_TRUE(headers.IsValid());
+}
+
+TEST(MessageHeadersTests, HeaderNameRulesDependOnStrictness)
+{
+    struct TestVector
+    {
+        std::string name;
+        bool email;
+        bool http;
+        bool sip;
+    };
+    const std::vector<TestVector> testVectors{
+        {"X-Poggers", true, true, true},
+        {"X-Po#ggers", true, true, false},
+        {"X-Po\"ggers", true, false, false},
+        {"X-Po(ggers)", true, false, false},
+        {"X-Po ggers", false, false, false},
+        {"X-Po\xc3\xa9ggers", false, false, false},
+        {"", false, false, false},
+    };
+    for (const auto& testVector : testVectors)
+    {
+        const auto rawMessage = testVector.name + ": yes\r\n\r\n";
+        MessageHeaders::MessageHeaders email;
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                  email.ParseRawMessage(rawMessage));
+        ASSERT_EQ(testVector.email, email.IsValid()) << testVector.name;
+        MessageHeaders::MessageHeaders http;
+        http.SetStrictness(MessageHeaders::MessageHeaders::Strictness::Http);
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                  http.ParseRawMessage(rawMessage));
+        ASSERT_EQ(testVector.http, http.IsValid()) << testVector.name;
+        MessageHeaders::MessageHeaders sip;
+        sip.SetStrictness(MessageHeaders::MessageHeaders::Strictness::Sip);
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                  sip.ParseRawMessage(rawMessage));
+        ASSERT_EQ(testVector.sip, sip.IsValid()) << testVector.name;
+    }
+}
+
+TEST(MessageHeadersTests, GenerateRawHeadersIntoBuffer)
+{
+    MessageHeaders::MessageHeaders headers;
+    headers.AddHeader("Via", "SIP/2.0/UDP server10.biloxi.com ;branch=z9hG4bKnashds8");
+    headers.AddHeader("To", "Bob <sip:bob@biloxi.com>;tag=a6c85cf");
+    headers.AddHeader("Subject", "");
+    const std::string expectedRawHeaders =
+        "Via: SIP/2.0/UDP server10.biloxi.com ;branch=z9hG4bKnashds8\r\n"
+        "To: Bob <sip:bob@biloxi.com>;tag=a6c85cf\r\n"
+        "Subject: \r\n"
+        "\r\n";
+    ASSERT_EQ(expectedRawHeaders, headers.GenerateRawHeaders());
+    ASSERT_EQ(expectedRawHeaders.length(), headers.GetRawSize());
+    std::vector<char> buffer(expectedRawHeaders.length() + 1, '*');
+    ASSERT_EQ(expectedRawHeaders.length(),
+              headers.GenerateRawHeaders(buffer.data(), expectedRawHeaders.length() - 1));
+    ASSERT_EQ(std::string(buffer.size(), '*'), std::string(buffer.begin(), buffer.end()));
+    ASSERT_EQ(expectedRawHeaders.length(),
+              headers.GenerateRawHeaders(buffer.data(), buffer.size()));
+    ASSERT_EQ(expectedRawHeaders + "*", std::string(buffer.begin(), buffer.end()));
+}
+
+TEST(MessageHeadersTests, AppendRawHeadersToString)
+{
+    MessageHeaders::MessageHeaders headers;
+    headers.SetLineLimit(12);
+    headers.AddHeader("X", "This is even longer!");
+    headers.AddHeader("Y", "aaadadazdadcvbfdfvdf");
+    headers.AddHeader("Z", "Hello, World!");
+    const std::string expectedRawHeaders =
+        "X: This is\r\n"
+        " even\r\n"
+        " longer!\r\n"
+        "Z: Hello,\r\n"
+        " World!\r\n"
+        "\r\n";
+    ASSERT_EQ(expectedRawHeaders.length(), headers.GetRawSize());
+    std::string output = "GET / HTTP/1.1\r\n";
+    headers.AppendRawHeaders(output);
+    ASSERT_EQ("GET / HTTP/1.1\r\n" + expectedRawHeaders, output);
+}
+
+TEST(MessageHeadersTests, GenerateRawHeaderSpans)
+{
+    std::vector<size_t> lineLimits{0};
+    for (size_t lineLimit = 3; lineLimit < 80; ++lineLimit)
+    {
+        lineLimits.push_back(lineLimit);
+    }
+    for (const auto lineLimit : lineLimits)
+    {
+        MessageHeaders::MessageHeaders headers;
+        headers.SetLineLimit(lineLimit);
+        headers.AddHeader("X", "This is even longer!");
+        headers.AddHeader("Y", "aaadadazdadcvbfdfvdf");
+        headers.AddHeader("Z", "Hello, World!");
+        headers.AddHeader("Subject", "");
+        headers.AddHeader("Via", "SIP/2.0/UDP server10.biloxi.com ;branch=z9hG4bKnashds8");
+        std::vector<std::string_view> spans;
+        headers.GenerateRawHeaderSpans(spans);
+        std::string gathered;
+        for (const auto& span : spans)
+        {
+            ASSERT_FALSE(span.empty());
+            gathered += span;
+        }
+        ASSERT_EQ(headers.GenerateRawHeaders(), gathered) << lineLimit;
+    }
+}
+
+TEST(MessageHeadersTests, RawHeaderSpansReferToStoredHeaders)
+{
+    MessageHeaders::MessageHeaders headers;
+    headers.AddHeader("To", "Bob <sip:bob@biloxi.com>;tag=a6c85cf");
+    headers.AddHeader("Subject", "");
+    std::vector<std::string_view> spans;
+    headers.GenerateRawHeaderSpans(spans);
+    ASSERT_EQ((std::vector<std::string_view>{"To: Bob <sip:bob@biloxi.com>;tag=a6c85cf\r\n"
+                                             "Subject: \r\n",
+                                             "\r\n"}),
+              spans);
+    std::vector<std::string_view> secondSpans;
+    headers.GenerateRawHeaderSpans(secondSpans);
+    ASSERT_EQ(spans.size(), secondSpans.size());
+    for (size_t i = 0; i < spans.size(); ++i)
+    {
+        ASSERT_EQ(spans[i].data(), secondSpans[i].data()) << i;
+    }
+}
+
+TEST(MessageHeadersTests, LazyValuesMatchEagerValues)
+{
+    std::string rawMessage =
+        "Via: SIP/2.0/UDP server10.biloxi.com\r\n"
+        "   ;branch=z9hG4bKnashds8\r\n"
+        "Subject:    margins all around   \r\n"
+        "To: Bob\r\n"
+        "X-Empty:\r\n"
+        "Via: SIP/2.0/UDP pc33.atlanta.com ;branch=z9hG4bK776asdhds\r\n"
+        "\r\n";
+    MessageHeaders::MessageHeaders eager;
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete, eager.ParseRawMessage(rawMessage));
+    MessageHeaders::MessageHeaders lazy;
+    lazy.SetLazyValues(true);
+    size_t bodyOffset = 0;
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              lazy.ParseRawMessage(rawMessage, bodyOffset));
+    ASSERT_EQ(rawMessage.length(), bodyOffset);
+    rawMessage.assign(rawMessage.length(), '!');
+    ASSERT_EQ("Bob", lazy.GetHeaderValue("To"));
+    ASSERT_EQ(eager.GetHeaderMultiValues("Via"), lazy.GetHeaderMultiValues("Via"));
+    ASSERT_EQ("margins all around", lazy.GetHeaderValue("Subject"));
+    ASSERT_EQ(eager.GenerateRawHeaders(), lazy.GenerateRawHeaders());
+    lazy.SetHeader("To", "Alice");
+    ASSERT_EQ("Alice", lazy.GetHeaderValue("To"));
+}
+
+TEST(MessageHeadersTests, LazyValuesSurviveIncrementalParse)
+{
+    const std::string rawMessage =
+        "From: Alice <alice@atlanta.example.com>\r\n"
+        "Subject: This\r\n"
+        " is a test\r\n"
+        "To: Bob\r\n"
+        "\r\n";
+    MessageHeaders::MessageHeaders headers;
+    headers.SetLazyValues(true);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              headers.ParseRawMessage("Date: Tue, 14 May 2024 10:12:08 +0200\r\n\r\n"));
+    for (size_t i = 1; i < rawMessage.length(); ++i)
+    {
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Incomplete,
+                  headers.ParseRawMessage(rawMessage.substr(0, i)))
+            << i;
+    }
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              headers.ParseRawMessage(rawMessage));
+    ASSERT_EQ("Tue, 14 May 2024 10:12:08 +0200", headers.GetHeaderValue("Date"));
+    ASSERT_EQ("Alice <alice@atlanta.example.com>", headers.GetHeaderValue("From"));
+    ASSERT_EQ("This is a test", headers.GetHeaderValue("Subject"));
+    ASSERT_EQ("Bob", headers.GetHeaderValue("To"));
+}
+
+TEST(MessageHeadersTests, LazyValuesAvoidCopyingEachValue)
+{
+    std::string rawMessage;
+    for (size_t i = 0; i < 20; ++i)
+    {
+        rawMessage += "X-Header-" + std::to_string(i) + ": a value long enough not to fit "
+                      "into a short string buffer\r\n";
+    }
+    rawMessage += "\r\n";
+    CountingMemoryResource eagerResource;
+    MessageHeaders::MessageHeaders eager(&eagerResource);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete, eager.ParseRawMessage(rawMessage));
+    CountingMemoryResource lazyResource;
+    MessageHeaders::MessageHeaders lazy(&lazyResource);
+    lazy.SetLazyValues(true);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete, lazy.ParseRawMessage(rawMessage));
+    ASSERT_LE(lazyResource.allocations, eagerResource.allocations);
+    ASSERT_EQ(eager.GetHeaderValue("X-Header-7"), lazy.GetHeaderValue("x-header-7"));
+}
+
+TEST(MessageHeadersTests, ForEachHeaderValueAndToken)
+{
+    MessageHeaders::MessageHeaders headers;
+    const std::string rawMessage =
+        "Via: SIP/2.0/UDP a.example.com, SIP/2.0/UDP b.example.com\r\n"
+        "Subject: Hello\r\n"
+        "Via: SIP/2.0/UDP c.example.com\r\n"
+        "Contact: \"Smith, Bob\" <sip:bob@example.com>, <sip:carol@example.com>\r\n"
+        "\r\n";
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete, headers.ParseRawMessage(rawMessage));
+    std::vector<std::string> values;
+    headers.ForEachHeaderValue("via", [&](std::string_view value)
+                               { values.emplace_back(value); });
+    ASSERT_EQ((std::vector<std::string>{"SIP/2.0/UDP a.example.com, SIP/2.0/UDP b.example.com",
+                                        "SIP/2.0/UDP c.example.com"}),
+              values);
+    std::vector<std::string> tokens;
+    headers.ForEachHeaderToken("Via", [&](std::string_view token) { tokens.emplace_back(token); });
+    ASSERT_EQ((std::vector<std::string>{"SIP/2.0/UDP a.example.com", "SIP/2.0/UDP b.example.com",
+                                        "SIP/2.0/UDP c.example.com"}),
+              tokens);
+    tokens.clear();
+    headers.ForEachHeaderToken("Contact",
+                               [&](std::string_view token) { tokens.emplace_back(token); });
+    ASSERT_EQ((std::vector<std::string>{"\"Smith, Bob\" <sip:bob@example.com>",
+                                        "<sip:carol@example.com>"}),
+              tokens);
+    size_t visits = 0;
+    headers.ForEachHeaderToken("X-Not-There", [&](std::string_view) { ++visits; });
+    ASSERT_EQ(0, visits);
+}
+
+TEST(MessageHeadersTests, ForEachHeaderTokenOfLazyValues)
+{
+    MessageHeaders::MessageHeaders headers;
+    headers.SetLazyValues(true);
+    const std::string rawMessage =
+        "Allow: INVITE, ACK,\r\n"
+        " BYE\r\n"
+        "\r\n";
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete, headers.ParseRawMessage(rawMessage));
+    std::vector<std::string> tokens;
+    headers.ForEachHeaderToken("Allow",
+                               [&](std::string_view token) { tokens.emplace_back(token); });
+    ASSERT_EQ((std::vector<std::string>{"INVITE", "ACK", "BYE"}), tokens);
+}
+
+TEST(MessageHeadersTests, CloneSharesHeadersUntilModified)
+{
+    CountingMemoryResource resource;
+    MessageHeaders::MessageHeaders original(&resource);
+    std::string rawMessage;
+    for (int i = 0; i < 50; ++i)
+    {
+        rawMessage += "Via: SIP/2.0/UDP proxy" + std::to_string(i) + ".example.com\r\n";
+    }
+    rawMessage += "Max-Forwards: 70\r\n\r\n";
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              original.ParseRawMessage(rawMessage));
+    ASSERT_FALSE(original.GetHeaderValue("Max-Forwards").empty());
+    const auto allocationsBeforeClones = resource.allocations;
+    std::vector<MessageHeaders::MessageHeaders> branches;
+    for (int i = 0; i < 8; ++i)
+    {
+        branches.push_back(original.Clone());
+    }
+    ASSERT_EQ(allocationsBeforeClones, resource.allocations);
+    branches[3].AddHeader("Via", "SIP/2.0/UDP branch3.example.com");
+    branches[5].SetHeader("Max-Forwards", "69");
+    branches[6].RemoveHeader("Via");
+    ASSERT_EQ(51, branches[3].GetHeaderMultiValues("Via").size());
+    ASSERT_EQ("SIP/2.0/UDP branch3.example.com", branches[3].GetHeaderMultiValues("via").back());
+    ASSERT_EQ("69", branches[5].GetHeaderValue("Max-Forwards"));
+    ASSERT_FALSE(branches[6].HasHeader("Via"));
+    const auto expectedRawHeaders = original.GenerateRawHeaders();
+    ASSERT_EQ(50, original.GetHeaderMultiValues("Via").size());
+    ASSERT_EQ("70", original.GetHeaderValue("Max-Forwards"));
+    ASSERT_EQ(expectedRawHeaders, branches[0].GenerateRawHeaders());
+    ASSERT_EQ(expectedRawHeaders, branches[7].GenerateRawHeaders());
+    ASSERT_EQ(rawMessage, expectedRawHeaders);
+}
+
+TEST(MessageHeadersTests, OriginalModifiedAfterClone)
+{
+    MessageHeaders::MessageHeaders original;
+    original.SetLineLimit(30);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              original.ParseRawMessage("Subject: Hello\r\n\r\n"));
+    const auto clone = original.Clone();
+    original.SetHeader("Subject", "Goodbye");
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              original.ParseRawMessage("To: bob@example.com\r\n\r\n"));
+    ASSERT_EQ("Goodbye", original.GetHeaderValue("Subject"));
+    ASSERT_TRUE(original.HasHeader("To"));
+    ASSERT_EQ("Hello", clone.GetHeaderValue("Subject"));
+    ASSERT_FALSE(clone.HasHeader("To"));
+    MessageHeaders::MessageHeaders::HeaderValue longValue(40, 'x');
+    longValue[15] = ' ';
+    auto secondClone = clone.Clone();
+    secondClone.SetHeader("Subject", longValue);
+    ASSERT_EQ("Subject: " + std::string(15, 'x') + "\r\n " + std::string(24, 'x') + "\r\n\r\n",
+              secondClone.GenerateRawHeaders());
+}
+
+TEST(MessageHeadersTests, CloneOfLazyValues)
+{
+    MessageHeaders::MessageHeaders original;
+    original.SetLazyValues(true);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              original.ParseRawMessage("Subject: Hello,\r\n World\r\nTo: bob@example.com\r\n\r\n"));
+    auto clone = original.Clone();
+    clone.RemoveHeader("To");
+    ASSERT_EQ("Hello, World", clone.GetHeaderValue("Subject"));
+    ASSERT_EQ("Hello, World", original.GetHeaderValue("Subject"));
+    ASSERT_EQ("bob@example.com", original.GetHeaderValue("To"));
+}
+
+TEST(MessageHeadersTests, SetAndAddHeadersFromAnyKindOfString)
+{
+    MessageHeaders::MessageHeaders headers;
+    headers.Reserve(8);
+    const std::string via = "SIP/2.0/UDP pc33.atlanta.com";
+    const std::string_view to = "Bob <sip:bob@biloxi.com>xxx";
+    std::string name = "X-Some-Rather-Long-Header-Name";
+    headers.AddHeader(std::string("Via"), via);
+    headers.AddHeader(std::string_view("To"), to.substr(0, to.length() - 3));
+    headers.AddHeader(std::move(name), std::string(40, 'x'));
+    headers.SetHeader("Subject", std::string_view("Hello"));
+    headers.AddHeader("Accept", std::vector<std::string>{"a", "", "b"}, true);
+    ASSERT_EQ("Via: SIP/2.0/UDP pc33.atlanta.com\r\n"
+              "To: Bob <sip:bob@biloxi.com>\r\n"
+              "X-Some-Rather-Long-Header-Name: " +
+                  std::string(40, 'x') +
+                  "\r\n"
+                  "Subject: Hello\r\n"
+                  "Accept: a,,b\r\n"
+                  "\r\n",
+              headers.GenerateRawHeaders());
+    const auto all = headers.GetAll();
+    ASSERT_EQ(5, all.size());
+    ASSERT_EQ("x-some-rather-long-header-name", all[2].name);
+    ASSERT_EQ(std::string(40, 'x'), all[2].value);
+}
+
+TEST(MessageHeadersTests, RemoveHeadersInOnePass)
+{
+    MessageHeaders::MessageHeaders headers;
+    std::string rawMessage = "Host: www.example.com\r\n";
+    for (int i = 0; i < 20; ++i)
+    {
+        rawMessage += "Received: from relay" + std::to_string(i) + "\r\n";
+        rawMessage += "Connection: keep-alive\r\n";
+    }
+    rawMessage += "Keep-Alive: timeout=5\r\nAccept: */*\r\n\r\n";
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete, headers.ParseRawMessage(rawMessage));
+    headers.RemoveHeaders({"connection", "Keep-Alive", "Received", "X-Not-There"});
+    ASSERT_EQ("Host: www.example.com\r\nAccept: */*\r\n\r\n", headers.GenerateRawHeaders());
+    ASSERT_FALSE(headers.HasHeader("Received"));
+    headers.AddHeader("Received", "from relay20");
+    ASSERT_EQ("from relay20", headers.GetHeaderValue("Received"));
+}
+
+TEST(MessageHeadersTests, EditHeadersMatchesEditsOneAtATime)
+{
+    const std::string rawMessage =
+        "Via: hop 1\r\n"
+        "To: bob\r\n"
+        "Via: hop 2\r\n"
+        "From: alice\r\n"
+        "Subject: hello\r\n"
+        "Via: hop 3\r\n"
+        "\r\n";
+    typedef MessageHeaders::MessageHeaders::HeaderEdit::Action Action;
+    const std::vector<MessageHeaders::MessageHeaders::HeaderEdit> edits{
+        {Action::Set, "Via", "hop 0"},         {Action::Remove, "From", ""},
+        {Action::Set, "X-New", "first"},       {Action::Remove, "To", ""},
+        {Action::Set, "To", "carol"},          {Action::Set, "From", "dave"},
+        {Action::Set, "x-new", "second"},      {Action::Set, "Subject", "bye"},
+        {Action::Remove, "X-Not-There", ""},   {Action::Set, "Subject", "later"},
+        {Action::Set, "X-Newest", "third"},    {Action::Remove, "X-Newest", ""},
+    };
+    MessageHeaders::MessageHeaders expected;
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              expected.ParseRawMessage(rawMessage));
+    for (const auto& edit : edits)
+    {
+        if (edit.action == Action::Set)
+        {
+            expected.SetHeader(edit.name, edit.value);
+        }
+        else
+        {
+            expected.RemoveHeader(edit.name);
+        }
+    }
+    MessageHeaders::MessageHeaders headers;
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete, headers.ParseRawMessage(rawMessage));
+    headers.EditHeaders(edits);
+    ASSERT_EQ("Via: hop 0\r\n"
+              "Subject: later\r\n"
+              "X-New: second\r\n"
+              "To: carol\r\n"
+              "From: dave\r\n"
+              "\r\n",
+              expected.GenerateRawHeaders());
+    ASSERT_EQ(expected.GenerateRawHeaders(), headers.GenerateRawHeaders());
+}
+
+TEST(MessageHeadersTests, HeaderCountLimit)
+{
+    std::string rawMessage;
+    for (int i = 0; i < 10; ++i)
+    {
+        rawMessage += "X-Header-" + std::to_string(i) + ": value\r\n";
+    }
+    rawMessage += "\r\n";
+    MessageHeaders::MessageHeaders::Limits limits;
+    limits.headerCount = 10;
+    MessageHeaders::MessageHeaders headers;
+    headers.SetLimits(limits);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete, headers.ParseRawMessage(rawMessage));
+    limits.headerCount = 9;
+    MessageHeaders::MessageHeaders limitedHeaders;
+    limitedHeaders.SetLimits(limits);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Error,
+              limitedHeaders.ParseRawMessage(rawMessage));
+    ASSERT_FALSE(limitedHeaders.IsValid());
+}
+
+TEST(MessageHeadersTests, HeaderBlockSizeLimitAcrossIncrementalParse)
+{
+    const std::string rawMessage =
+        "Host: www.example.com\r\n"
+        "Accept: */*\r\n"
+        "\r\n";
+    MessageHeaders::MessageHeaders::Limits limits;
+    limits.blockSize = rawMessage.length();
+    MessageHeaders::MessageHeaders headers;
+    headers.SetLimits(limits);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              headers.ParseRawMessage(rawMessage + "body"));
+    limits.blockSize = rawMessage.length() - 1;
+    MessageHeaders::MessageHeaders limitedHeaders;
+    limitedHeaders.SetLimits(limits);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Incomplete,
+              limitedHeaders.ParseRawMessage(rawMessage.substr(0, 25)));
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Error,
+              limitedHeaders.ParseRawMessage(rawMessage + "body"));
+}
+
+TEST(MessageHeadersTests, ContinuationLinesLimit)
+{
+    const std::string rawMessage =
+        "Subject: one\r\n"
+        " two\r\n"
+        " three\r\n"
+        "To: Bob\r\n"
+        " Smith\r\n"
+        "\r\n";
+    MessageHeaders::MessageHeaders::Limits limits;
+    limits.continuationLines = 2;
+    MessageHeaders::MessageHeaders headers;
+    headers.SetLimits(limits);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete, headers.ParseRawMessage(rawMessage));
+    ASSERT_EQ("one two three", headers.GetHeaderValue("Subject"));
+    limits.continuationLines = 1;
+    MessageHeaders::MessageHeaders limitedHeaders;
+    limitedHeaders.SetLimits(limits);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Error,
+              limitedHeaders.ParseRawMessage(rawMessage));
+}
+
+TEST(MessageHeadersTests, ParsingDoesNotAllocateForEachHeader)
+{
+    const auto makeRawMessage = [](size_t headerCount)
+    {
+        std::string rawMessage;
+        for (size_t i = 0; i < headerCount; ++i)
+        {
+            rawMessage += "X-Header-" + std::to_string(i) + ": a value long enough not to fit "
+                          "into a short string buffer\r\n";
+        }
+        return rawMessage + "\r\n";
+    };
+    CountingMemoryResource fewResource;
+    MessageHeaders::MessageHeaders few(&fewResource);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              few.ParseRawMessage(makeRawMessage(20)));
+    CountingMemoryResource manyResource;
+    MessageHeaders::MessageHeaders many(&manyResource);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              many.ParseRawMessage(makeRawMessage(200)));
+    ASSERT_LT(manyResource.allocations, fewResource.allocations + 10);
+    ASSERT_EQ("a value long enough not to fit into a short string buffer",
+              many.GetHeaderValue("x-header-199"));
+}
+
+TEST(MessageHeadersTests, HeadersKeptIntactWhileValuesChange)
+{
+    CountingMemoryResource resource;
+    MessageHeaders::MessageHeaders headers(&resource);
+    headers.AddHeader("From", "alice@example.com");
+    headers.AddHeader("X-Counter", "0");
+    headers.AddHeader("To", "bob@example.com");
+    size_t bytesInUseEarly = 0;
+    for (size_t i = 1; i <= 1000; ++i)
+    {
+        headers.SetHeader("X-Counter", std::string(i % 100, 'x') + std::to_string(i));
+        headers.AddHeader("X-Temporary", "a value which is removed again right away");
+        headers.RemoveHeader("X-Temporary");
+        if (i == 100)
+        {
+            bytesInUseEarly = resource.bytesInUse;
+        }
+    }
+    ASSERT_EQ("1000", headers.GetHeaderValue("X-Counter"));
+    ASSERT_EQ("alice@example.com", headers.GetHeaderValue("From"));
+    ASSERT_EQ("bob@example.com", headers.GetHeaderValue("To"));
+    ASSERT_EQ("From: alice@example.com\r\n"
+              "X-Counter: 1000\r\n"
+              "To: bob@example.com\r\n"
+              "\r\n",
+              headers.GenerateRawHeaders());
+    ASSERT_LE(resource.bytesInUse, bytesInUseEarly * 2);
+}
+
+TEST(MessageHeadersTests, ShorterValueSetInPlace)
+{
+    MessageHeaders::MessageHeaders headers;
+    headers.AddHeader("Subject", "A rather long subject line");
+    headers.AddHeader("X-Priority", "1");
+    headers.SetHeader("Subject", "Short");
+    headers.SetHeader("X-Priority", "Highest");
+    ASSERT_EQ("Short", headers.GetHeaderValue("Subject"));
+    ASSERT_EQ("Highest", headers.GetHeaderValue("X-Priority"));
+    const auto all = headers.GetAll();
+    ASSERT_EQ(2, all.size());
+    ASSERT_EQ("Subject", (const std::string&)all[0].name);
+    ASSERT_EQ("Short", all[0].value);
+    ASSERT_EQ("X-Priority", (const std::string&)all[1].name);
+    ASSERT_EQ("Highest", all[1].value);
+}
+
+TEST(MessageHeadersTests, LazyFoldedValueUnfoldedWhereItWas)
+{
+    MessageHeaders::MessageHeaders headers;
+    headers.SetLazyValues(true);
+    const std::string rawMessage = "Subject: first line\r\n"
+                                   "   second line\r\n"
+                                   "X-Empty:   \r\n"
+                                   "To:  bob@example.com \r\n"
+                                   "\r\n";
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete, headers.ParseRawMessage(rawMessage));
+    ASSERT_EQ("bob@example.com", headers.GetHeaderValue("To"));
+    ASSERT_EQ("first line second line", headers.GetHeaderValue("Subject"));
+    ASSERT_EQ("first line second line", headers.GetHeaderValue("Subject"));
+    ASSERT_EQ("", headers.GetHeaderValue("X-Empty"));
+    ASSERT_EQ("Subject: first line second line\r\n"
+              "X-Empty: \r\n"
+              "To: bob@example.com\r\n"
+              "\r\n",
+              headers.GenerateRawHeaders());
+}
+
+TEST(MessageHeadersTests, ForEachHeaderMatchesGetAll)
+{
+    MessageHeaders::MessageHeaders headers;
+    headers.SetLazyValues(true);
+    const std::string rawMessage = "From: alice@example.com\r\n"
+                                   "Subject: first line\r\n"
+                                   "  second line\r\n"
+                                   "To: bob@example.com\r\n"
+                                   "\r\n";
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete, headers.ParseRawMessage(rawMessage));
+    headers.AddHeader("X-Extra", "extra");
+    std::vector<std::pair<std::string, std::string>> visited;
+    headers.ForEachHeader([&](std::string_view name, std::string_view value)
+                          { visited.emplace_back(name, value); });
+    const auto all = headers.GetAll();
+    ASSERT_EQ(all.size(), visited.size());
+    for (size_t i = 0; i < all.size(); ++i)
+    {
+        EXPECT_EQ((const std::string&)all[i].name, visited[i].first);
+        EXPECT_EQ(all[i].value, visited[i].second);
+    }
+    ASSERT_EQ("first line second line", visited[1].second);
+}
+
+TEST(MessageHeadersTests, ForEachHeaderDoesNotAllocate)
+{
+    CountingMemoryResource resource;
+    MessageHeaders::MessageHeaders headers(&resource);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              headers.ParseRawMessage("From: alice@example.com\r\n"
+                                      "To: bob@example.com\r\n"
+                                      "\r\n"));
+    const auto allocationsBefore = resource.allocations;
+    size_t headerCount = 0;
+    headers.ForEachHeader([&](std::string_view, std::string_view) { ++headerCount; });
+    ASSERT_EQ(2, headerCount);
+    ASSERT_EQ(allocationsBefore, resource.allocations);
+}
+
+TEST(MessageHeadersTests, HeaderNameIteration)
+{
+    const MessageHeaders::MessageHeaders::HeaderName name("Content-Type");
+    std::string characters;
+    for (const auto c : name)
+    {
+        characters += c;
+    }
+    ASSERT_EQ("Content-Type", characters);
+    ASSERT_EQ(12, std::distance(name.begin(), name.end()));
+}
+
+TEST(MessageHeadersTests, ClearKeepsMemoryForNextMessage)
+{
+    std::string rawMessage;
+    for (size_t i = 0; i < 20; ++i)
+    {
+        rawMessage += "X-Header-" + std::to_string(i) + ": a value long enough not to fit "
+                      "into a short string buffer\r\n";
+    }
+    rawMessage += "\r\n";
+    for (const auto lazyValues : {false, true})
+    {
+        CountingMemoryResource resource;
+        MessageHeaders::MessageHeaders headers(&resource);
+        headers.SetLazyValues(lazyValues);
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                  headers.ParseRawMessage(rawMessage));
+        ASSERT_TRUE(headers.HasHeader("X-Header-19"));
+        headers.Clear();
+        ASSERT_TRUE(headers.GetAll().empty());
+        ASSERT_FALSE(headers.HasHeader("X-Header-19"));
+        const auto allocationsBefore = resource.allocations;
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                  headers.ParseRawMessage(rawMessage));
+        ASSERT_EQ("a value long enough not to fit into a short string buffer",
+                  headers.GetHeaderValue("X-Header-19"));
+        ASSERT_EQ(allocationsBefore, resource.allocations);
+    }
+}
+
+TEST(MessageHeadersTests, ClearForgetsParseStateButKeepsSettings)
+{
+    MessageHeaders::MessageHeaders headers;
+    headers.SetLineLimit(30);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Error,
+              headers.ParseRawMessage("Bad header line\r\n\r\n"));
+    ASSERT_FALSE(headers.IsValid());
+    headers.Clear();
+    ASSERT_TRUE(headers.IsValid());
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Incomplete,
+              headers.ParseRawMessage("From: alice@example.com\r\nTo: bo"));
+    headers.Clear();
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              headers.ParseRawMessage("Subject: Hello\r\n\r\n"));
+    ASSERT_EQ(1, headers.GetAll().size());
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Error,
+              headers.ParseRawMessage("X-Long: " + std::string(40, 'x') + "\r\n\r\n"));
+}
+
+TEST(MessageHeadersTests, ClearLeavesClonesAlone)
+{
+    MessageHeaders::MessageHeaders headers;
+    headers.AddHeader("From", "alice@example.com");
+    const auto clone = headers.Clone();
+    headers.Clear();
+    ASSERT_FALSE(headers.HasHeader("From"));
+    ASSERT_EQ("alice@example.com", clone.GetHeaderValue("From"));
+}
+
+
+TEST(MessageHeadersTests, UnchangedLinesGeneratedInOnePiece)
+{
+    const std::string rawHeaders =
+        "Via: SIP/2.0/UDP server10.biloxi.com;branch=z9hG4bKnashds8\r\n"
+        "To: Bob <sip:bob@biloxi.com>\r\n"
+        "From: Alice <sip:alice@atlanta.com>;tag=1928301774\r\n"
+        "Call-ID: a84b4c76e66710\r\n"
+        "\r\n";
+    for (const auto lazyValues : {false, true})
+    {
+        MessageHeaders::MessageHeaders headers;
+        headers.SetLazyValues(lazyValues);
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                  headers.ParseRawMessage(rawHeaders));
+        std::vector<std::string_view> spans;
+        headers.GenerateRawHeaderSpans(spans);
+        ASSERT_EQ((std::vector<std::string_view>{
+                      std::string_view(rawHeaders).substr(0, rawHeaders.length() - 2), "\r\n"}),
+                  spans)
+            << lazyValues;
+        headers.SetHeader("To", "Carol <sip:carol@chicago.com>");
+        spans.clear();
+        headers.GenerateRawHeaderSpans(spans);
+        ASSERT_EQ(4, spans.size()) << lazyValues;
+        ASSERT_EQ("Via: SIP/2.0/UDP server10.biloxi.com;branch=z9hG4bKnashds8\r\n", spans[0]);
+        ASSERT_EQ("To: Carol <sip:carol@chicago.com>\r\n", spans[1]);
+        ASSERT_EQ("From: Alice <sip:alice@atlanta.com>;tag=1928301774\r\n"
+                  "Call-ID: a84b4c76e66710\r\n",
+                  spans[2]);
+        ASSERT_EQ("\r\n", spans[3]);
+    }
+}
+
+TEST(MessageHeadersTests, RawSizeKeptUpToDate)
+{
+    const auto generatedSize = [](const MessageHeaders::MessageHeaders& headers)
+    {
+        std::vector<std::string_view> spans;
+        headers.GenerateRawHeaderSpans(spans);
+        size_t size = 0;
+        for (const auto& span : spans)
+        {
+            size += span.length();
+        }
+        return size;
+    };
+    const std::string rawHeaders =
+        "Subject:   margins   \r\n"
+        "To: Bob\r\n"
+        "X-Folded: first line\r\n"
+        "  second line\r\n"
+        "X-Empty:\r\n"
+        "X-Canonical-Empty: \r\n"
+        "\r\n";
+    for (const auto lazyValues : {false, true})
+    {
+        MessageHeaders::MessageHeaders headers;
+        headers.SetLazyValues(lazyValues);
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                  headers.ParseRawMessage(rawHeaders));
+        ASSERT_EQ(generatedSize(headers), headers.GetRawSize()) << lazyValues;
+        headers.SetHeader("To", "Bobby");
+        ASSERT_EQ(generatedSize(headers), headers.GetRawSize()) << lazyValues;
+        headers.SetHeader("To", "Bo");
+        ASSERT_EQ(generatedSize(headers), headers.GetRawSize()) << lazyValues;
+        headers.SetHeader("To", "Al");
+        ASSERT_EQ(generatedSize(headers), headers.GetRawSize()) << lazyValues;
+        headers.AddHeader("To", "Carol");
+        headers.SetHeader("X-Folded", "one line");
+        ASSERT_EQ(generatedSize(headers), headers.GetRawSize()) << lazyValues;
+        headers.RemoveHeader("Subject");
+        ASSERT_EQ(generatedSize(headers), headers.GetRawSize()) << lazyValues;
+        for (size_t i = 0; i < 100; ++i)
+        {
+            headers.SetHeader("X-Empty", std::string(i, 'x'));
+        }
+        ASSERT_EQ(generatedSize(headers), headers.GetRawSize()) << lazyValues;
+        ASSERT_EQ(
+            "To: Al\r\n"
+            "X-Folded: one line\r\n"
+            "X-Empty: " + std::string(99, 'x') + "\r\n"
+            "X-Canonical-Empty: \r\n"
+            "To: Carol\r\n"
+            "\r\n",
+            headers.GenerateRawHeaders());
+        headers.Clear();
+        ASSERT_EQ(2, headers.GetRawSize());
+    }
+}
+
+TEST(MessageHeadersTests, SipProfileExpandsCompactNames)
+{
+    const std::string rawHeaders =
+        "v: SIP/2.0/UDP pc33.atlanta.com\r\n"
+        "f: Alice <sip:alice@atlanta.com>\r\n"
+        "X-Thing: c\r\n"
+        "l: 0\r\n"
+        "\r\n";
+    for (const auto lazyValues : {false, true})
+    {
+        MessageHeaders::MessageHeaders headers;
+        headers.SetLazyValues(lazyValues);
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                  headers.ParseRawMessage<MessageHeaders::SipProfile>(rawHeaders))
+            << lazyValues;
+        ASSERT_EQ("SIP/2.0/UDP pc33.atlanta.com", headers.GetHeaderValue("Via")) << lazyValues;
+        ASSERT_EQ("Alice <sip:alice@atlanta.com>", headers.GetHeaderValue("From")) << lazyValues;
+        ASSERT_EQ("0", headers.GetHeaderValue("Content-Length")) << lazyValues;
+        ASSERT_EQ("c", headers.GetHeaderValue("X-Thing")) << lazyValues;
+        ASSERT_FALSE(headers.HasHeader("v")) << lazyValues;
+        ASSERT_EQ(
+            "Via: SIP/2.0/UDP pc33.atlanta.com\r\n"
+            "From: Alice <sip:alice@atlanta.com>\r\n"
+            "X-Thing: c\r\n"
+            "Content-Length: 0\r\n"
+            "\r\n",
+            headers.GenerateRawHeaders())
+            << lazyValues;
+    }
+}
+
+TEST(MessageHeadersTests, HttpProfileRejectsFoldedValue)
+{
+    const std::string rawHeaders =
+        "Host: www.example.com\r\n"
+        "X-Folded: one\r\n"
+        " two\r\n"
+        "\r\n";
+    MessageHeaders::MessageHeaders headers;
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Error,
+              headers.ParseRawMessage<MessageHeaders::HttpProfile>(rawHeaders));
+    MessageHeaders::MessageHeaders configuredHeaders;
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              configuredHeaders.ParseRawMessage(rawHeaders));
+    ASSERT_EQ("one two", configuredHeaders.GetHeaderValue("X-Folded"));
+}
+
+TEST(MessageHeadersTests, EmailProfileLimitsLineLength)
+{
+    const std::string longestValue(998 - 9, 'x');
+    MessageHeaders::MessageHeaders headers;
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              headers.ParseRawMessage<MessageHeaders::EmailProfile>(
+                  "Subject: " + longestValue + "\r\n\r\n"));
+    ASSERT_EQ(longestValue, headers.GetHeaderValue("Subject"));
+    MessageHeaders::MessageHeaders tooLongHeaders;
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Error,
+              tooLongHeaders.ParseRawMessage<MessageHeaders::EmailProfile>(
+                  "Subject: " + longestValue + "x\r\n\r\n"));
+    MessageHeaders::MessageHeaders configuredHeaders;
+    configuredHeaders.SetLineLimit(2000);
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              configuredHeaders.ParseRawMessage<MessageHeaders::EmailProfile>(
+                  "Subject: " + longestValue + "x\r\n\r\n"));
+}
+
+TEST(MessageHeadersTests, FindCompactHeader)
+{
+    ASSERT_EQ(MessageHeaders::WellKnownHeader::Via, MessageHeaders::FindCompactHeader("v"));
+    ASSERT_EQ(MessageHeaders::WellKnownHeader::CallId, MessageHeaders::FindCompactHeader("I"));
+    ASSERT_EQ(MessageHeaders::WellKnownHeader::Unknown, MessageHeaders::FindCompactHeader("q"));
+    ASSERT_EQ(MessageHeaders::WellKnownHeader::Unknown, MessageHeaders::FindCompactHeader("To"));
+}
+
+TEST(MessageHeadersTests, AbandonParse)
+{
+    for (const auto lazyValues : {false, true})
+    {
+        MessageHeaders::MessageHeaders headers;
+        headers.SetLazyValues(lazyValues);
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                  headers.ParseRawMessage("Host: www.example.com\r\n\r\n"));
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Incomplete,
+                  headers.ParseRawMessage("Alpha: 1\r\nBeta: 22"));
+        headers.AbandonParse();
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                  headers.ParseRawMessage("Gamma: 333\r\n\r\n"));
+        ASSERT_EQ(
+            "Host: www.example.com\r\n"
+            "Gamma: 333\r\n"
+            "\r\n",
+            headers.GenerateRawHeaders())
+            << lazyValues;
+        headers.AbandonParse();
+        ASSERT_EQ(2, headers.GetAll().size()) << lazyValues;
+    }
+}
+
+TEST(MessageHeadersTests, AbandonParseBeforeFirstLineComplete)
+{
+    MessageHeaders::MessageHeaders headers;
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Incomplete,
+              headers.ParseRawMessage("X-Lo"));
+    headers.AbandonParse();
+    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+              headers.ParseRawMessage("X-Long-Name-Here: value\r\n\r\n"));
+    const auto parsedHeaders = headers.GetAll();
+    ASSERT_EQ(1, parsedHeaders.size());
+    ASSERT_EQ("X-Long-Name-Here", parsedHeaders[0].name);
+    ASSERT_EQ("value", parsedHeaders[0].value);
+}
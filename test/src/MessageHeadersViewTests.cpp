@@ -0,0 +1,203 @@
+/**
+ * @file MessageHeadersViewTests.cpp
+ *
+ * This module contains unit Tests of the MessageHeaders::MessageHeadersView class
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <gtest/gtest.h>
+#include <MessageHeaders/MessageHeadersView.hpp>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+TEST(MessageHeadersViewTests, HttpClientRequestMessage)
+{
+    MessageHeaders::MessageHeadersView headers;
+    const std::string rawMessage =
+        "User-Agent: curl/7.16.3 libcurl/7.163 OpenSSL/0.9.7l zlib/1.2.3\r\n"
+        "Host: www.example.com\r\n"
+        "Accept-Language: en, mi\r\n"
+        "\r\n";
+    size_t bodyOffset;
+    ASSERT_EQ(MessageHeaders::MessageHeadersView::State::Complete,
+              headers.ParseRawMessage(rawMessage, bodyOffset));
+    ASSERT_EQ(rawMessage.length(), bodyOffset);
+    ASSERT_TRUE(headers.IsValid());
+    struct ExpectedHeader
+    {
+        std::string name;
+        std::string value;
+    };
+    const std::vector<ExpectedHeader> expectedHeaders{
+        {"User-Agent", "curl/7.16.3 libcurl/7.163 OpenSSL/0.9.7l zlib/1.2.3"},
+        {"Host", "www.example.com"},
+        {"Accept-Language", "en, mi"},
+    };
+    ASSERT_EQ(expectedHeaders.size(), headers.GetHeaderCount());
+    for (size_t i = 0; i < expectedHeaders.size(); ++i)
+    {
+        const auto header = headers.GetHeader(i);
+        ASSERT_EQ(expectedHeaders[i].name, header.name);
+        ASSERT_EQ(expectedHeaders[i].value, header.value);
+    }
+    ASSERT_TRUE(headers.HasHeader("host"));
+    ASSERT_FALSE(headers.HasHeader("Toto"));
+    ASSERT_EQ("www.example.com", headers.GetHeaderValue("HOST"));
+    ASSERT_EQ("", headers.GetHeaderValue("Toto"));
+}
+
+TEST(MessageHeadersViewTests, NamesAndValuesPointIntoRawMessage)
+{
+    MessageHeaders::MessageHeadersView headers;
+    const std::string rawMessage =
+        "Host: www.example.com\r\n"
+        "Subject: This\r\n"
+        " is a test\r\n"
+        "\r\n";
+    ASSERT_EQ(MessageHeaders::MessageHeadersView::State::Complete,
+              headers.ParseRawMessage(rawMessage));
+    const auto host = headers.GetHeader(0);
+    ASSERT_EQ(rawMessage.data(), host.name.data());
+    ASSERT_EQ(rawMessage.data() + 6, host.value.data());
+    const auto subject = headers.GetHeader(1);
+    ASSERT_EQ(rawMessage.data() + 23, subject.name.data());
+    ASSERT_EQ("This is a test", subject.value);
+    ASSERT_FALSE((subject.value.data() >= rawMessage.data()) &&
+                 (subject.value.data() < rawMessage.data() + rawMessage.length()));
+}
+
+TEST(MessageHeadersViewTests, IncrementalParseFollowsRelocatedMessage)
+{
+    const std::string rawMessage =
+        "Host: www.example.com\r\n"
+        "Via: SIP/2.0/UDP server10.biloxi.com\r\n"
+        "   ;branch=z9hG4bKnashds8\r\n"
+        "To: Bob\r\n"
+        "\r\n";
+    MessageHeaders::MessageHeadersView headers;
+    std::string buffer;
+    for (size_t i = 0; i < rawMessage.length(); ++i)
+    {
+        buffer += rawMessage[i];
+        buffer.shrink_to_fit();
+        const auto state = headers.ParseRawMessage(buffer);
+        if (i + 1 < rawMessage.length())
+        {
+            ASSERT_EQ(MessageHeaders::MessageHeadersView::State::Incomplete, state) << i;
+        }
+        else
+        {
+            ASSERT_EQ(MessageHeaders::MessageHeadersView::State::Complete, state) << i;
+        }
+    }
+    ASSERT_EQ(3, headers.GetHeaderCount());
+    ASSERT_EQ("www.example.com", headers.GetHeaderValue("Host"));
+    ASSERT_EQ("SIP/2.0/UDP server10.biloxi.com ;branch=z9hG4bKnashds8",
+              headers.GetHeaderValue("Via"));
+    ASSERT_EQ("Bob", headers.GetHeaderValue("To"));
+}
+
+TEST(MessageHeadersViewTests, HeaderLineTooLong)
+{
+    MessageHeaders::MessageHeadersView headers;
+    headers.SetLineLimit(20);
+    ASSERT_EQ(MessageHeaders::MessageHeadersView::State::Error,
+              headers.ParseRawMessage("Host: www.example.com\r\n\r\n"));
+    ASSERT_FALSE(headers.IsValid());
+    headers.Clear();
+    ASSERT_TRUE(headers.IsValid());
+    ASSERT_EQ(0, headers.GetHeaderCount());
+    ASSERT_EQ(MessageHeaders::MessageHeadersView::State::Complete,
+              headers.ParseRawMessage("To: Bob\r\n\r\n"));
+    ASSERT_EQ("Bob", headers.GetHeaderValue("To"));
+}
+
+TEST(MessageHeadersViewTests, StorageAllocatedFromArena)
+{
+    alignas(std::max_align_t) char buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+                                              std::pmr::null_memory_resource());
+    MessageHeaders::MessageHeadersView headers(&arena);
+    const std::string rawMessage =
+        "Host: www.example.com\r\n"
+        "Subject: This\r\n"
+        " is a test of a folded header value\r\n"
+        "\r\n";
+    ASSERT_EQ(MessageHeaders::MessageHeadersView::State::Complete,
+              headers.ParseRawMessage(rawMessage));
+    const auto subject = headers.GetHeaderValue("Subject");
+    ASSERT_EQ("This is a test of a folded header value", subject);
+    ASSERT_TRUE((subject.data() >= buffer) && (subject.data() < buffer + sizeof(buffer)));
+}
+
+TEST(MessageHeadersViewTests, ControlCharacterSplitAcrossIncrementalParse)
+{
+    const std::string rawMessage =
+        "Subject: a value with a \x01 control character part way through it\r\n"
+        "\r\n";
+    for (size_t split = 1; split < rawMessage.length(); ++split)
+    {
+        MessageHeaders::MessageHeadersView headers;
+        headers.SetStrictness(MessageHeaders::MessageHeadersView::Strictness::Http);
+        const std::string firstPart = rawMessage.substr(0, split);
+        (void)headers.ParseRawMessage(firstPart);
+        ASSERT_EQ(MessageHeaders::MessageHeadersView::State::Complete,
+                  headers.ParseRawMessage(rawMessage))
+            << split;
+        ASSERT_FALSE(headers.IsValid()) << split;
+    }
+}
+
+TEST(MessageHeadersViewTests, ResourceLimits)
+{
+    const std::string rawMessage =
+        "Via: SIP/2.0/UDP a.example.com\r\n"
+        "Via: SIP/2.0/UDP b.example.com\r\n"
+        "Subject: one\r\n"
+        " two\r\n"
+        " three\r\n"
+        "\r\n";
+    MessageHeaders::MessageHeadersView::Limits limits;
+    limits.headerCount = 3;
+    limits.blockSize = rawMessage.length();
+    limits.continuationLines = 2;
+    MessageHeaders::MessageHeadersView headers;
+    headers.SetLimits(limits);
+    ASSERT_EQ(MessageHeaders::MessageHeadersView::State::Complete,
+              headers.ParseRawMessage(rawMessage));
+    ASSERT_EQ(3, headers.GetHeaderCount());
+    for (auto* limit : {&limits.headerCount, &limits.blockSize, &limits.continuationLines})
+    {
+        --*limit;
+        MessageHeaders::MessageHeadersView limitedHeaders;
+        limitedHeaders.SetLimits(limits);
+        ASSERT_EQ(MessageHeaders::MessageHeadersView::State::Error,
+                  limitedHeaders.ParseRawMessage(rawMessage));
+        ++*limit;
+    }
+}
+
+TEST(MessageHeadersViewTests, ParsingAnotherMessageForgetsPreviousHeaders)
+{
+    const std::string firstMessage =
+        "Subject: a fairly long subject line here\r\n"
+        "X-Folded: one\r\n"
+        " two\r\n"
+        "\r\n";
+    const std::string secondMessage = "X: 1\r\n\r\n";
+    MessageHeaders::MessageHeadersView headers;
+    ASSERT_EQ(MessageHeaders::MessageHeadersView::State::Complete,
+              headers.ParseRawMessage(firstMessage));
+    ASSERT_EQ(2, headers.GetHeaderCount());
+    ASSERT_EQ(MessageHeaders::MessageHeadersView::State::Complete,
+              headers.ParseRawMessage(secondMessage));
+    ASSERT_EQ(1, headers.GetHeaderCount());
+    ASSERT_EQ("X", headers.GetHeader(0).name);
+    ASSERT_EQ("1", headers.GetHeader(0).value);
+    ASSERT_TRUE(headers.HasHeader("X"));
+    ASSERT_FALSE(headers.HasHeader("Subject"));
+    ASSERT_TRUE(headers.GetHeaderValue("X-Folded").empty());
+    ASSERT_TRUE(headers.IsValid());
+}
@@ -0,0 +1,414 @@
+/**
+ * @file PerformanceBudgetTests.cpp
+ *
+ * This module contains tests which guard the performance of the
+ * MessageHeaders::MessageHeaders class: the number of heap allocations
+ * each call may make, and the time taken growing no faster than
+ * the input on pathological header blocks.
+ *
+ * The allocations are counted by replacing the global operator new of
+ * the whole test program, which otherwise behaves as the standard one.
+ *
+ * The tests comparing wall-clock times, whose names contain
+ * "InLinearTime", may fail on a loaded machine, so the build only runs
+ * them when the MESSAGE_HEADERS_TIMING_TESTS option is on.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <stdlib.h>
+#include <gtest/gtest.h>
+#include <MessageHeaders/Instrumentation.hpp>
+#include <MessageHeaders/MessageHeaders.hpp>
+#include <MessageHeaders/MessageHeadersView.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <string>
+
+namespace
+{
+    /**
+     * This counts the allocations made through the global operator new,
+     * by any thread.
+     */
+    std::atomic<size_t> allocations(0);
+
+    /**
+     * This is the number of times larger the input is made when checking
+     * that the time taken grows no faster than the input.
+     */
+    constexpr size_t ScaleFactor = 8;
+
+    /**
+     * This is how many times slower than linear the larger input may be
+     * handled, which leaves room for noise in the measurements, while
+     * still catching time growing with the square of the input.
+     */
+    constexpr size_t SlowdownAllowed = 3;
+
+    /**
+     * This is the shortest time, in seconds, that is compared,
+     * since timings shorter than this mostly measure noise.
+     */
+    constexpr double ShortestTimeCompared = 0.0001;
+
+    /**
+     * This is the number of characters handed over at a time when
+     * checking the parsing of a raw message arriving in pieces.
+     */
+    constexpr size_t PieceSize = 64;
+
+    /**
+     * This function returns the number of allocations made by
+     * the given function.
+     *
+     * @param[in] function
+     *      This is the function to call.
+     *
+     * @return
+     *      The number of allocations made by the function is returned.
+     */
+    template <typename Function> size_t CountAllocations(Function&& function)
+    {
+        const auto allocationsBefore = allocations.load();
+        function();
+        return allocations.load() - allocationsBefore;
+    }
+
+    /**
+     * This function returns the time taken by the given function,
+     * keeping the fastest of several measurements to leave out
+     * interruptions.
+     *
+     * @param[in] function
+     *      This is the function to call.
+     *
+     * @return
+     *      The time taken by the function, in seconds, is returned.
+     */
+    template <typename Function> double MeasureTime(Function&& function)
+    {
+        auto fastest = 0.0;
+        for (size_t i = 0; i < 5; ++i)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            function();
+            const std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - start;
+            fastest = (i == 0) ? elapsed.count() : std::min(fastest, elapsed.count());
+        }
+        return std::max(fastest, ShortestTimeCompared);
+    }
+
+    /**
+     * This function parses all but the last piece of the given raw
+     * message, handing it over a few characters at a time, as it would
+     * arrive from a network connection.
+     *
+     * @param[in] rawMessage
+     *      This is the raw message to parse.
+     *
+     * @param[in] withoutCopying
+     *      This indicates whether or not to parse the raw message with
+     *      MessageHeaders::MessageHeadersView rather than
+     *      MessageHeaders::MessageHeaders.
+     */
+    void ParseInPieces(const std::string& rawMessage, bool withoutCopying)
+    {
+        MessageHeaders::MessageHeaders headers;
+        MessageHeaders::MessageHeadersView view;
+        for (size_t end = PieceSize; end < rawMessage.length(); end += PieceSize)
+        {
+            const auto piece = std::string_view(rawMessage).substr(0, end);
+            const auto state =
+                withoutCopying ? view.ParseRawMessage(piece) : headers.ParseRawMessage(piece);
+            ASSERT_EQ(MessageHeaders::MessageHeaders::State::Incomplete, state);
+        }
+    }
+
+    /**
+     * This function builds a header block with the given number
+     * of different headers.
+     *
+     * @param[in] headerCount
+     *      This is the number of headers to put in the header block.
+     *
+     * @return
+     *      The header block is returned.
+     */
+    std::string MakeHeaders(size_t headerCount)
+    {
+        std::string rawMessage;
+        for (size_t i = 0; i < headerCount; ++i)
+        {
+            rawMessage += "X-Header-" + std::to_string(i) + ": a value long enough not to fit "
+                          "into a short string buffer\r\n";
+        }
+        return rawMessage + "Short: ok\r\n\r\n";
+    }
+
+    /**
+     * This function builds a header block with a single header folded
+     * over the given number of lines.
+     *
+     * @param[in] lineCount
+     *      This is the number of continuation lines of the header.
+     *
+     * @return
+     *      The header block is returned.
+     */
+    std::string MakeFoldedHeader(size_t lineCount)
+    {
+        std::string rawMessage = "Subject: first line";
+        for (size_t i = 0; i < lineCount; ++i)
+        {
+            rawMessage += "\r\n and another line";
+        }
+        return rawMessage + "\r\nTo: Bob\r\n\r\n";
+    }
+
+    /**
+     * This function builds a header block with headers of all kinds:
+     * with long values, with a short value, and with a folded value.
+     *
+     * @return
+     *      The header block is returned.
+     */
+    std::string MakeMixedHeaders()
+    {
+        auto rawMessage = MakeHeaders(20);
+        rawMessage.resize(rawMessage.length() - 2);
+        return rawMessage + MakeFoldedHeader(3);
+    }
+}  // namespace
+
+// The replacements are kept from being inlined, so that the compiler
+// doesn't pair the free in operator delete with the new expressions,
+// and warn that the memory wasn't allocated by malloc.
+[[gnu::noinline]] void* operator new(size_t size)
+{
+    ++allocations;
+    const auto block = malloc(size == 0 ? 1 : size);
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+[[gnu::noinline]] void* operator new[](size_t size) { return operator new(size); }
+
+[[gnu::noinline]] void operator delete(void* block) noexcept { free(block); }
+
+[[gnu::noinline]] void operator delete[](void* block) noexcept { free(block); }
+
+[[gnu::noinline]] void operator delete(void* block, size_t) noexcept { free(block); }
+
+[[gnu::noinline]] void operator delete[](void* block, size_t) noexcept { free(block); }
+
+[[gnu::noinline]] void* operator new(size_t size, std::align_val_t alignment)
+{
+    ++allocations;
+    void* block = nullptr;
+    if (posix_memalign(&block, std::max((size_t)alignment, sizeof(void*)), size) != 0)
+    {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+[[gnu::noinline]] void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+[[gnu::noinline]] void operator delete(void* block, std::align_val_t) noexcept { free(block); }
+
+[[gnu::noinline]] void operator delete[](void* block, std::align_val_t) noexcept { free(block); }
+
+[[gnu::noinline]] void operator delete(void* block, size_t, std::align_val_t) noexcept
+{
+    free(block);
+}
+
+[[gnu::noinline]] void operator delete[](void* block, size_t, std::align_val_t) noexcept
+{
+    free(block);
+}
+
+TEST(PerformanceBudgetTests, ParseAllocationsGrowLogarithmically)
+{
+    for (const auto lazyValues : {false, true})
+    {
+        const auto countParseAllocations = [lazyValues](const std::string& rawMessage)
+        {
+            MessageHeaders::MessageHeaders headers;
+            headers.SetLazyValues(lazyValues);
+            return CountAllocations(
+                [&]
+                {
+                    ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                              headers.ParseRawMessage(rawMessage));
+                });
+        };
+        const auto fewHeaders = countParseAllocations(MakeHeaders(100));
+        const auto manyHeaders = countParseAllocations(MakeHeaders(1000));
+        EXPECT_LE(fewHeaders, 24) << lazyValues;
+        EXPECT_LE(manyHeaders, 32) << lazyValues;
+        EXPECT_LE(manyHeaders - std::min(manyHeaders, fewHeaders), 10) << lazyValues;
+    }
+}
+
+TEST(PerformanceBudgetTests, ReparseAfterClearAllocatesNothing)
+{
+    const auto rawMessage = MakeHeaders(20);
+    for (const auto lazyValues : {false, true})
+    {
+        MessageHeaders::MessageHeaders headers;
+        headers.SetLazyValues(lazyValues);
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                  headers.ParseRawMessage(rawMessage));
+        headers.Clear();
+        EXPECT_EQ(0, CountAllocations(
+                         [&]
+                         {
+                             ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                                       headers.ParseRawMessage(rawMessage));
+                         }))
+            << lazyValues;
+        MessageHeaders::MessageHeadersView view;
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                  view.ParseRawMessage(rawMessage));
+        view.Clear();
+        EXPECT_EQ(0, CountAllocations(
+                         [&]
+                         {
+                             ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                                       view.ParseRawMessage(rawMessage));
+                         }));
+    }
+}
+
+TEST(PerformanceBudgetTests, GetHeaderValueAllocatesOnlyTheValueReturned)
+{
+    const auto rawMessage = MakeMixedHeaders();
+    const MessageHeaders::MessageHeaders::HeaderName longName("X-Header-19");
+    const MessageHeaders::MessageHeaders::HeaderName shortName("Short");
+    const MessageHeaders::MessageHeaders::HeaderName foldedName("Subject");
+    const MessageHeaders::MessageHeaders::HeaderName missingName("Missing");
+    for (const auto lazyValues : {false, true})
+    {
+        MessageHeaders::MessageHeaders headers;
+        headers.SetLazyValues(lazyValues);
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                  headers.ParseRawMessage(rawMessage));
+
+        // The first lookup may set up the index of header names,
+        // and the first look at a folded lazy value may unfold it.
+        EXPECT_LE(CountAllocations([&] { (void)headers.GetHeaderValue(longName); }), 3)
+            << lazyValues;
+        EXPECT_LE(CountAllocations([&] { (void)headers.GetHeaderValue(foldedName); }), 4)
+            << lazyValues;
+        EXPECT_EQ(1, CountAllocations([&] { (void)headers.GetHeaderValue(longName); }))
+            << lazyValues;
+        EXPECT_EQ(1, CountAllocations([&] { (void)headers.GetHeaderValue(foldedName); }))
+            << lazyValues;
+        EXPECT_EQ(0, CountAllocations([&] { (void)headers.GetHeaderValue(shortName); }))
+            << lazyValues;
+        EXPECT_EQ(0, CountAllocations([&] { (void)headers.GetHeaderValue(missingName); }))
+            << lazyValues;
+        EXPECT_EQ(0, CountAllocations([&] { (void)headers.HasHeader(longName); }))
+            << lazyValues;
+    }
+}
+
+TEST(PerformanceBudgetTests, GenerateRawHeadersAllocatesOnlyTheResult)
+{
+    const auto rawMessage = MakeMixedHeaders();
+    for (const auto lazyValues : {false, true})
+    {
+        MessageHeaders::MessageHeaders headers;
+        headers.SetLazyValues(lazyValues);
+        ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                  headers.ParseRawMessage(rawMessage));
+        headers.SetHeader("Short", "changed");
+
+        // The first time, folded lazy values may need to be unfolded
+        // to measure the lines they'll be generated into.
+        EXPECT_LE(CountAllocations([&] { (void)headers.GenerateRawHeaders(); }), 4)
+            << lazyValues;
+        EXPECT_EQ(1, CountAllocations([&] { (void)headers.GenerateRawHeaders(); }))
+            << lazyValues;
+        std::string buffer(headers.GetRawSize(), '\0');
+        EXPECT_EQ(0, CountAllocations(
+                         [&]
+                         {
+                             ASSERT_EQ(buffer.length(), headers.GenerateRawHeaders(
+                                                            &buffer[0], buffer.length()));
+                         }))
+            << lazyValues;
+        EXPECT_EQ(0, CountAllocations([&] { (void)headers.GetRawSize(); })) << lazyValues;
+    }
+}
+
+TEST(PerformanceBudgetTests, ManyFoldedLinesParsedInLinearTime)
+{
+    const auto smallInput = MakeFoldedHeader(2000);
+    const auto largeInput = MakeFoldedHeader(2000 * ScaleFactor);
+    for (const auto lazyValues : {false, true})
+    {
+        const auto parse = [lazyValues](const std::string& rawMessage)
+        {
+            MessageHeaders::MessageHeaders headers;
+            headers.SetLazyValues(lazyValues);
+            ASSERT_EQ(MessageHeaders::MessageHeaders::State::Complete,
+                      headers.ParseRawMessage(rawMessage));
+            ASSERT_FALSE(headers.GetHeaderValue("Subject").empty());
+            (void)headers.GenerateRawHeaders();
+        };
+        const auto smallTime = MeasureTime([&] { parse(smallInput); });
+        const auto largeTime = MeasureTime([&] { parse(largeInput); });
+        EXPECT_LT(largeTime, smallTime * ScaleFactor * SlowdownAllowed)
+            << lazyValues << ": " << smallTime << " s, then " << largeTime << " s";
+    }
+}
+
+TEST(PerformanceBudgetTests, LinesParsedInLinearTimeWhenHandedOverInPieces)
+{
+    for (const auto withoutCopying : {false, true})
+    {
+        for (const auto& makeInput : {
+                 +[](size_t length) { return "Subject: " + std::string(length, 'x'); },
+                 +[](size_t length) { return MakeFoldedHeader(length / 16); },
+             })
+        {
+            const auto smallInput = makeInput(16384);
+            const auto largeInput = makeInput(16384 * ScaleFactor);
+            const auto smallTime = MeasureTime([&] { ParseInPieces(smallInput, withoutCopying); });
+            const auto largeTime = MeasureTime([&] { ParseInPieces(largeInput, withoutCopying); });
+            EXPECT_LT(largeTime, smallTime * ScaleFactor * SlowdownAllowed)
+                << withoutCopying << ": " << smallTime << " s, then " << largeTime << " s";
+        }
+    }
+}
+
+TEST(PerformanceBudgetTests, EachPieceHandedOverRescansOneCharacter)
+{
+    // The instrumentation counts the characters scanned again only
+    // when it's on.
+    if (!MessageHeaders::Instrumentation::IsEnabled())
+    {
+        return;
+    }
+    const auto rawMessage = "Subject: " + std::string(16384, 'x');
+    for (const auto withoutCopying : {false, true})
+    {
+        MessageHeaders::Instrumentation::Reset();
+        ParseInPieces(rawMessage, withoutCopying);
+        EXPECT_LE(MessageHeaders::Instrumentation::GetSnapshot().bytesRescanned,
+                  rawMessage.length() / PieceSize)
+            << withoutCopying;
+    }
+}